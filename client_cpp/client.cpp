@@ -1,12 +1,25 @@
 #include <iostream>
 #include <fstream>
+#include <sstream>
 #include <string>
 #include <memory>
 #include <vector>
 #include <limits> // Para numeric_limits
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <random>
+#include <thread>
+#include <utility>
 
 #include <grpcpp/grpcpp.h>
 #include "file_processor.grpc.pb.h"
+#include "crc32c.h"
+
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
 
 using grpc::Channel;
 using grpc::ClientContext;
@@ -15,43 +28,65 @@ using namespace file_processor;
 
 const int CHUNK_SIZE = 1024 * 1024; // 1MB
 
+// Metadado em que o cliente pede a compressão das respostas (gzip, deflate ou zstd)
+const char* const COMPRESSION_METADATA = "x-response-compression";
+
+bool zstdAvailable() {
+#ifdef HAVE_ZSTD
+    return true;
+#else
+    return false;
+#endif
+}
+
+// Metadados de uma sessão de upload retomável
+const char* const UPLOAD_ID_METADATA = "x-upload-id";
+const char* const UPLOAD_SIZE_METADATA = "x-upload-size";
+
+// Tentativas de uma chamada com upload retomável antes de desistir
+const int MAX_ATTEMPTS = 5;
+
+// Id aleatório de uma sessão de upload (32 dígitos hexadecimais)
+std::string newUploadId() {
+    std::random_device random;
+    std::string id;
+    const char* digits = "0123456789abcdef";
+    for (int i = 0; i < 32; ++i) id += digits[random() % 16];
+    return id;
+}
+
+// Falhas depois das quais vale retomar o upload: conexão perdida, chunk fora de ordem ou
+// corrompido, ou a sessão ainda presa à chamada que caiu (ABORTED). FAILED_PRECONDITION e as
+// demais recusas da sessão são definitivas.
+bool shouldResume(const Status& status) {
+    switch (status.error_code()) {
+        case grpc::StatusCode::UNAVAILABLE:
+        case grpc::StatusCode::OUT_OF_RANGE:
+        case grpc::StatusCode::DATA_LOSS:
+        case grpc::StatusCode::ABORTED:
+            return true;
+        default:
+            return false;
+    }
+}
+
 class FileProcessorClient {
 public:
-    FileProcessorClient(std::shared_ptr<Channel> channel)
-        : stub_(FileProcessorService::NewStub(channel)) {}
+    // compression vazio recebe as respostas sem compressão; com resumable os uploads usam
+    // sessões retomáveis
+    FileProcessorClient(std::shared_ptr<Channel> channel, const std::string& compression = "", bool resumable = false)
+        : stub_(FileProcessorService::NewStub(channel)), compression_(compression), resumable_(resumable) {}
 
     void CompressPDF(const std::string& input_path, const std::string& output_path) {
-        ClientContext context;
-        auto stream = stub_->CompressPDF(&context);
-
         std::ifstream input_file(input_path, std::ios::binary);
         if (!input_file.is_open()) {
             std::cerr << "Erro: Não foi possível abrir o arquivo de entrada '" << input_path << "'." << std::endl;
-            stream->WritesDone();
             return;
         }
         std::cout << "Enviando arquivo para compressão..." << std::endl;
-        
-        char buffer[CHUNK_SIZE];
-        while (input_file.read(buffer, sizeof(buffer))) {
-            FileChunk chunk;
-            chunk.set_content(buffer, input_file.gcount());
-            if (!stream->Write(chunk)) break;
-        }
-        if (input_file.gcount() > 0) {
-            FileChunk chunk;
-            chunk.set_content(buffer, input_file.gcount());
-            stream->Write(chunk);
-        }
-        stream->WritesDone();
-
-        std::ofstream output_file(output_path, std::ios::binary);
-        FileChunk received_chunk;
-        while (stream->Read(&received_chunk)) {
-            output_file.write(received_chunk.content().c_str(), received_chunk.content().length());
-        }
 
-        Status status = stream->Finish();
+        auto open = [this](ClientContext* context) { return stub_->CompressPDF(context); };
+        Status status = transfer<FileChunk>(open, nullptr, input_file, {output_path});
         if (status.ok()) {
             std::cout << "PDF comprimido e salvo em: " << output_path << std::endl;
         } else {
@@ -59,38 +94,27 @@ public:
         }
     }
     
-    void ConvertToTXT(const std::string& input_path, const std::string& output_path) {
-        ClientContext context;
-        auto stream = stub_->ConvertToTXT(&context);
-
+    // first_page/last_page (0 = desde a primeira/até a última) e max_chars (0 = sem limite)
+    // restringem o texto extraído
+    void ConvertToTXT(const std::string& input_path, const std::string& output_path,
+                      uint32_t first_page = 0, uint32_t last_page = 0, uint64_t max_chars = 0) {
         std::ifstream input_file(input_path, std::ios::binary);
         if (!input_file.is_open()) {
             std::cerr << "Erro: Não foi possível abrir o arquivo de entrada '" << input_path << "'." << std::endl;
-            stream->WritesDone();
             return;
         }
         std::cout << "Enviando arquivo para conversão TXT..." << std::endl;
 
-        char buffer[CHUNK_SIZE];
-        while (input_file.read(buffer, sizeof(buffer))) {
-            FileChunk chunk;
-            chunk.set_content(buffer, input_file.gcount());
-            if (!stream->Write(chunk)) break;
-        }
-        if (input_file.gcount() > 0) {
-            FileChunk chunk;
-            chunk.set_content(buffer, input_file.gcount());
-            stream->Write(chunk);
-        }
-        stream->WritesDone();
-
-        std::ofstream output_file(output_path, std::ios::binary);
-        FileChunk received_chunk;
-        while (stream->Read(&received_chunk)) {
-            output_file.write(received_chunk.content().c_str(), received_chunk.content().length());
-        }
+        // Primeira mensagem com as opções, só quando alguma foi escolhida
+        ConvertTextRequest initial_request;
+        TextOptions* options = initial_request.mutable_options();
+        options->set_first_page(first_page);
+        options->set_last_page(last_page);
+        options->set_max_chars(max_chars);
+        bool has_options = first_page > 0 || last_page > 0 || max_chars > 0;
 
-        Status status = stream->Finish();
+        auto open = [this](ClientContext* context) { return stub_->ConvertToTXT(context); };
+        Status status = transfer<ConvertTextRequest>(open, has_options ? &initial_request : nullptr, input_file, {output_path});
         if (status.ok()) {
             std::cout << "Arquivo de texto salvo em: " << output_path << std::endl;
         } else {
@@ -99,13 +123,9 @@ public:
     }
 
     void ConvertImageFormat(const std::string& input_path, const std::string& output_path, const std::string& format) {
-        ClientContext context;
-        auto stream = stub_->ConvertImageFormat(&context);
-        
         std::ifstream input_file(input_path, std::ios::binary);
         if (!input_file.is_open()) {
             std::cerr << "Erro: Não foi possível abrir o arquivo de entrada '" << input_path << "'." << std::endl;
-            stream->WritesDone();
             return;
         }
         std::cout << "Enviando imagem para conversão para o formato " << format << "..." << std::endl;
@@ -113,29 +133,9 @@ public:
         // Primeira mensagem com o parâmetro
         ConvertImageRequest initial_request;
         initial_request.set_output_format(format);
-        stream->Write(initial_request);
-
-        // Chunks subsequentes com o conteúdo do arquivo
-        char buffer[CHUNK_SIZE];
-        while (input_file.read(buffer, sizeof(buffer))) {
-            ConvertImageRequest request;
-            request.set_content(buffer, input_file.gcount());
-            if (!stream->Write(request)) break;
-        }
-        if (input_file.gcount() > 0) {
-            ConvertImageRequest request;
-            request.set_content(buffer, input_file.gcount());
-            stream->Write(request);
-        }
-        stream->WritesDone();
 
-        std::ofstream output_file(output_path, std::ios::binary);
-        FileChunk received_chunk;
-        while (stream->Read(&received_chunk)) {
-            output_file.write(received_chunk.content().c_str(), received_chunk.content().length());
-        }
-
-        Status status = stream->Finish();
+        auto open = [this](ClientContext* context) { return stub_->ConvertImageFormat(context); };
+        Status status = transfer<ConvertImageRequest>(open, &initial_request, input_file, {output_path});
         if (status.ok()) {
             std::cout << "Imagem convertida salva em: " << output_path << std::endl;
         } else {
@@ -144,13 +144,9 @@ public:
     }
     
     void ResizeImage(const std::string& input_path, const std::string& output_path, int width, int height) {
-        ClientContext context;
-        auto stream = stub_->ResizeImage(&context);
-        
         std::ifstream input_file(input_path, std::ios::binary);
         if (!input_file.is_open()) {
             std::cerr << "Erro: Não foi possível abrir o arquivo de entrada '" << input_path << "'." << std::endl;
-            stream->WritesDone();
             return;
         }
         std::cout << "Enviando imagem para redimensionar para " << width << "x" << height << "..." << std::endl;
@@ -159,39 +155,179 @@ public:
         ResizeImageRequest initial_request;
         initial_request.mutable_dimensions()->set_width(width);
         initial_request.mutable_dimensions()->set_height(height);
-        stream->Write(initial_request);
-        
-        // Chunks subsequentes com o conteúdo do arquivo
-        char buffer[CHUNK_SIZE];
-        while (input_file.read(buffer, sizeof(buffer))) {
-            ResizeImageRequest request;
-            request.set_content(buffer, input_file.gcount());
-            if (!stream->Write(request)) break;
+
+        auto open = [this](ClientContext* context) { return stub_->ResizeImage(context); };
+        Status status = transfer<ResizeImageRequest>(open, &initial_request, input_file, {output_path});
+        if (status.ok()) {
+            std::cout << "Imagem redimensionada salva em: " << output_path << std::endl;
+        } else {
+            std::cerr << "RPC falhou: " << status.error_message() << std::endl;
         }
-        if (input_file.gcount() > 0) {
-            ResizeImageRequest request;
-            request.set_content(buffer, input_file.gcount());
-            stream->Write(request);
+    }
+
+    // Gera vários tamanhos da imagem em uma só chamada; cada um é salvo em
+    // <output_prefix>_<largura>x<altura> com a extensão da entrada
+    void ResizeImageSizes(const std::string& input_path, const std::string& output_prefix,
+                          const std::vector<std::pair<int, int>>& sizes) {
+        std::ifstream input_file(input_path, std::ios::binary);
+        if (!input_file.is_open()) {
+            std::cerr << "Erro: Não foi possível abrir o arquivo de entrada '" << input_path << "'." << std::endl;
+            return;
         }
-        stream->WritesDone();
+        std::cout << "Enviando imagem para gerar " << sizes.size() << " tamanhos..." << std::endl;
 
-        // Receber arquivo
-        std::ofstream output_file(output_path, std::ios::binary);
-        FileChunk received_chunk;
-        while (stream->Read(&received_chunk)) {
-            output_file.write(received_chunk.content().c_str(), received_chunk.content().length());
+        size_t dot = input_path.find_last_of("./");
+        std::string extension = dot != std::string::npos && input_path[dot] == '.' ? input_path.substr(dot) : "";
+        ResizeImageRequest initial_request;
+        std::vector<std::string> output_paths;
+        for (const auto& size : sizes) {
+            ResizeOutput* output = initial_request.mutable_outputs()->add_outputs();
+            output->mutable_dimensions()->set_width(size.first);
+            output->mutable_dimensions()->set_height(size.second);
+            output_paths.push_back(output_prefix + "_" + std::to_string(size.first) + "x" + std::to_string(size.second) + extension);
         }
 
-        Status status = stream->Finish();
+        auto open = [this](ClientContext* context) { return stub_->ResizeImage(context); };
+        Status status = transfer<ResizeImageRequest>(open, &initial_request, input_file, output_paths);
         if (status.ok()) {
-            std::cout << "Imagem redimensionada salva em: " << output_path << std::endl;
+            for (const auto& path : output_paths) std::cout << "Imagem redimensionada salva em: " << path << std::endl;
         } else {
             std::cerr << "RPC falhou: " << status.error_message() << std::endl;
         }
     }
 
 private:
+    template <typename Request>
+    using OpenStream = std::function<std::unique_ptr<grpc::ClientReaderWriter<Request, FileChunk>>(ClientContext*)>;
+
+    // Envia header (se houver) seguido do conteúdo de input_file e grava a resposta em output_paths,
+    // cada chunk no arquivo indicado pelo seu output_index (só o ResizeImage com vários tamanhos
+    // tem mais de uma saída). Com uploads retomáveis, cada chunk leva o offset e o CRC32C; se a chamada cair, o envio
+    // continua do que o servidor já confirmou em vez de recomeçar do zero.
+    template <typename Request>
+    Status transfer(OpenStream<Request> open, const Request* header, std::ifstream& input_file,
+                    const std::vector<std::string>& output_paths) {
+        input_file.seekg(0, std::ios::end);
+        const uint64_t total = static_cast<uint64_t>(input_file.tellg());
+        std::string upload_id = resumable_ ? newUploadId() : "";
+        std::vector<char> buffer(CHUNK_SIZE);
+
+        for (int attempt = 1;; ++attempt) {
+            uint64_t offset = attempt > 1 && !upload_id.empty() ? resumeOffset(upload_id, input_file) : 0;
+            ClientContext context;
+            prepareContext(context);
+            if (!upload_id.empty()) {
+                context.AddMetadata(UPLOAD_ID_METADATA, upload_id);
+                context.AddMetadata(UPLOAD_SIZE_METADATA, std::to_string(total));
+            }
+            auto stream = open(&context);
+            if (header) stream->Write(*header);
+
+            // Chunks com o conteúdo do arquivo
+            input_file.clear();
+            input_file.seekg(static_cast<std::streamoff>(offset));
+            while (input_file.read(buffer.data(), buffer.size()) || input_file.gcount() > 0) {
+                size_t count = static_cast<size_t>(input_file.gcount());
+                Request request;
+                request.set_content(buffer.data(), count);
+                if (!upload_id.empty()) {
+                    request.set_offset(offset);
+                    request.set_crc32c(crc32c(0, buffer.data(), count));
+                }
+                if (!stream->Write(request)) break;
+                offset += count;
+            }
+            stream->WritesDone();
+
+            std::vector<std::ofstream> output_files;
+            for (const auto& path : output_paths) output_files.emplace_back(path, std::ios::binary | std::ios::trunc);
+            FileChunk received_chunk;
+            while (stream->Read(&received_chunk)) {
+                if (received_chunk.output_index() >= output_files.size()) {
+                    std::cerr << "Erro: chunk recebido para uma saída inexistente." << std::endl;
+                    context.TryCancel();
+                    break;
+                }
+                if (!writeChunk(output_files[received_chunk.output_index()], received_chunk)) {
+                    context.TryCancel();
+                    break;
+                }
+            }
+
+            Status status = stream->Finish();
+            if (!upload_id.empty() && status.error_code() == grpc::StatusCode::UNIMPLEMENTED) {
+                // Servidor sem uploads retomáveis: envia de novo, sem sessão
+                std::cerr << "O servidor não aceita uploads retomáveis; enviando sem sessão." << std::endl;
+                upload_id.clear();
+                continue;
+            }
+            if (status.ok() || upload_id.empty() || attempt == MAX_ATTEMPTS || !shouldResume(status)) return status;
+            std::cerr << "Chamada interrompida (" << status.error_message() << "); retomando o upload..." << std::endl;
+            std::this_thread::sleep_for(std::chrono::seconds(attempt));
+        }
+    }
+
+    // Offset em que o upload continua: o que o servidor já gravou, se o CRC32C conferir com o
+    // início do arquivo local. Uma sessão perdida ou divergente recomeça do zero com outro id.
+    uint64_t resumeOffset(std::string& upload_id, std::ifstream& input_file) {
+        ClientContext context;
+        UploadStatusRequest request;
+        request.set_upload_id(upload_id);
+        UploadStatusReply reply;
+        // Sem resposta, envia tudo de novo: o servidor descarta o que já tinha recebido
+        if (!stub_->GetUploadStatus(&context, request, &reply).ok()) return 0;
+        if (!reply.found()) return 0;
+
+        std::vector<char> buffer(CHUNK_SIZE);
+        uint32_t crc = 0;
+        uint64_t remaining = reply.committed_bytes();
+        input_file.clear();
+        input_file.seekg(0);
+        while (remaining > 0 && input_file.read(buffer.data(), std::min<uint64_t>(remaining, buffer.size()))) {
+            crc = crc32c(crc, buffer.data(), static_cast<size_t>(input_file.gcount()));
+            remaining -= static_cast<uint64_t>(input_file.gcount());
+        }
+        if (remaining > 0 || crc != reply.crc32c()) {
+            std::cerr << "O upload guardado no servidor não confere com o arquivo; reenviando do início." << std::endl;
+            upload_id = newUploadId();
+            return 0;
+        }
+        std::cout << "Servidor já tem " << reply.committed_bytes() << " bytes; continuando o upload." << std::endl;
+        return reply.committed_bytes();
+    }
+
+    // Pede ao servidor a compressão escolhida. Com gzip e deflate o próprio gRPC descomprime;
+    // com zstd os chunks comprimidos chegam marcados e são tratados em writeChunk.
+    void prepareContext(ClientContext& context) {
+        if (!compression_.empty()) context.AddMetadata(COMPRESSION_METADATA, compression_);
+    }
+
+    // Grava o conteúdo de um chunk recebido, descomprimindo os frames zstd
+    bool writeChunk(std::ofstream& output_file, const FileChunk& chunk) {
+        if (chunk.encoding() == IDENTITY) {
+            output_file.write(chunk.content().data(), chunk.content().size());
+            return true;
+        }
+#ifdef HAVE_ZSTD
+        if (chunk.encoding() == ZSTD) {
+            unsigned long long size = ZSTD_getFrameContentSize(chunk.content().data(), chunk.content().size());
+            if (size != ZSTD_CONTENTSIZE_ERROR && size != ZSTD_CONTENTSIZE_UNKNOWN) {
+                std::string data(size, '\0');
+                size_t written = ZSTD_decompress(&data[0], data.size(), chunk.content().data(), chunk.content().size());
+                if (!ZSTD_isError(written)) {
+                    output_file.write(data.data(), written);
+                    return true;
+                }
+            }
+        }
+#endif
+        std::cerr << "Erro: chunk recebido com codificação não suportada." << std::endl;
+        return false;
+    }
+
     std::unique_ptr<FileProcessorService::Stub> stub_;
+    std::string compression_;
+    bool resumable_;
 };
 
 void print_menu() {
@@ -200,16 +336,39 @@ void print_menu() {
     std::cout << "2. Converter PDF para TXT\n";
     std::cout << "3. Converter formato de Imagem\n";
     std::cout << "4. Redimensionar Imagem\n";
-    std::cout << "5. Sair\n";
+    std::cout << "5. Redimensionar Imagem em vários tamanhos\n";
+    std::cout << "6. Sair\n";
     std::cout << "Escolha uma opção: ";
 }
 
-int main() {
+int main(int argc, char** argv) {
+    // --compression=gzip|deflate|zstd pede as respostas comprimidas; --resumable envia os
+    // arquivos em sessões de upload que continuam de onde pararam se a conexão cair
+    std::string compression;
+    bool resumable = false;
+    for (int i = 1; i < argc; ++i) {
+        const std::string prefix = "--compression=";
+        std::string arg = argv[i];
+        if (arg == "--resumable") {
+            resumable = true;
+            continue;
+        }
+        if (arg.rfind(prefix, 0) == 0) compression = arg.substr(prefix.size());
+        if (arg.rfind(prefix, 0) != 0 || (compression != "gzip" && compression != "deflate" && compression != "zstd")) {
+            std::cerr << "Uso: " << argv[0] << " [--compression=gzip|deflate|zstd] [--resumable]" << std::endl;
+            return 1;
+        }
+    }
+    if (compression == "zstd" && !zstdAvailable()) {
+        std::cerr << "Cliente compilado sem a libzstd; use gzip ou deflate." << std::endl;
+        return 1;
+    }
+
     std::string server_address("localhost:50051");
-    FileProcessorClient client(grpc::CreateChannel(server_address, grpc::InsecureChannelCredentials()));
+    FileProcessorClient client(grpc::CreateChannel(server_address, grpc::InsecureChannelCredentials()), compression, resumable);
 
     int choice = 0;
-    while (choice != 5) {
+    while (choice != 6) {
         print_menu();
         std::cin >> choice;
         
@@ -223,8 +382,9 @@ int main() {
         
         std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n'); // Limpa o buffer de entrada para o próximo getline
 
-        std::string in_path, out_path, format;
+        std::string in_path, out_path, format, pages, max_chars, sizes_line;
         int width, height;
+        uint32_t first_page, last_page;
 
         switch (choice) {
             case 1:
@@ -239,7 +399,19 @@ int main() {
                 std::getline(std::cin, in_path);
                 std::cout << "Caminho do arquivo TXT de saída: ";
                 std::getline(std::cin, out_path);
-                client.ConvertToTXT(in_path, out_path);
+                std::cout << "Páginas (ex: 1-3; vazio = todas): ";
+                std::getline(std::cin, pages);
+                std::cout << "Máximo de caracteres (vazio = sem limite): ";
+                std::getline(std::cin, max_chars);
+                first_page = last_page = 0;
+                if (!pages.empty()) {
+                    // "N" sozinho é só a página N
+                    size_t dash = pages.find('-');
+                    first_page = static_cast<uint32_t>(std::strtoul(pages.c_str(), nullptr, 10));
+                    last_page = dash == std::string::npos ? first_page
+                                                          : static_cast<uint32_t>(std::strtoul(pages.c_str() + dash + 1, nullptr, 10));
+                }
+                client.ConvertToTXT(in_path, out_path, first_page, last_page, std::strtoull(max_chars.c_str(), nullptr, 10));
                 break;
             case 3:
                 std::cout << "Caminho da imagem de entrada: ";
@@ -262,7 +434,25 @@ int main() {
                 std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
                 client.ResizeImage(in_path, out_path, width, height);
                 break;
-            case 5:
+            case 5: {
+                std::cout << "Caminho da imagem de entrada: ";
+                std::getline(std::cin, in_path);
+                std::cout << "Prefixo das imagens de saída: ";
+                std::getline(std::cin, out_path);
+                std::cout << "Tamanhos (ex: 1024x768 256x192): ";
+                std::getline(std::cin, sizes_line);
+                std::vector<std::pair<int, int>> sizes;
+                std::istringstream sizes_stream(sizes_line);
+                std::string size;
+                while (sizes_stream >> size) {
+                    size_t x = size.find('x');
+                    if (x == std::string::npos) continue;
+                    sizes.emplace_back(std::atoi(size.c_str()), std::atoi(size.c_str() + x + 1));
+                }
+                client.ResizeImageSizes(in_path, out_path, sizes);
+                break;
+            }
+            case 6:
                 std::cout << "Saindo..." << std::endl;
                 break;
             default:
@@ -0,0 +1,818 @@
+// Gerador de carga para o FileProcessorService.
+//
+// Dispara os quatro RPCs contra um servidor (normalmente em localhost) com concorrência fixa
+// (laço fechado: cada conexão lógica envia a próxima chamada quando a anterior termina) ou com
+// uma taxa de chegada (laço aberto: chegadas de Poisson, independentes das respostas). Em laço
+// aberto a latência é medida a partir do instante planejado de cada chamada, para que um
+// servidor lento não esconda a própria fila.
+//
+// Relata vazão, latência (p50/p90/p99/p99.9) e tempo até o primeiro byte por método, e pode
+// gravar o resultado em JSON para comparar execuções.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include <grpcpp/grpcpp.h>
+#include "file_processor.grpc.pb.h"
+
+using namespace file_processor;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+enum class Rpc { CompressPDF, ConvertToTXT, ConvertImageFormat, ResizeImage };
+const Rpc kAllRpcs[] = {Rpc::CompressPDF, Rpc::ConvertToTXT, Rpc::ConvertImageFormat, Rpc::ResizeImage};
+
+const char* rpcName(Rpc rpc) {
+    switch (rpc) {
+        case Rpc::CompressPDF: return "CompressPDF";
+        case Rpc::ConvertToTXT: return "ConvertToTXT";
+        case Rpc::ConvertImageFormat: return "ConvertImageFormat";
+        case Rpc::ResizeImage: return "ResizeImage";
+    }
+    return "?";
+}
+
+bool usesPdf(Rpc rpc) { return rpc == Rpc::CompressPDF || rpc == Rpc::ConvertToTXT; }
+
+// Distribuição do tamanho das entradas. O tamanho sorteado escolhe o arquivo de tamanho mais
+// próximo entre as entradas disponíveis para o método.
+struct SizeDistribution {
+    enum class Kind { Uniform, Fixed, LogNormal } kind = Kind::Uniform;
+    double size = 0;  // Fixed: tamanho desejado; LogNormal: mediana
+    double sigma = 0; // LogNormal: desvio do logaritmo
+};
+
+struct Options {
+    std::string target = "localhost:50051";
+    std::vector<std::pair<Rpc, double>> mix; // método e peso; vazio = os quatro com o mesmo peso
+    size_t concurrency = 8;
+    double rate = 0;             // chamadas/s; 0 = laço fechado
+    size_t max_outstanding = 1024; // laço aberto: chamadas simultâneas antes de contar chegadas perdidas
+    double duration = 30;        // segundos medidos
+    double warmup = 5;           // segundos descartados antes da medição
+    size_t requests = 0;         // se > 0, encerra depois de tantas chamadas medidas
+    double timeout = 120;        // prazo de cada chamada, em segundos
+    std::vector<std::string> pdf_paths;
+    std::vector<std::string> image_paths;
+    std::string manifest; // manifest.json do corpus_gen
+    SizeDistribution size_distribution;
+    std::string format = "png";
+    int width = 800;
+    int height = 600;
+    size_t chunk_size = 1024 * 1024;
+    std::string compression; // pedida no metadado x-response-compression; vazio = nenhuma
+    uint64_t seed = 1;
+    std::string json_path; // "-" = saída padrão
+};
+
+// --- Opções ---
+
+bool parseSize(const std::string& text, double& out) {
+    if (text.empty()) return false;
+    char* end = nullptr;
+    double value = std::strtod(text.c_str(), &end);
+    std::string suffix = end;
+    if (suffix == "K" || suffix == "k") {
+        value *= 1024;
+    } else if (suffix == "M" || suffix == "m") {
+        value *= 1024 * 1024;
+    } else if (suffix == "G" || suffix == "g") {
+        value *= 1024.0 * 1024 * 1024;
+    } else if (!suffix.empty()) {
+        return false;
+    }
+    if (!(value >= 0)) return false;
+    out = value;
+    return true;
+}
+
+bool parseNumber(const std::string& text, double& out) {
+    if (text.empty()) return false;
+    char* end = nullptr;
+    out = std::strtod(text.c_str(), &end);
+    return *end == '\0' && out >= 0;
+}
+
+bool parseCount(const std::string& text, size_t& out) {
+    double value = 0;
+    if (!parseNumber(text, value) || value != std::floor(value)) return false;
+    out = static_cast<size_t>(value);
+    return true;
+}
+
+std::vector<std::string> split(const std::string& text, char separator) {
+    std::vector<std::string> parts;
+    std::stringstream stream(text);
+    std::string part;
+    while (std::getline(stream, part, separator)) {
+        if (!part.empty()) parts.push_back(part);
+    }
+    return parts;
+}
+
+bool parseRpc(const std::string& name, Rpc& rpc) {
+    for (Rpc candidate : kAllRpcs) {
+        if (name == rpcName(candidate)) {
+            rpc = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+// "CompressPDF:2,ResizeImage:1" ou só "ResizeImage"
+bool parseMix(const std::string& text, Options& options) {
+    options.mix.clear();
+    for (const auto& item : split(text, ',')) {
+        size_t colon = item.find(':');
+        Rpc rpc;
+        double weight = 1;
+        if (!parseRpc(item.substr(0, colon), rpc)) return false;
+        if (colon != std::string::npos && (!parseNumber(item.substr(colon + 1), weight) || weight <= 0)) return false;
+        options.mix.emplace_back(rpc, weight);
+    }
+    return !options.mix.empty();
+}
+
+// "uniform", "fixed:1M" ou "lognormal:512K:0.8"
+bool parseSizeDistribution(const std::string& text, SizeDistribution& out) {
+    std::vector<std::string> parts = split(text, ':');
+    if (parts.size() == 1 && parts[0] == "uniform") {
+        out.kind = SizeDistribution::Kind::Uniform;
+        return true;
+    }
+    if (parts.size() == 2 && parts[0] == "fixed") {
+        out.kind = SizeDistribution::Kind::Fixed;
+        return parseSize(parts[1], out.size);
+    }
+    if (parts.size() == 3 && parts[0] == "lognormal") {
+        out.kind = SizeDistribution::Kind::LogNormal;
+        return parseSize(parts[1], out.size) && out.size > 0 && parseNumber(parts[2], out.sigma);
+    }
+    return false;
+}
+
+// Valor de uma chave de texto em uma linha de JSON ("" se ausente)
+std::string jsonField(const std::string& line, const std::string& key) {
+    std::string pattern = "\"" + key + "\":\"";
+    size_t start = line.find(pattern);
+    if (start == std::string::npos) return "";
+    start += pattern.size();
+    size_t end = line.find('"', start);
+    return end == std::string::npos ? "" : line.substr(start, end - start);
+}
+
+// Acrescenta as entradas listadas pelo corpus_gen, que grava um arquivo por linha com
+// caminho relativo ao diretório do manifesto
+bool readManifest(Options& options, std::string& error) {
+    std::ifstream stream(options.manifest);
+    if (!stream) {
+        error = "Não foi possível abrir o manifesto " + options.manifest;
+        return false;
+    }
+    size_t slash = options.manifest.rfind('/');
+    std::string base = slash == std::string::npos ? "" : options.manifest.substr(0, slash + 1);
+    std::string line;
+    while (std::getline(stream, line)) {
+        std::string path = jsonField(line, "path");
+        std::string kind = jsonField(line, "kind");
+        if (path.empty()) continue;
+        if (path[0] != '/') path = base + path;
+        if (kind == "pdf") {
+            options.pdf_paths.push_back(path);
+        } else if (kind == "image") {
+            options.image_paths.push_back(path);
+        }
+    }
+    return true;
+}
+
+std::string usage(const std::string& program) {
+    return "Uso: " + program + " (--manifest=ARQ | --pdf=ARQ|DIR[,...] --image=ARQ|DIR[,...]) [opções]\n"
+           "  --target=HOST:PORTA    Servidor (padrão localhost:50051)\n"
+           "  --mix=M[:PESO],...     Métodos e pesos (padrão: os quatro com o mesmo peso)\n"
+           "  --concurrency=N        Chamadas simultâneas em laço fechado (padrão 8)\n"
+           "  --rate=R               Laço aberto: R chamadas/s com chegadas de Poisson (padrão 0 = laço fechado)\n"
+           "  --max-outstanding=N    Laço aberto: chamadas simultâneas antes de descartar chegadas (padrão 1024)\n"
+           "  --duration=S           Segundos medidos (padrão 30)\n"
+           "  --warmup=S             Segundos iniciais descartados (padrão 5)\n"
+           "  --requests=N           Encerra depois de N chamadas medidas\n"
+           "  --timeout=S            Prazo de cada chamada (padrão 120)\n"
+           "  --manifest=ARQ         Usa as entradas do manifest.json gerado pelo corpus_gen\n"
+           "  --pdf=...              PDFs usados por CompressPDF e ConvertToTXT\n"
+           "  --image=...            Imagens usadas por ConvertImageFormat e ResizeImage\n"
+           "  --size-dist=D          uniform (padrão), fixed:TAM ou lognormal:MEDIANA:SIGMA (ex.: lognormal:1M:0.7)\n"
+           "  --format=FMT           Formato do ConvertImageFormat (padrão png)\n"
+           "  --size=LxA             Dimensões do ResizeImage (padrão 800x600)\n"
+           "  --chunk-size=BYTES     Tamanho dos chunks enviados (padrão 1048576)\n"
+           "  --compression=ALG      Pede as respostas em gzip, deflate ou zstd (os bytes recebidos contam comprimidos)\n"
+           "  --seed=N               Semente dos sorteios (padrão 1)\n"
+           "  --json=ARQUIVO         Grava o resultado em JSON (\"-\" = saída padrão)\n";
+}
+
+bool parseOptions(int argc, char** argv, Options& options, std::string& error) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        size_t eq = arg.find('=');
+        std::string name = arg.substr(0, eq);
+        std::string value = eq == std::string::npos ? "" : arg.substr(eq + 1);
+
+        bool valid = true;
+        if (name == "--target") {
+            valid = !value.empty();
+            options.target = value;
+        } else if (name == "--mix") {
+            valid = parseMix(value, options);
+        } else if (name == "--concurrency") {
+            valid = parseCount(value, options.concurrency) && options.concurrency > 0;
+        } else if (name == "--rate") {
+            valid = parseNumber(value, options.rate);
+        } else if (name == "--max-outstanding") {
+            valid = parseCount(value, options.max_outstanding) && options.max_outstanding > 0;
+        } else if (name == "--duration") {
+            valid = parseNumber(value, options.duration) && options.duration > 0;
+        } else if (name == "--warmup") {
+            valid = parseNumber(value, options.warmup);
+        } else if (name == "--requests") {
+            valid = parseCount(value, options.requests);
+        } else if (name == "--timeout") {
+            valid = parseNumber(value, options.timeout) && options.timeout > 0;
+        } else if (name == "--pdf") {
+            std::vector<std::string> paths = split(value, ',');
+            options.pdf_paths.insert(options.pdf_paths.end(), paths.begin(), paths.end());
+            valid = !paths.empty();
+        } else if (name == "--image") {
+            std::vector<std::string> paths = split(value, ',');
+            options.image_paths.insert(options.image_paths.end(), paths.begin(), paths.end());
+            valid = !paths.empty();
+        } else if (name == "--manifest") {
+            valid = !value.empty();
+            options.manifest = value;
+        } else if (name == "--size-dist") {
+            valid = parseSizeDistribution(value, options.size_distribution);
+        } else if (name == "--format") {
+            valid = !value.empty();
+            options.format = value;
+        } else if (name == "--size") {
+            valid = std::sscanf(value.c_str(), "%dx%d", &options.width, &options.height) == 2 && options.width > 0 &&
+                    options.height > 0;
+        } else if (name == "--chunk-size") {
+            valid = parseCount(value, options.chunk_size) && options.chunk_size >= 1024 && options.chunk_size <= 4 * 1024 * 1024 - 1024;
+        } else if (name == "--compression") {
+            valid = value == "gzip" || value == "deflate" || value == "zstd";
+            options.compression = value;
+        } else if (name == "--seed") {
+            size_t seed = 0;
+            valid = parseCount(value, seed);
+            options.seed = seed;
+        } else if (name == "--json") {
+            valid = !value.empty();
+            options.json_path = value;
+        } else {
+            valid = false;
+        }
+        if (!valid) {
+            error = "Opção inválida: " + arg;
+            return false;
+        }
+    }
+    if (options.mix.empty()) {
+        for (Rpc rpc : kAllRpcs) options.mix.emplace_back(rpc, 1.0);
+    }
+    return options.manifest.empty() || readManifest(options, error);
+}
+
+// --- Entradas ---
+
+struct Input {
+    std::string path;
+    std::shared_ptr<const std::string> data;
+};
+
+// Arquivos de cada caminho; diretórios são listados (sem recursão) em ordem alfabética
+bool loadInputs(const std::vector<std::string>& paths, std::vector<Input>& inputs, std::string& error) {
+    std::vector<std::string> files;
+    for (const auto& path : paths) {
+        struct stat info;
+        if (stat(path.c_str(), &info) != 0) {
+            error = "Entrada não encontrada: " + path;
+            return false;
+        }
+        if (!S_ISDIR(info.st_mode)) {
+            files.push_back(path);
+            continue;
+        }
+        DIR* dir = opendir(path.c_str());
+        if (!dir) {
+            error = "Não foi possível listar " + path;
+            return false;
+        }
+        std::vector<std::string> found;
+        while (dirent* entry = readdir(dir)) {
+            std::string file = path + "/" + entry->d_name;
+            if (entry->d_name[0] != '.' && stat(file.c_str(), &info) == 0 && S_ISREG(info.st_mode)) found.push_back(file);
+        }
+        closedir(dir);
+        std::sort(found.begin(), found.end());
+        files.insert(files.end(), found.begin(), found.end());
+    }
+    for (const auto& file : files) {
+        std::ifstream stream(file, std::ios::binary);
+        std::string data((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+        if (!stream.good() && !stream.eof()) {
+            error = "Falha ao ler " + file;
+            return false;
+        }
+        inputs.push_back(Input{file, std::make_shared<const std::string>(std::move(data))});
+    }
+    // Ordenadas por tamanho para a escolha pelo tamanho sorteado
+    std::sort(inputs.begin(), inputs.end(), [](const Input& a, const Input& b) { return a.data->size() < b.data->size(); });
+    return true;
+}
+
+// Sorteios compartilhados entre as threads que iniciam chamadas
+class Picker {
+public:
+    Picker(const Options& options, const std::vector<Input>& pdfs, const std::vector<Input>& images)
+        : options_(options), pdfs_(pdfs), images_(images), random_(options.seed) {
+        std::vector<double> weights;
+        for (const auto& entry : options.mix) weights.push_back(entry.second);
+        rpc_choice_ = std::discrete_distribution<size_t>(weights.begin(), weights.end());
+    }
+
+    Rpc rpc() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return options_.mix[rpc_choice_(random_)].first;
+    }
+
+    const Input& input(Rpc rpc) {
+        const std::vector<Input>& inputs = usesPdf(rpc) ? pdfs_ : images_;
+        std::lock_guard<std::mutex> lock(mutex_);
+        const SizeDistribution& distribution = options_.size_distribution;
+        if (distribution.kind == SizeDistribution::Kind::Uniform) {
+            return inputs[std::uniform_int_distribution<size_t>(0, inputs.size() - 1)(random_)];
+        }
+        double target = distribution.size;
+        if (distribution.kind == SizeDistribution::Kind::LogNormal) {
+            target = std::lognormal_distribution<double>(std::log(distribution.size), distribution.sigma)(random_);
+        }
+        auto nearest = std::lower_bound(inputs.begin(), inputs.end(), target,
+                                        [](const Input& input, double size) { return static_cast<double>(input.data->size()) < size; });
+        if (nearest == inputs.end()) return inputs.back();
+        if (nearest != inputs.begin() && target - static_cast<double>(std::prev(nearest)->data->size()) <
+                                             static_cast<double>(nearest->data->size()) - target) {
+            --nearest;
+        }
+        return *nearest;
+    }
+
+    // Intervalo até a próxima chegada em laço aberto
+    double nextArrival() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return std::exponential_distribution<double>(options_.rate)(random_);
+    }
+
+private:
+    const Options& options_;
+    const std::vector<Input>& pdfs_;
+    const std::vector<Input>& images_;
+    std::mutex mutex_;
+    std::mt19937_64 random_;
+    std::discrete_distribution<size_t> rpc_choice_;
+};
+
+// --- Resultados ---
+
+struct Sample {
+    Rpc rpc;
+    Clock::time_point intended; // início planejado (laço aberto) ou real (laço fechado)
+    Clock::duration latency;
+    Clock::duration first_byte;  // até o primeiro chunk de resposta; negativo se não houve
+    grpc::StatusCode code;
+    size_t bytes_sent;
+    size_t bytes_received;
+};
+
+struct Summary {
+    uint64_t calls = 0;
+    uint64_t ok = 0;
+    std::map<std::string, uint64_t> errors; // por código
+    uint64_t bytes_sent = 0;
+    uint64_t bytes_received = 0;
+    std::vector<double> latency_ms;
+    std::vector<double> first_byte_ms;
+};
+
+const char* codeName(grpc::StatusCode code) {
+    static const char* const names[] = {
+        "OK", "CANCELLED", "UNKNOWN", "INVALID_ARGUMENT", "DEADLINE_EXCEEDED", "NOT_FOUND",
+        "ALREADY_EXISTS", "PERMISSION_DENIED", "RESOURCE_EXHAUSTED", "FAILED_PRECONDITION", "ABORTED",
+        "OUT_OF_RANGE", "UNIMPLEMENTED", "INTERNAL", "UNAVAILABLE", "DATA_LOSS", "UNAUTHENTICATED",
+    };
+    size_t index = static_cast<size_t>(code);
+    return index < sizeof(names) / sizeof(names[0]) ? names[index] : "UNKNOWN";
+}
+
+double percentile(std::vector<double>& sorted, double q) {
+    if (sorted.empty()) return 0;
+    size_t rank = static_cast<size_t>(std::ceil(q * static_cast<double>(sorted.size())));
+    return sorted[std::min(sorted.size(), std::max<size_t>(rank, 1)) - 1];
+}
+
+void add(Summary& summary, const Sample& sample) {
+    ++summary.calls;
+    summary.bytes_sent += sample.bytes_sent;
+    summary.bytes_received += sample.bytes_received;
+    if (sample.code != grpc::StatusCode::OK) {
+        ++summary.errors[codeName(sample.code)];
+        return;
+    }
+    ++summary.ok;
+    summary.latency_ms.push_back(std::chrono::duration<double, std::milli>(sample.latency).count());
+    if (sample.first_byte >= Clock::duration::zero()) {
+        summary.first_byte_ms.push_back(std::chrono::duration<double, std::milli>(sample.first_byte).count());
+    }
+}
+
+// --- Chamadas ---
+
+class Driver;
+
+void setContent(FileChunk& message, const char* data, size_t size) { message.set_content(data, size); }
+void setContent(ConvertTextRequest& message, const char* data, size_t size) { message.set_content(data, size); }
+void setContent(ConvertImageRequest& message, const char* data, size_t size) { message.set_content(data, size); }
+void setContent(ResizeImageRequest& message, const char* data, size_t size) { message.set_content(data, size); }
+
+// Uma chamada assíncrona: envia o cabeçalho (se houver) e a entrada em chunks enquanto já
+// espera a resposta; se destrói em OnDone depois de entregar a amostra ao Driver
+template <typename Request>
+class Call final : public grpc::ClientBidiReactor<Request, FileChunk> {
+public:
+    using Begin = void (FileProcessorService::Stub::async::*)(grpc::ClientContext*, grpc::ClientBidiReactor<Request, FileChunk>*);
+
+    Call(Driver& driver, Rpc rpc, std::shared_ptr<const std::string> input, Clock::time_point intended, const Options& options,
+         std::unique_ptr<Request> header)
+        : driver_(driver), rpc_(rpc), input_(std::move(input)), intended_(intended), chunk_size_(options.chunk_size),
+          header_(std::move(header)) {
+        context_.set_deadline(std::chrono::system_clock::now() +
+                              std::chrono::milliseconds(static_cast<int64_t>(options.timeout * 1000)));
+        if (!options.compression.empty()) context_.AddMetadata("x-response-compression", options.compression);
+    }
+
+    void start(FileProcessorService::Stub* stub, Begin begin) {
+        (stub->async()->*begin)(&context_, this);
+        this->StartRead(&response_);
+        writeNext();
+        this->StartCall();
+    }
+
+    void OnWriteDone(bool ok) override {
+        if (ok) writeNext();
+    }
+
+    void OnReadDone(bool ok) override {
+        if (!ok) return;
+        if (received_ == 0 && first_byte_ == Clock::time_point()) first_byte_ = Clock::now();
+        received_ += response_.content().size();
+        this->StartRead(&response_);
+    }
+
+    void OnDone(const grpc::Status& status) override;
+
+private:
+    void writeNext() {
+        if (header_) {
+            request_ = std::move(*header_);
+            header_.reset();
+            this->StartWrite(&request_);
+            return;
+        }
+        if (offset_ < input_->size() || (offset_ == 0 && !wrote_any_)) {
+            size_t count = std::min(chunk_size_, input_->size() - offset_);
+            request_.Clear();
+            setContent(request_, input_->data() + offset_, count);
+            offset_ += count;
+            wrote_any_ = true;
+            this->StartWrite(&request_);
+            return;
+        }
+        this->StartWritesDone();
+    }
+
+    Driver& driver_;
+    Rpc rpc_;
+    std::shared_ptr<const std::string> input_;
+    Clock::time_point intended_;
+    size_t chunk_size_;
+    std::unique_ptr<Request> header_;
+
+    grpc::ClientContext context_;
+    Request request_;
+    FileChunk response_;
+    size_t offset_ = 0;
+    bool wrote_any_ = false;
+    size_t received_ = 0;
+    Clock::time_point first_byte_;
+};
+
+// Inicia as chamadas, recolhe as amostras e decide quando parar
+class Driver {
+public:
+    Driver(const Options& options, Picker& picker)
+        : options_(options), picker_(picker),
+          stub_(FileProcessorService::NewStub(grpc::CreateChannel(options.target, grpc::InsecureChannelCredentials()))) {}
+
+    void run() {
+        started_ = Clock::now();
+        measure_from_ = started_ + seconds(options_.warmup);
+        measure_until_ = measure_from_ + seconds(options_.duration);
+
+        if (options_.rate > 0) {
+            runOpenLoop();
+        } else {
+            for (size_t i = 0; i < options_.concurrency; ++i) launch(Clock::now());
+        }
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_.wait(lock, [this]() { return outstanding_ == 0; });
+        finished_ = Clock::now();
+    }
+
+    // Chamado por cada chamada ao terminar (em uma thread do gRPC)
+    void finished(const Sample& sample) {
+        bool measured = sample.intended >= measure_from_ && sample.intended < measure_until_;
+        bool relaunch = false;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (measured) {
+                samples_.push_back(sample);
+                if (options_.requests > 0 && samples_.size() >= options_.requests) stop_ = true;
+            }
+            relaunch = options_.rate == 0 && !stop_ && Clock::now() < measure_until_;
+            if (!relaunch) --outstanding_;
+        }
+        if (relaunch) {
+            startCall(Clock::now());
+        } else {
+            done_.notify_all();
+        }
+    }
+
+    const std::vector<Sample>& samples() const { return samples_; }
+    uint64_t skipped() const { return skipped_; }
+
+    // Janela em que as chamadas medidas foram iniciadas (encurtada se --requests encerrou antes)
+    double measuredSeconds() const {
+        Clock::time_point end = std::min(measure_until_, last_measured_start());
+        return std::max(1e-9, std::chrono::duration<double>(end - measure_from_).count());
+    }
+
+private:
+    static Clock::duration seconds(double value) {
+        return std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(value));
+    }
+
+    Clock::time_point last_measured_start() const {
+        if (options_.requests == 0 || samples_.size() < options_.requests) return measure_until_;
+        Clock::time_point last = measure_from_;
+        for (const auto& sample : samples_) last = std::max(last, sample.intended + sample.latency);
+        return last;
+    }
+
+    void launch(Clock::time_point intended) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            ++outstanding_;
+        }
+        startCall(intended);
+    }
+
+    // Chegadas de Poisson: o instante de cada chamada não depende de as anteriores terem terminado
+    void runOpenLoop() {
+        Clock::time_point next = Clock::now();
+        while (next < measure_until_) {
+            std::this_thread::sleep_until(next);
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (stop_) break;
+                if (outstanding_ >= options_.max_outstanding) {
+                    if (next >= measure_from_) ++skipped_;
+                    next += seconds(picker_.nextArrival());
+                    continue;
+                }
+                ++outstanding_;
+            }
+            startCall(next);
+            next += seconds(picker_.nextArrival());
+        }
+    }
+
+    void startCall(Clock::time_point intended) {
+        Rpc rpc = picker_.rpc();
+        std::shared_ptr<const std::string> input = picker_.input(rpc).data;
+        switch (rpc) {
+            case Rpc::CompressPDF:
+                (new Call<FileChunk>(*this, rpc, input, intended, options_, nullptr))
+                    ->start(stub_.get(), &FileProcessorService::Stub::async::CompressPDF);
+                break;
+            case Rpc::ConvertToTXT:
+                (new Call<ConvertTextRequest>(*this, rpc, input, intended, options_, nullptr))
+                    ->start(stub_.get(), &FileProcessorService::Stub::async::ConvertToTXT);
+                break;
+            case Rpc::ConvertImageFormat: {
+                auto header = std::make_unique<ConvertImageRequest>();
+                header->set_output_format(options_.format);
+                (new Call<ConvertImageRequest>(*this, rpc, input, intended, options_, std::move(header)))
+                    ->start(stub_.get(), &FileProcessorService::Stub::async::ConvertImageFormat);
+                break;
+            }
+            case Rpc::ResizeImage: {
+                auto header = std::make_unique<ResizeImageRequest>();
+                header->mutable_dimensions()->set_width(options_.width);
+                header->mutable_dimensions()->set_height(options_.height);
+                (new Call<ResizeImageRequest>(*this, rpc, input, intended, options_, std::move(header)))
+                    ->start(stub_.get(), &FileProcessorService::Stub::async::ResizeImage);
+                break;
+            }
+        }
+    }
+
+    const Options& options_;
+    Picker& picker_;
+    std::unique_ptr<FileProcessorService::Stub> stub_;
+
+    Clock::time_point started_;
+    Clock::time_point measure_from_;
+    Clock::time_point measure_until_;
+    Clock::time_point finished_;
+
+    std::mutex mutex_;
+    std::condition_variable done_;
+    size_t outstanding_ = 0;
+    bool stop_ = false;
+    uint64_t skipped_ = 0;
+    std::vector<Sample> samples_;
+};
+
+template <typename Request>
+void Call<Request>::OnDone(const grpc::Status& status) {
+    Clock::time_point now = Clock::now();
+    Sample sample;
+    sample.rpc = rpc_;
+    sample.intended = intended_;
+    sample.latency = now - intended_;
+    sample.first_byte = first_byte_ == Clock::time_point() ? Clock::duration(-1) : first_byte_ - intended_;
+    sample.code = status.error_code();
+    sample.bytes_sent = offset_;
+    sample.bytes_received = received_;
+    Driver& driver = driver_;
+    delete this;
+    driver.finished(sample);
+}
+
+// --- Relatório ---
+
+struct Report {
+    std::string name;
+    Summary summary;
+};
+
+std::string formatMs(double value) {
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%.2f", value);
+    return buffer;
+}
+
+void printTable(FILE* out, const std::vector<Report>& reports, double seconds, uint64_t skipped) {
+    std::fprintf(out, "%-20s %8s %8s %9s %9s %9s %9s %9s %9s %9s %9s\n", "método", "chamadas", "erros", "req/s", "MB/s env",
+                "p50 ms", "p90 ms", "p99 ms", "p99.9 ms", "ttfb p50", "ttfb p99");
+    for (auto report : reports) {
+        Summary& s = report.summary;
+        std::sort(s.latency_ms.begin(), s.latency_ms.end());
+        std::sort(s.first_byte_ms.begin(), s.first_byte_ms.end());
+        std::fprintf(out, "%-20s %8llu %8llu %9.2f %9.2f %9s %9s %9s %9s %9s %9s\n", report.name.c_str(),
+                    static_cast<unsigned long long>(s.calls), static_cast<unsigned long long>(s.calls - s.ok),
+                    static_cast<double>(s.ok) / seconds, static_cast<double>(s.bytes_sent) / seconds / (1024 * 1024),
+                    formatMs(percentile(s.latency_ms, 0.50)).c_str(), formatMs(percentile(s.latency_ms, 0.90)).c_str(),
+                    formatMs(percentile(s.latency_ms, 0.99)).c_str(), formatMs(percentile(s.latency_ms, 0.999)).c_str(),
+                    formatMs(percentile(s.first_byte_ms, 0.50)).c_str(), formatMs(percentile(s.first_byte_ms, 0.99)).c_str());
+        for (const auto& error : s.errors) std::fprintf(out, "%-20s   %s: %llu\n", "", error.first.c_str(), static_cast<unsigned long long>(error.second));
+    }
+    if (skipped > 0) std::fprintf(out, "Chegadas descartadas (limite de chamadas simultâneas): %llu\n", static_cast<unsigned long long>(skipped));
+}
+
+std::string jsonQuantiles(std::vector<double> values) {
+    std::sort(values.begin(), values.end());
+    double sum = 0;
+    for (double value : values) sum += value;
+    std::ostringstream out;
+    out << "{\"count\":" << values.size() << ",\"mean\":" << (values.empty() ? 0 : sum / static_cast<double>(values.size()))
+        << ",\"p50\":" << percentile(values, 0.50) << ",\"p90\":" << percentile(values, 0.90)
+        << ",\"p99\":" << percentile(values, 0.99) << ",\"p999\":" << percentile(values, 0.999)
+        << ",\"max\":" << (values.empty() ? 0 : values.back()) << "}";
+    return out.str();
+}
+
+std::string toJson(const Options& options, const std::vector<Report>& reports, double seconds, uint64_t skipped) {
+    std::ostringstream out;
+    out << "{\"config\":{\"target\":\"" << options.target << "\",\"manifest\":\"" << options.manifest << "\",\"mode\":\"" << (options.rate > 0 ? "open" : "closed")
+        << "\",\"concurrency\":" << options.concurrency << ",\"rate\":" << options.rate << ",\"duration\":" << options.duration
+        << ",\"warmup\":" << options.warmup << ",\"chunk_size\":" << options.chunk_size << ",\"seed\":" << options.seed
+        << ",\"format\":\"" << options.format << "\",\"size\":\"" << options.width << "x" << options.height << "\"},";
+    out << "\"measured_seconds\":" << seconds << ",\"skipped_arrivals\":" << skipped << ",\"methods\":{";
+    for (size_t i = 0; i < reports.size(); ++i) {
+        const Summary& s = reports[i].summary;
+        if (i > 0) out << ",";
+        out << "\"" << reports[i].name << "\":{\"calls\":" << s.calls << ",\"ok\":" << s.ok << ",\"errors\":{";
+        size_t j = 0;
+        for (const auto& error : s.errors) out << (j++ ? "," : "") << "\"" << error.first << "\":" << error.second;
+        out << "},\"throughput_rps\":" << static_cast<double>(s.ok) / seconds
+            << ",\"sent_bytes_per_second\":" << static_cast<double>(s.bytes_sent) / seconds
+            << ",\"received_bytes_per_second\":" << static_cast<double>(s.bytes_received) / seconds
+            << ",\"latency_ms\":" << jsonQuantiles(s.latency_ms) << ",\"ttfb_ms\":" << jsonQuantiles(s.first_byte_ms) << "}";
+    }
+    out << "}}\n";
+    return out.str();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    std::string error;
+    if (!parseOptions(argc, argv, options, error)) {
+        std::cerr << error << std::endl << usage(argv[0]);
+        return 1;
+    }
+
+    std::vector<Input> pdfs, images;
+    if (!loadInputs(options.pdf_paths, pdfs, error) || !loadInputs(options.image_paths, images, error)) {
+        std::cerr << error << std::endl;
+        return 1;
+    }
+    for (const auto& entry : options.mix) {
+        if ((usesPdf(entry.first) ? pdfs : images).empty()) {
+            std::cerr << "Nenhuma entrada para " << rpcName(entry.first) << " (use " << (usesPdf(entry.first) ? "--pdf" : "--image")
+                      << " ou ajuste --mix)." << std::endl
+                      << usage(argv[0]);
+            return 1;
+        }
+    }
+
+    std::cerr << "Carga em " << options.target << ": ";
+    if (options.rate > 0) {
+        std::cerr << "laço aberto, " << options.rate << " chamadas/s";
+    } else {
+        std::cerr << "laço fechado, " << options.concurrency << " chamadas simultâneas";
+    }
+    std::cerr << ", " << options.warmup << " s de aquecimento + " << options.duration << " s medidos." << std::endl;
+
+    Picker picker(options, pdfs, images);
+    Driver driver(options, picker);
+    driver.run();
+
+    std::vector<Report> reports;
+    Summary all;
+    for (const auto& entry : options.mix) {
+        Report report{rpcName(entry.first), Summary()};
+        for (const auto& sample : driver.samples()) {
+            if (sample.rpc == entry.first) add(report.summary, sample);
+        }
+        reports.push_back(std::move(report));
+    }
+    for (const auto& sample : driver.samples()) add(all, sample);
+    reports.push_back(Report{"total", std::move(all)});
+
+    double seconds = driver.measuredSeconds();
+    // Com o JSON na saída padrão, a tabela vai para a saída de erro
+    printTable(options.json_path == "-" ? stderr : stdout, reports, seconds, driver.skipped());
+
+    if (!options.json_path.empty()) {
+        std::string json = toJson(options, reports, seconds, driver.skipped());
+        if (options.json_path == "-") {
+            std::cout << json;
+        } else {
+            std::ofstream(options.json_path) << json;
+        }
+    }
+    return 0;
+}
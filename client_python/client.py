@@ -7,8 +7,44 @@ sys.path.append(os.path.join(os.path.dirname(__file__), '../proto'))
 import file_processor_pb2
 import file_processor_pb2_grpc
 
+try:
+    import zstandard
+except ImportError:
+    zstandard = None
+
 CHUNK_SIZE = 1024 * 1024  # 1MB
 
+# Compressão das respostas pedida ao servidor (gzip, deflate ou zstd); None = sem compressão
+COMPRESSION = None
+
+def call_metadata():
+    """Metadados de cada chamada: pede a compressão escolhida em --compression."""
+    if COMPRESSION is None:
+        return None
+    return [('x-response-compression', COMPRESSION)]
+
+def write_chunks(response_iterator, output_path):
+    """Grava os chunks recebidos, descomprimindo os que chegam como frames zstd.
+
+    Com gzip e deflate o próprio gRPC descomprime as mensagens. output_path também pode ser
+    uma lista: cada chunk vai para o arquivo do seu output_index (ResizeImage com vários
+    tamanhos)."""
+    decompressor = zstandard.ZstdDecompressor() if zstandard else None
+    paths = output_path if isinstance(output_path, list) else [output_path]
+    files = [open(path, 'wb') for path in paths]
+    try:
+        for chunk in response_iterator:
+            if chunk.output_index >= len(files):
+                raise RuntimeError("chunk recebido para uma saída inexistente")
+            f = files[chunk.output_index]
+            if chunk.encoding == file_processor_pb2.ZSTD:
+                f.write(decompressor.decompress(chunk.content))
+            else:
+                f.write(chunk.content)
+    finally:
+        for f in files:
+            f.close()
+
 def get_file_chunks(file_path):
     """Lê um arquivo e o retorna em pedaços (chunks)."""
     try:
@@ -25,19 +61,26 @@ def get_file_chunks(file_path):
 def stream_compress_pdf(stub, input_path, output_path):
     """Chama o serviço de compressão de PDF."""
     print("Enviando arquivo para compressão...")
-    response_iterator = stub.CompressPDF(get_file_chunks(input_path))
-    with open(output_path, 'wb') as f:
-        for chunk in response_iterator:
-            f.write(chunk.content)
+    response_iterator = stub.CompressPDF(get_file_chunks(input_path), metadata=call_metadata())
+    write_chunks(response_iterator, output_path)
     print(f"PDF comprimido salvo em: {output_path}")
 
-def stream_convert_to_txt(stub, input_path, output_path):
-    """Chama o serviço de conversão para TXT."""
+def stream_convert_to_txt(stub, input_path, output_path, first_page=0, last_page=0, max_chars=0):
+    """Chama o serviço de conversão para TXT.
+
+    first_page/last_page (0 = desde a primeira/até a última) e max_chars (0 = sem limite)
+    restringem o texto extraído."""
+    def request_iterator():
+        # Primeira mensagem com as opções, só quando alguma foi escolhida
+        if first_page or last_page or max_chars:
+            options = file_processor_pb2.TextOptions(first_page=first_page, last_page=last_page, max_chars=max_chars)
+            yield file_processor_pb2.ConvertTextRequest(options=options)
+        for chunk in get_file_chunks(input_path):
+            yield file_processor_pb2.ConvertTextRequest(content=chunk.content)
+
     print("Enviando arquivo para conversão TXT...")
-    response_iterator = stub.ConvertToTXT(get_file_chunks(input_path))
-    with open(output_path, 'wb') as f:
-        for chunk in response_iterator:
-            f.write(chunk.content)
+    response_iterator = stub.ConvertToTXT(request_iterator(), metadata=call_metadata())
+    write_chunks(response_iterator, output_path)
     print(f"Arquivo de texto salvo em: {output_path}")
 
 def stream_convert_image(stub, input_path, output_path, new_format):
@@ -54,10 +97,8 @@ def stream_convert_image(stub, input_path, output_path, new_format):
                 yield file_processor_pb2.ConvertImageRequest(content=chunk)
 
     print(f"Enviando imagem para converter para o formato '{new_format}'...")
-    response_iterator = stub.ConvertImageFormat(request_iterator())
-    with open(output_path, 'wb') as f:
-        for chunk in response_iterator:
-            f.write(chunk.content)
+    response_iterator = stub.ConvertImageFormat(request_iterator(), metadata=call_metadata())
+    write_chunks(response_iterator, output_path)
     print(f"Imagem convertida salva em: {output_path}")
     
 def stream_resize_image(stub, input_path, output_path, width, height):
@@ -75,13 +116,47 @@ def stream_resize_image(stub, input_path, output_path, width, height):
                 yield file_processor_pb2.ResizeImageRequest(content=chunk)
 
     print(f"Enviando imagem para redimensionar para {width}x{height}...")
-    response_iterator = stub.ResizeImage(request_iterator())
-    with open(output_path, 'wb') as f:
-        for chunk in response_iterator:
-            f.write(chunk.content)
+    response_iterator = stub.ResizeImage(request_iterator(), metadata=call_metadata())
+    write_chunks(response_iterator, output_path)
     print(f"Imagem redimensionada salva em: {output_path}")
 
+def stream_resize_image_sizes(stub, input_path, output_prefix, sizes):
+    """Gera vários tamanhos da imagem em uma só chamada; cada um é salvo em
+    <output_prefix>_<largura>x<altura> com a extensão da entrada."""
+    extension = os.path.splitext(input_path)[1]
+    output_paths = [f"{output_prefix}_{width}x{height}{extension}" for width, height in sizes]
+
+    def request_iterator():
+        # Primeira mensagem com os tamanhos
+        outputs = [file_processor_pb2.ResizeOutput(dimensions=file_processor_pb2.Dimensions(width=width, height=height))
+                   for width, height in sizes]
+        yield file_processor_pb2.ResizeImageRequest(outputs=file_processor_pb2.ResizeOutputs(outputs=outputs))
+        with open(input_path, 'rb') as f:
+            while True:
+                chunk = f.read(CHUNK_SIZE)
+                if not chunk:
+                    break
+                yield file_processor_pb2.ResizeImageRequest(content=chunk)
+
+    print(f"Enviando imagem para gerar {len(sizes)} tamanhos...")
+    response_iterator = stub.ResizeImage(request_iterator(), metadata=call_metadata())
+    write_chunks(response_iterator, output_paths)
+    for path in output_paths:
+        print(f"Imagem redimensionada salva em: {path}")
+
+def parse_args():
+    """Lê --compression=gzip|deflate|zstd da linha de comando."""
+    global COMPRESSION
+    for arg in sys.argv[1:]:
+        name, _, value = arg.partition('=')
+        if name != '--compression' or value not in ('gzip', 'deflate', 'zstd'):
+            sys.exit(f"Uso: {sys.argv[0]} [--compression=gzip|deflate|zstd]")
+        if value == 'zstd' and zstandard is None:
+            sys.exit("O módulo zstandard não está instalado; use gzip ou deflate.")
+        COMPRESSION = value
+
 def run():
+    parse_args()
     # Compilar o .proto para Python
     os.system('python3 -m grpc_tools.protoc -I../proto --python_out=../proto --grpc_python_out=../proto ../proto/file_processor.proto')
 
@@ -94,7 +169,8 @@ def run():
             print("2. Converter PDF para TXT")
             print("3. Converter formato de Imagem")
             print("4. Redimensionar Imagem")
-            print("5. Sair")
+            print("5. Redimensionar Imagem em vários tamanhos")
+            print("6. Sair")
             choice = input("Escolha uma opção: ")
 
             if choice == '1':
@@ -104,7 +180,15 @@ def run():
             elif choice == '2':
                 in_path = input("Caminho do PDF de entrada: ")
                 out_path = input("Caminho do arquivo TXT de saída: ")
-                stream_convert_to_txt(stub, in_path, out_path)
+                pages = input("Páginas (ex: 1-3; vazio = todas): ").strip()
+                max_chars = input("Máximo de caracteres (vazio = sem limite): ").strip()
+                first_page = last_page = 0
+                if pages:
+                    # "N" sozinho é só a página N
+                    first, _, last = pages.partition('-')
+                    first_page = int(first)
+                    last_page = int(last) if last else first_page
+                stream_convert_to_txt(stub, in_path, out_path, first_page, last_page, int(max_chars or 0))
             elif choice == '3':
                 in_path = input("Caminho da imagem de entrada: ")
                 out_path = input("Caminho da imagem de saída (ex: out.png): ")
@@ -117,6 +201,15 @@ def run():
                 height = int(input("Altura desejada: "))
                 stream_resize_image(stub, in_path, out_path, width, height)
             elif choice == '5':
+                in_path = input("Caminho da imagem de entrada: ")
+                out_prefix = input("Prefixo das imagens de saída: ")
+                sizes_line = input("Tamanhos (ex: 1024x768 256x192): ")
+                sizes = []
+                for size in sizes_line.split():
+                    width, _, height = size.partition('x')
+                    sizes.append((int(width), int(height)))
+                stream_resize_image_sizes(stub, in_path, out_prefix, sizes)
+            elif choice == '6':
                 break
             else:
                 print("Opção inválida.")
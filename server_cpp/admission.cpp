@@ -0,0 +1,133 @@
+#include "admission.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace {
+
+// Peso da última chamada na média móvel da duração
+const double kAverageWeight = 0.2;
+
+const std::chrono::milliseconds kMinRetryAfter{100};
+const std::chrono::milliseconds kMaxRetryAfter{60000};
+
+} // namespace
+
+AdmissionController::AdmissionController() : expirer_([this]() { expireLoop(); }) {}
+
+AdmissionController::~AdmissionController() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    changed_.notify_all();
+    expirer_.join();
+}
+
+void AdmissionController::configure(const std::string& method, const AdmissionLimits& limits) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    methods_[method].limits = limits;
+}
+
+void AdmissionController::acquire(const std::string& method, Decision decide) {
+    std::chrono::milliseconds retry_after{0};
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = methods_.find(method);
+        if (it == methods_.end()) {
+            retry_after = std::chrono::milliseconds(-1);
+        } else {
+            Method& state = it->second;
+            if (state.limits.max_active == 0 || state.active < state.limits.max_active) {
+                ++state.active;
+                retry_after = std::chrono::milliseconds(-1);
+            } else if (state.queue.size() < state.limits.max_queued) {
+                bool was_empty = state.queue.empty();
+                state.queue.push_back({std::chrono::steady_clock::now() + state.limits.queue_timeout, std::move(decide)});
+                // Só o prazo mais próximo de cada fila interessa à thread de expiração
+                if (was_empty) changed_.notify_one();
+                return;
+            } else {
+                retry_after = retryAfter(state);
+            }
+        }
+    }
+    // Fora do lock: decide pode iniciar a leitura do stream ou encerrar a chamada
+    bool admitted = retry_after.count() < 0;
+    decide(admitted, admitted ? std::chrono::milliseconds(0) : retry_after);
+}
+
+void AdmissionController::release(const std::string& method, std::chrono::steady_clock::duration held) {
+    Decision next;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = methods_.find(method);
+        if (it == methods_.end()) return;
+        Method& state = it->second;
+
+        double held_ms = std::chrono::duration<double, std::milli>(held).count();
+        state.average_ms = state.average_ms == 0.0 ? held_ms : state.average_ms + kAverageWeight * (held_ms - state.average_ms);
+
+        // A vaga passa direto para o primeiro da fila, sem voltar a ficar livre
+        if (!state.queue.empty()) {
+            next = std::move(state.queue.front().decide);
+            state.queue.pop_front();
+        } else {
+            --state.active;
+        }
+    }
+    if (next) next(true, std::chrono::milliseconds(0));
+}
+
+AdmissionController::Usage AdmissionController::usage(const std::string& method) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Usage usage;
+    auto it = methods_.find(method);
+    if (it != methods_.end()) {
+        usage.active = it->second.active;
+        usage.queued = it->second.queue.size();
+    }
+    return usage;
+}
+
+// Tempo estimado até surgir uma vaga: a duração média das chamadas vezes as filas de espera à frente
+std::chrono::milliseconds AdmissionController::retryAfter(const Method& method) const {
+    double estimate = static_cast<double>(method.limits.queue_timeout.count());
+    if (method.average_ms > 0.0) {
+        size_t slots = std::max<size_t>(1, method.limits.max_active);
+        estimate = method.average_ms * static_cast<double>(method.queue.size() + 1) / static_cast<double>(slots);
+    }
+    auto retry = std::chrono::milliseconds(static_cast<long long>(estimate));
+    return std::min(std::max(retry, kMinRetryAfter), kMaxRetryAfter);
+}
+
+void AdmissionController::expireLoop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stopping_) {
+        auto now = std::chrono::steady_clock::now();
+        auto next_deadline = std::chrono::steady_clock::time_point::max();
+        std::vector<std::pair<Decision, std::chrono::milliseconds>> expired;
+
+        for (auto& entry : methods_) {
+            Method& state = entry.second;
+            while (!state.queue.empty() && state.queue.front().deadline <= now) {
+                expired.emplace_back(std::move(state.queue.front().decide), std::chrono::milliseconds(0));
+                state.queue.pop_front();
+                expired.back().second = retryAfter(state);
+            }
+            if (!state.queue.empty()) next_deadline = std::min(next_deadline, state.queue.front().deadline);
+        }
+
+        if (!expired.empty()) {
+            lock.unlock();
+            for (auto& item : expired) item.first(false, item.second);
+            lock.lock();
+            continue;
+        }
+        if (next_deadline == std::chrono::steady_clock::time_point::max()) {
+            changed_.wait(lock);
+        } else {
+            changed_.wait_until(lock, next_deadline);
+        }
+    }
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// Limites de um método do serviço
+struct AdmissionLimits {
+    size_t max_active = 16;  // chamadas em andamento (upload, processamento e envio)
+    size_t max_queued = 64;  // chamadas esperando uma vaga
+    std::chrono::milliseconds queue_timeout{5000}; // espera máxima na fila
+};
+
+// Controle de admissão por método: cada chamada reserva uma vaga antes de o upload começar,
+// o que limita ao mesmo tempo os processos filhos, a memória e o espaço em /tmp. Sem vaga,
+// a chamada espera em uma fila limitada; se a fila estiver cheia ou a espera passar do
+// limite, ela é recusada na hora em vez de deixar todas as outras mais lentas.
+// A espera não ocupa nenhuma thread: a decisão chega por callback.
+class AdmissionController {
+public:
+    // admitted == false indica recusa; retry_after é a sugestão de espera para o cliente
+    using Decision = std::function<void(bool admitted, std::chrono::milliseconds retry_after)>;
+
+    AdmissionController();
+    ~AdmissionController();
+
+    // Define os limites de method. Métodos não configurados são sempre admitidos.
+    void configure(const std::string& method, const AdmissionLimits& limits);
+
+    // Pede uma vaga em method. decide é chamado exatamente uma vez: imediatamente, quando uma
+    // vaga for liberada (na thread de quem liberou) ou quando a espera expirar (na thread do controle).
+    void acquire(const std::string& method, Decision decide);
+
+    // Devolve a vaga de uma chamada admitida; held é quanto tempo ela ficou ocupada
+    void release(const std::string& method, std::chrono::steady_clock::duration held);
+
+    // Chamadas admitidas e na fila de method, para as métricas
+    struct Usage {
+        size_t active = 0;
+        size_t queued = 0;
+    };
+    Usage usage(const std::string& method);
+
+    AdmissionController(const AdmissionController&) = delete;
+    AdmissionController& operator=(const AdmissionController&) = delete;
+
+private:
+    struct Waiter {
+        std::chrono::steady_clock::time_point deadline;
+        Decision decide;
+    };
+
+    struct Method {
+        AdmissionLimits limits;
+        size_t active = 0;
+        std::deque<Waiter> queue; // em ordem de chegada (e portanto de prazo)
+        double average_ms = 0.0;  // média móvel da duração das chamadas
+    };
+
+    std::chrono::milliseconds retryAfter(const Method& method) const;
+    void expireLoop();
+
+    std::mutex mutex_;
+    std::condition_variable changed_;
+    std::map<std::string, Method> methods_;
+    bool stopping_ = false;
+    std::thread expirer_;
+};
@@ -0,0 +1,263 @@
+#include "batch_reactor.h"
+
+#include <algorithm>
+
+#include "logging.h"
+
+using file_processor::BatchJob;
+using file_processor::BatchRequest;
+
+BatchReactor::BatchReactor(JobExecutor& executor, size_t chunk_size, size_t parallelism, size_t max_job_input,
+                           MethodMetrics* metrics, RunJob run)
+    : executor_(executor), chunk_size_(chunk_size), parallelism_(std::max<size_t>(1, parallelism)),
+      max_job_input_(max_job_input), metrics_(metrics), run_(std::move(run)), created_at_(Clock::now()) {}
+
+BatchReactor::~BatchReactor() {
+    if (trace_) {
+        trace_->attribute(CallTrace::kRoot, "rpc.request.bytes", static_cast<int64_t>(received_));
+        trace_->attribute(CallTrace::kRoot, "rpc.response.bytes", static_cast<int64_t>(sent_));
+        trace_->attribute(CallTrace::kRoot, "batch.jobs", static_cast<int64_t>(jobs_));
+        trace_->attribute(CallTrace::kRoot, "batch.failed_jobs", static_cast<int64_t>(failed_jobs_));
+        trace_->finish(status_code_, status_message_);
+        Tracer& tracer = trace_->tracer();
+        tracer.submit(std::move(trace_));
+    }
+    if (metrics_) {
+        metrics_->record(Stage::Total, Clock::now() - created_at_);
+        metrics_->bytes_received += received_;
+        metrics_->bytes_sent += sent_;
+        metrics_->finished(status_code_);
+    }
+    if (on_done_) on_done_();
+}
+
+void BatchReactor::begin(std::function<void()> on_done) {
+    on_done_ = std::move(on_done);
+    Clock::time_point now = Clock::now();
+    if (metrics_) metrics_->record(Stage::Queue, now - created_at_);
+    if (trace_) trace_->add("queue", created_at_, now);
+    Actions actions;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        started_ = true;
+        actions = nextLocked();
+    }
+    perform(actions);
+}
+
+void BatchReactor::reject(const grpc::Status& status) {
+    Clock::time_point now = Clock::now();
+    if (metrics_) metrics_->record(Stage::Queue, now - created_at_);
+    if (trace_) trace_->add("queue", created_at_, now);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        finished_ = true;
+    }
+    status_code_ = static_cast<int>(status.error_code());
+    status_message_ = status.error_message();
+    Finish(status);
+}
+
+void BatchReactor::OnReadDone(bool ok) {
+    Actions actions;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        read_pending_ = false;
+        if (!ok) {
+            // Fim do stream (ou cancelamento): jobs sem a mensagem com last não podem ser processados
+            input_done_ = true;
+            for (const auto& job : open_) {
+                pushOutputLocked(job.first, grpc::Status(grpc::StatusCode::INVALID_ARGUMENT,
+                                                         "O stream terminou antes da última mensagem do job."), nullptr);
+            }
+            open_.clear();
+        } else if (!failed_) {
+            grpc::Status status = acceptLocked(request_);
+            if (!status.ok()) {
+                logOperation("ProcessBatch", "ERROR", status.error_message());
+                failLocked(status);
+            }
+        }
+        actions = nextLocked();
+    }
+    perform(actions);
+}
+
+void BatchReactor::OnWriteDone(bool ok) {
+    Actions actions;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        write_pending_ = false;
+        if (!ok) {
+            failLocked(grpc::Status(grpc::StatusCode::CANCELLED, "Cliente deixou de receber os resultados."));
+        } else if (response_.last()) {
+            busy_.erase(outputs_.front().job_id);
+            outputs_.pop_front();
+        }
+        actions = nextLocked();
+    }
+    perform(actions);
+}
+
+void BatchReactor::OnCancel() {
+    Actions actions;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        failLocked(grpc::Status(grpc::StatusCode::CANCELLED, "Chamada cancelada pelo cliente."));
+        actions = nextLocked();
+    }
+    perform(actions);
+}
+
+grpc::Status BatchReactor::acceptLocked(const BatchRequest& request) {
+    received_ += request.content().size();
+    uint64_t job_id = request.job_id();
+    auto it = open_.find(job_id);
+    if (request.has_job()) {
+        if (it != open_.end() || busy_.count(job_id) > 0) {
+            return grpc::Status(grpc::StatusCode::INVALID_ARGUMENT,
+                                "Job " + std::to_string(job_id) + " repetido: o id ainda está em uso no stream.");
+        }
+        if (open_.size() >= kMaxOpenJobs) {
+            return grpc::Status(grpc::StatusCode::RESOURCE_EXHAUSTED, "Jobs com entrada incompleta demais no mesmo stream.");
+        }
+        it = open_.emplace(job_id, OpenJob()).first;
+        it->second.job = request.job();
+        ++jobs_;
+    } else if (it == open_.end()) {
+        return grpc::Status(grpc::StatusCode::INVALID_ARGUMENT,
+                            "Mensagem do job " + std::to_string(job_id) + " sem cabeçalho: a primeira mensagem de cada job deve trazer job.");
+    }
+
+    OpenJob& open = it->second;
+    if (!open.too_large) {
+        if (open.input.size() + request.content().size() > max_job_input_) {
+            open.too_large = true;
+            std::string().swap(open.input);
+        } else {
+            open.input.append(request.content());
+        }
+    }
+    if (!request.last()) return grpc::Status::OK;
+
+    auto job = std::make_shared<OpenJob>(std::move(open));
+    open_.erase(it);
+    busy_.insert(job_id);
+    if (job->too_large) {
+        pushOutputLocked(job_id, grpc::Status(grpc::StatusCode::RESOURCE_EXHAUSTED,
+                                              "Entrada do job maior que o limite de " + std::to_string(max_job_input_ >> 20) + " MB."),
+                         nullptr);
+        return grpc::Status::OK;
+    }
+    ++running_;
+    executor_.post([this, job_id, job]() { runJob(job_id, job); });
+    return grpc::Status::OK;
+}
+
+void BatchReactor::runJob(uint64_t job_id, std::shared_ptr<OpenJob> job) {
+    Clock::time_point started = Clock::now();
+    BatchResult result = run_(job->job, job->input);
+    Clock::time_point ended = Clock::now();
+    if (metrics_) metrics_->record(Stage::Process, ended - started);
+    if (trace_) {
+        CallTrace::SpanId span = trace_->add("job", started, ended);
+        trace_->attribute(span, "batch.job_id", static_cast<int64_t>(job_id));
+        trace_->attribute(span, "batch.operation", file_processor::BatchOperation_Name(job->job.operation()));
+        trace_->attribute(span, "bytes", static_cast<int64_t>(job->input.size()));
+        trace_->attribute(span, "rpc.grpc.status_code", static_cast<int64_t>(result.status.error_code()));
+    }
+
+    Actions actions;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        --running_;
+        pushOutputLocked(job_id, result.status, std::move(result.output));
+        actions = nextLocked();
+    }
+    perform(actions);
+}
+
+void BatchReactor::pushOutputLocked(uint64_t job_id, grpc::Status status, std::shared_ptr<const std::string> data) {
+    if (!status.ok()) {
+        ++failed_jobs_;
+        data.reset();
+    }
+    Output output;
+    output.job_id = job_id;
+    output.status = std::move(status);
+    output.data = std::move(data);
+    outputs_.push_back(std::move(output));
+}
+
+void BatchReactor::failLocked(const grpc::Status& status) {
+    if (failed_) return;
+    failed_ = true;
+    failure_ = status;
+}
+
+BatchReactor::Actions BatchReactor::nextLocked() {
+    Actions actions;
+    if (!started_ || finished_) return actions;
+
+    if (!failed_ && !write_pending_ && !outputs_.empty()) {
+        // Próximo chunk do resultado mais antigo; o último leva o status do job
+        Output& output = outputs_.front();
+        size_t size = output.data ? output.data->size() : 0;
+        size_t count = std::min(chunk_size_, size - output.offset);
+        response_.Clear();
+        response_.set_job_id(output.job_id);
+        write_options_ = grpc::WriteOptions();
+        if (count > 0) encodeContent(output.data->data() + output.offset, count);
+        output.offset += count;
+        sent_ += count;
+        if (output.offset == size) {
+            response_.set_last(true);
+            response_.set_status_code(static_cast<int32_t>(output.status.error_code()));
+            response_.set_status_message(output.status.error_message());
+        }
+        write_pending_ = true;
+        actions.write = true;
+    }
+
+    if (!failed_ && !input_done_ && !read_pending_ && busy_.size() < parallelism_) {
+        read_pending_ = true;
+        actions.read = true;
+    }
+
+    bool idle = !read_pending_ && !write_pending_ && running_ == 0;
+    if (idle && (failed_ || (input_done_ && outputs_.empty()))) {
+        finished_ = true;
+        actions.finish = true;
+        actions.status = failed_ ? failure_ : grpc::Status::OK;
+    }
+    return actions;
+}
+
+void BatchReactor::encodeContent(const char* data, size_t size) {
+    bool compressible = compression_ != WireCompression::None && looksCompressible(data, size);
+    if (compression_ == WireCompression::Zstd) {
+        if (compressible && zstdCompress(data, size, zstd_level_, *response_.mutable_content())) {
+            response_.set_encoding(file_processor::ZSTD);
+            return;
+        }
+    } else if (compression_ != WireCompression::None && !compressible) {
+        write_options_.set_no_compression();
+    }
+    response_.set_content(data, size);
+}
+
+void BatchReactor::perform(const Actions& actions) {
+    if (actions.write) StartWrite(&response_, write_options_);
+    if (actions.read) StartRead(&request_);
+    if (!actions.finish) return;
+
+    status_code_ = static_cast<int>(actions.status.error_code());
+    status_message_ = actions.status.error_message();
+    std::string summary = std::to_string(jobs_) + " jobs, " + std::to_string(failed_jobs_) + " com falha.";
+    if (actions.status.ok()) {
+        logOperation("ProcessBatch", "SUCCESS", "Lote concluído: " + summary);
+    } else {
+        logOperation("ProcessBatch", "WARNING", "Lote interrompido (" + actions.status.error_message() + "): " + summary);
+    }
+    Finish(actions.status);
+}
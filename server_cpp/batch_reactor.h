@@ -0,0 +1,143 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+#include <grpcpp/grpcpp.h>
+#include "file_processor.grpc.pb.h"
+#include "job_executor.h"
+#include "metrics.h"
+#include "tracing.h"
+#include "wire_compression.h"
+
+// Resultado de um job do ProcessBatch
+struct BatchResult {
+    grpc::Status status;
+    std::shared_ptr<const std::string> output; // só com status ok
+};
+
+// Conduz um stream do ProcessBatch, que multiplexa vários jobs (um arquivo cada) na mesma chamada:
+//   - as mensagens de cada job são acumuladas em memória até a que traz last;
+//   - o job completo roda no JobExecutor, em paralelo com os demais;
+//   - os resultados são enviados em chunks na ordem em que ficam prontos, cada um encerrado
+//     com o status do job. A falha de um job não interrompe os outros.
+// Um job conta como em andamento até o último chunk do seu resultado ser escrito; com
+// parallelism jobs em andamento a leitura para, o que limita a memória e o trabalho de um
+// stream mesmo que o cliente não consuma as respostas. Violações do protocolo (job sem
+// cabeçalho, id repetido, jobs abertos demais) encerram o stream com INVALID_ARGUMENT ou
+// RESOURCE_EXHAUSTED. Como o TransferReactor, nada é lido antes de begin() e o reactor se
+// destrói sozinho em OnDone.
+class BatchReactor final : public grpc::ServerBidiReactor<file_processor::BatchRequest, file_processor::BatchResponse> {
+public:
+    // Executa um job no JobExecutor, com a entrada completa
+    using RunJob = std::function<BatchResult(const file_processor::BatchJob& job, const std::string& input)>;
+
+    // Jobs com entrada ainda incompleta aceitos ao mesmo tempo em um stream
+    static constexpr size_t kMaxOpenJobs = 1024;
+
+    BatchReactor(JobExecutor& executor, size_t chunk_size, size_t parallelism, size_t max_job_input,
+                 MethodMetrics* metrics, RunJob run);
+
+    // Começa a ler os jobs. on_done é chamado quando o stream termina (ex.: liberar a vaga).
+    void begin(std::function<void()> on_done);
+
+    // Encerra o stream sem ler nada (ex.: recusado pelo controle de admissão)
+    void reject(const grpc::Status& status);
+
+    // Rastreia o stream, com um span por job. Deve vir antes de begin().
+    void setTrace(std::unique_ptr<CallTrace> trace) { trace_ = std::move(trace); }
+
+    // Comprime os chunks dos resultados, como TransferReactor::setCompression. Deve vir antes de begin().
+    void setCompression(WireCompression compression, int zstd_level) {
+        compression_ = compression;
+        zstd_level_ = zstd_level;
+    }
+
+    void OnReadDone(bool ok) override;
+    void OnWriteDone(bool ok) override;
+    void OnCancel() override;
+    void OnDone() override { delete this; }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    // Job cuja entrada ainda está chegando
+    struct OpenJob {
+        file_processor::BatchJob job;
+        std::string input;
+        bool too_large = false; // entrada passou de max_job_input_; o restante é descartado
+    };
+
+    // Resultado aguardando envio
+    struct Output {
+        uint64_t job_id = 0;
+        grpc::Status status;
+        std::shared_ptr<const std::string> data;
+        size_t offset = 0;
+    };
+
+    // O que fazer depois de soltar o mutex: as operações do gRPC não são iniciadas com ele travado
+    struct Actions {
+        bool read = false;
+        bool write = false;
+        bool finish = false;
+        grpc::Status status;
+    };
+
+    ~BatchReactor() override;
+
+    // Trata uma mensagem recebida; retorna um status de erro se ela violar o protocolo
+    grpc::Status acceptLocked(const file_processor::BatchRequest& request);
+    void runJob(uint64_t job_id, std::shared_ptr<OpenJob> job);
+    void pushOutputLocked(uint64_t job_id, grpc::Status status, std::shared_ptr<const std::string> data);
+    void failLocked(const grpc::Status& status);
+    // Decide as próximas operações do stream e prepara a escrita, se houver uma
+    Actions nextLocked();
+    // Coloca data em response_, comprimido se a chamada pediu e o conteúdo parecer compressível
+    void encodeContent(const char* data, size_t size);
+    void perform(const Actions& actions);
+
+    JobExecutor& executor_;
+    size_t chunk_size_;
+    size_t parallelism_;
+    size_t max_job_input_;
+    MethodMetrics* metrics_;
+    RunJob run_;
+    WireCompression compression_ = WireCompression::None;
+    int zstd_level_ = kDefaultZstdLevel;
+    std::function<void()> on_done_;
+    std::unique_ptr<CallTrace> trace_;
+    Clock::time_point created_at_;
+
+    file_processor::BatchRequest request_;
+    file_processor::BatchResponse response_;
+    grpc::WriteOptions write_options_; // da escrita preparada em response_
+
+    std::mutex mutex_;
+    std::unordered_map<uint64_t, OpenJob> open_;
+    std::unordered_set<uint64_t> busy_; // jobs processando ou com resultado ainda não enviado
+    std::deque<Output> outputs_;
+    size_t running_ = 0;
+    bool started_ = false;
+    bool read_pending_ = false;
+    bool write_pending_ = false;
+    bool input_done_ = false;
+    bool failed_ = false;
+    bool finished_ = false;
+    grpc::Status failure_;
+
+    size_t received_ = 0;
+    size_t sent_ = 0;
+    size_t jobs_ = 0;
+    size_t failed_jobs_ = 0;
+    int status_code_ = static_cast<int>(grpc::StatusCode::UNKNOWN);
+    std::string status_message_;
+};
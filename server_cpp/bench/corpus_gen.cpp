@@ -0,0 +1,530 @@
+// Gerador de corpus sintético para os benchmarks: PDFs com N páginas de texto e/ou imagens
+// embutidas e imagens PNG/JPEG/WebP com megapixels e entropia escolhidos. A saída depende
+// só da semente (e da versão das bibliotecas de codificação): a mesma linha de comando gera
+// os mesmos bytes em qualquer máquina. Grava também um manifest.json com o que foi gerado,
+// lido pelo loadgen (--manifest).
+//
+// Uso: ./corpus_gen --out=DIR [--seed=N] [--pdf=PÁGINAS:TIPO[:QTD]]... [--image=FMT:MP:ENTROPIA[:QTD]]...
+// Sem --pdf nem --image, gera o corpus padrão (ver defaultSpecs).
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <sys/stat.h>
+
+#include "content_hash.h"
+#include "image_codec.h"
+
+namespace {
+
+// Incrementar quando uma mudança no gerador alterar os bytes produzidos
+const int kGeneratorVersion = 1;
+
+enum class PdfContent { Text, Image, Mixed };
+enum class Entropy { Low, Medium, High };
+
+struct PdfSpec {
+    int pages = 1;
+    PdfContent content = PdfContent::Text;
+    int count = 1;
+};
+
+struct ImageSpec {
+    ImageFormat format = ImageFormat::Jpeg;
+    double megapixels = 1;
+    Entropy entropy = Entropy::Medium;
+    int count = 1;
+};
+
+struct Options {
+    std::string out;
+    uint64_t seed = 1;
+    int dpi = 150; // resolução das imagens embutidas nos PDFs
+    std::vector<PdfSpec> pdfs;
+    std::vector<ImageSpec> images;
+};
+
+const char* contentName(PdfContent content) {
+    switch (content) {
+        case PdfContent::Text: return "text";
+        case PdfContent::Image: return "image";
+        case PdfContent::Mixed: return "mixed";
+    }
+    return "?";
+}
+
+const char* entropyName(Entropy entropy) {
+    switch (entropy) {
+        case Entropy::Low: return "low";
+        case Entropy::Medium: return "medium";
+        case Entropy::High: return "high";
+    }
+    return "?";
+}
+
+const char* formatName(ImageFormat format) {
+    switch (format) {
+        case ImageFormat::Jpeg: return "jpeg";
+        case ImageFormat::Png: return "png";
+        case ImageFormat::Webp: return "webp";
+        default: return "?";
+    }
+}
+
+const char* formatExtension(ImageFormat format) { return format == ImageFormat::Jpeg ? "jpg" : formatName(format); }
+
+// --- Sementes ---
+
+// Cada arquivo tem a própria semente, derivada da semente do corpus e do nome do arquivo:
+// acrescentar ou remover especificações não muda os demais arquivos
+uint64_t splitmix64(uint64_t value) {
+    value += 0x9e3779b97f4a7c15ull;
+    value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ull;
+    value = (value ^ (value >> 27)) * 0x94d049bb133111ebull;
+    return value ^ (value >> 31);
+}
+
+uint64_t fileSeed(uint64_t corpus_seed, const std::string& name) {
+    uint64_t hash = 0xcbf29ce484222325ull; // FNV-1a
+    for (unsigned char c : name) hash = (hash ^ c) * 0x100000001b3ull;
+    return splitmix64(corpus_seed ^ hash);
+}
+
+// std::uniform_int_distribution não tem saída fixada pelo padrão; os sorteios usam só o
+// mt19937_64, que tem, para que o corpus seja o mesmo com qualquer biblioteca padrão
+uint32_t below(std::mt19937_64& random, uint32_t limit) { return static_cast<uint32_t>(random() % limit); }
+
+// --- Imagens ---
+
+// Conteúdo conforme a entropia: gradientes e formas lisas (low), o mesmo com ruído leve,
+// parecido com uma foto (medium), ou ruído uniforme, praticamente incompressível (high)
+Image makeImage(int width, int height, Entropy entropy, std::mt19937_64& random) {
+    Image image;
+    image.width = width;
+    image.height = height;
+    image.channels = 3;
+    image.pixels.resize(image.stride() * height);
+
+    if (entropy == Entropy::High) {
+        for (size_t i = 0; i < image.pixels.size(); i += 8) {
+            uint64_t value = random();
+            for (size_t j = 0; j < 8 && i + j < image.pixels.size(); ++j) image.pixels[i + j] = static_cast<uint8_t>(value >> (8 * j));
+        }
+        return image;
+    }
+
+    // Fundo em gradiente com cores sorteadas nos quatro cantos
+    uint8_t corners[4][3];
+    for (auto& corner : corners) {
+        for (auto& channel : corner) channel = static_cast<uint8_t>(below(random, 256));
+    }
+    for (int y = 0; y < height; ++y) {
+        double fy = height > 1 ? static_cast<double>(y) / (height - 1) : 0;
+        uint8_t* row = &image.pixels[y * image.stride()];
+        for (int x = 0; x < width; ++x) {
+            double fx = width > 1 ? static_cast<double>(x) / (width - 1) : 0;
+            for (int c = 0; c < 3; ++c) {
+                double top = corners[0][c] * (1 - fx) + corners[1][c] * fx;
+                double bottom = corners[2][c] * (1 - fx) + corners[3][c] * fx;
+                row[x * 3 + c] = static_cast<uint8_t>(top * (1 - fy) + bottom * fy);
+            }
+        }
+    }
+
+    // Retângulos e círculos de cor sólida, para que haja bordas
+    int shapes = 8 + static_cast<int>(below(random, 16));
+    for (int s = 0; s < shapes; ++s) {
+        int cx = static_cast<int>(below(random, static_cast<uint32_t>(width)));
+        int cy = static_cast<int>(below(random, static_cast<uint32_t>(height)));
+        int radius = 1 + static_cast<int>(below(random, static_cast<uint32_t>(std::max(2, std::min(width, height) / 4))));
+        bool circle = below(random, 2) == 0;
+        uint8_t color[3];
+        for (auto& channel : color) channel = static_cast<uint8_t>(below(random, 256));
+        for (int y = std::max(0, cy - radius); y < std::min(height, cy + radius); ++y) {
+            for (int x = std::max(0, cx - radius); x < std::min(width, cx + radius); ++x) {
+                if (circle && (x - cx) * (x - cx) + (y - cy) * (y - cy) > radius * radius) continue;
+                uint8_t* pixel = &image.pixels[y * image.stride() + x * 3];
+                for (int c = 0; c < 3; ++c) pixel[c] = color[c];
+            }
+        }
+    }
+
+    if (entropy == Entropy::Medium) {
+        // Ruído de ±12 níveis em cada canal
+        for (size_t i = 0; i < image.pixels.size(); i += 8) {
+            uint64_t value = random();
+            for (size_t j = 0; j < 8 && i + j < image.pixels.size(); ++j) {
+                int noisy = image.pixels[i + j] + static_cast<int>((value >> (8 * j)) % 25) - 12;
+                image.pixels[i + j] = static_cast<uint8_t>(std::min(255, std::max(0, noisy)));
+            }
+        }
+    }
+    return image;
+}
+
+// Dimensões em 4:3 com aproximadamente o número de megapixels pedido
+void dimensionsFor(double megapixels, int& width, int& height) {
+    width = std::max(1, static_cast<int>(std::lround(std::sqrt(megapixels * 1e6 * 4 / 3))));
+    height = std::max(1, static_cast<int>(std::lround(width * 3.0 / 4)));
+}
+
+// --- PDF ---
+
+const char* const kWords[] = {
+    "arquivo", "processamento", "servidor", "cliente", "imagem", "documento", "página", "texto",
+    "compressão", "conversão", "resolução", "formato", "dados", "rede", "chamada", "resultado",
+    "tempo", "latência", "fila", "memória", "disco", "processo", "registro", "entrada", "saída",
+    "de", "da", "do", "em", "para", "com", "que", "uma", "um", "os", "as", "por", "se", "no", "na",
+    "o", "a", "e", "é", "mais", "cada", "sobre", "entre", "quando", "sem", "todo", "parte", "valor",
+};
+const size_t kWordCount = sizeof(kWords) / sizeof(kWords[0]);
+
+// Área útil da página A4 (em pontos) e tipografia das páginas de texto
+const int kPageWidth = 595;
+const int kPageHeight = 842;
+const int kMargin = 50;
+const int kFontSize = 10;
+const int kLeading = 12;
+const size_t kLineChars = 95;
+
+// Texto em WinAnsiEncoding (Latin-1 para os caracteres usados aqui), escapado para uma string PDF
+std::string pdfString(const std::string& utf8) {
+    std::string out = "(";
+    for (size_t i = 0; i < utf8.size(); ++i) {
+        unsigned char c = static_cast<unsigned char>(utf8[i]);
+        if (c == 0xC3 && i + 1 < utf8.size()) {
+            c = static_cast<unsigned char>(0xC0 + (static_cast<unsigned char>(utf8[++i]) & 0x3F));
+        }
+        if (c == '(' || c == ')' || c == '\\') out += '\\';
+        out += static_cast<char>(c);
+    }
+    return out + ")";
+}
+
+std::string textLine(std::mt19937_64& random) {
+    std::string line;
+    while (true) {
+        const char* word = kWords[below(random, kWordCount)];
+        if (line.size() + 1 + std::char_traits<char>::length(word) > kLineChars) break;
+        if (!line.empty()) line += ' ';
+        line += word;
+    }
+    return line;
+}
+
+// Monta o arquivo a partir dos objetos (numerados a partir de 1) e calcula a tabela xref
+class PdfWriter {
+public:
+    int reserve() {
+        objects_.emplace_back();
+        return static_cast<int>(objects_.size());
+    }
+
+    void set(int number, std::string body) { objects_[number - 1] = std::move(body); }
+
+    static std::string stream(const std::string& dictionary, const std::string& data) {
+        return "<< " + dictionary + " /Length " + std::to_string(data.size()) + " >>\nstream\n" + data + "\nendstream";
+    }
+
+    std::string finish(int root) const {
+        std::string out = "%PDF-1.4\n%\xE2\xE3\xCF\xD3\n";
+        std::vector<size_t> offsets;
+        for (size_t i = 0; i < objects_.size(); ++i) {
+            offsets.push_back(out.size());
+            out += std::to_string(i + 1) + " 0 obj\n" + objects_[i] + "\nendobj\n";
+        }
+        size_t xref = out.size();
+        out += "xref\n0 " + std::to_string(objects_.size() + 1) + "\n0000000000 65535 f \n";
+        for (size_t offset : offsets) {
+            char entry[24];
+            std::snprintf(entry, sizeof(entry), "%010zu 00000 n \n", offset);
+            out += entry;
+        }
+        out += "trailer\n<< /Size " + std::to_string(objects_.size() + 1) + " /Root " + std::to_string(root) +
+               " 0 R >>\nstartxref\n" + std::to_string(xref) + "\n%%EOF\n";
+        return out;
+    }
+
+private:
+    std::vector<std::string> objects_;
+};
+
+bool makePdf(const PdfSpec& spec, int dpi, std::mt19937_64& random, std::string& pdf, std::string& error) {
+    PdfWriter writer;
+    int catalog = writer.reserve();
+    int pages = writer.reserve();
+    int font = writer.reserve();
+    writer.set(catalog, "<< /Type /Catalog /Pages " + std::to_string(pages) + " 0 R >>");
+    writer.set(font, "<< /Type /Font /Subtype /Type1 /BaseFont /Helvetica /Encoding /WinAnsiEncoding >>");
+
+    std::string kids;
+    for (int page = 0; page < spec.pages; ++page) {
+        bool image_page = spec.content == PdfContent::Image || (spec.content == PdfContent::Mixed && page % 2 == 1);
+        int page_object = writer.reserve();
+        int contents = writer.reserve();
+        std::string resources = "/Font << /F1 " + std::to_string(font) + " 0 R >>";
+        std::string content;
+
+        if (image_page) {
+            // Figura ocupando a área útil, com uma legenda para que o ConvertToTXT encontre texto
+            int box_width = kPageWidth - 2 * kMargin;
+            int box_height = kPageHeight - 2 * kMargin - 3 * kLeading;
+            int width = box_width * dpi / 72;
+            int height = box_height * dpi / 72;
+            std::string jpeg;
+            Image image = makeImage(width, height, Entropy::Medium, random);
+            if (encodeImage(image, ImageFormat::Jpeg, jpeg, error) != ImageResult::Ok) return false;
+            int xobject = writer.reserve();
+            writer.set(xobject, PdfWriter::stream("/Type /XObject /Subtype /Image /Width " + std::to_string(width) +
+                                                      " /Height " + std::to_string(height) +
+                                                      " /ColorSpace /DeviceRGB /BitsPerComponent 8 /Filter /DCTDecode",
+                                                  jpeg));
+            resources += " /XObject << /Im1 " + std::to_string(xobject) + " 0 R >>";
+            content = "q " + std::to_string(box_width) + " 0 0 " + std::to_string(box_height) + " " +
+                      std::to_string(kMargin) + " " + std::to_string(kMargin + 3 * kLeading) + " cm /Im1 Do Q\n";
+            content += "BT /F1 " + std::to_string(kFontSize) + " Tf " + std::to_string(kMargin) + " " +
+                       std::to_string(kMargin + kLeading) + " Td " + pdfString("Figura " + std::to_string(page + 1) + ": " + textLine(random)) +
+                       " Tj ET\n";
+        } else {
+            int lines = (kPageHeight - 2 * kMargin) / kLeading;
+            content = "BT /F1 " + std::to_string(kFontSize) + " Tf " + std::to_string(kLeading) + " TL " +
+                      std::to_string(kMargin) + " " + std::to_string(kPageHeight - kMargin) + " Td\n";
+            for (int line = 0; line < lines; ++line) content += pdfString(textLine(random)) + " Tj T*\n";
+            content += "ET\n";
+        }
+
+        writer.set(contents, PdfWriter::stream("", content));
+        writer.set(page_object, "<< /Type /Page /Parent " + std::to_string(pages) + " 0 R /MediaBox [0 0 " +
+                                    std::to_string(kPageWidth) + " " + std::to_string(kPageHeight) + "] /Resources << " +
+                                    resources + " >> /Contents " + std::to_string(contents) + " 0 R >>");
+        kids += (kids.empty() ? "" : " ") + std::to_string(page_object) + " 0 R";
+    }
+    writer.set(pages, "<< /Type /Pages /Kids [" + kids + "] /Count " + std::to_string(spec.pages) + " >>");
+    pdf = writer.finish(catalog);
+    return true;
+}
+
+// --- Opções ---
+
+std::vector<std::string> split(const std::string& text, char separator) {
+    std::vector<std::string> parts;
+    std::stringstream stream(text);
+    std::string part;
+    while (std::getline(stream, part, separator)) parts.push_back(part);
+    return parts;
+}
+
+bool parsePositive(const std::string& text, int& out) {
+    char* end = nullptr;
+    long value = std::strtol(text.c_str(), &end, 10);
+    if (text.empty() || *end != '\0' || value <= 0 || value > 100000) return false;
+    out = static_cast<int>(value);
+    return true;
+}
+
+// "PÁGINAS:TIPO[:QTD]", ex.: "10:text", "4:image:3"
+bool parsePdfSpec(const std::string& text, PdfSpec& spec) {
+    std::vector<std::string> parts = split(text, ':');
+    if (parts.size() < 2 || parts.size() > 3 || !parsePositive(parts[0], spec.pages)) return false;
+    if (parts[1] == "text") {
+        spec.content = PdfContent::Text;
+    } else if (parts[1] == "image") {
+        spec.content = PdfContent::Image;
+    } else if (parts[1] == "mixed") {
+        spec.content = PdfContent::Mixed;
+    } else {
+        return false;
+    }
+    return parts.size() < 3 || parsePositive(parts[2], spec.count);
+}
+
+// "FMT:MEGAPIXELS:ENTROPIA[:QTD]", ex.: "jpeg:2:high", "png:0.3:low:5"
+bool parseImageSpec(const std::string& text, ImageSpec& spec) {
+    std::vector<std::string> parts = split(text, ':');
+    if (parts.size() < 3 || parts.size() > 4) return false;
+    spec.format = imageFormatFromName(parts[0]);
+    if (spec.format == ImageFormat::Unknown) return false;
+    char* end = nullptr;
+    spec.megapixels = std::strtod(parts[1].c_str(), &end);
+    if (parts[1].empty() || *end != '\0' || !(spec.megapixels > 0) || spec.megapixels > 200) return false;
+    if (parts[2] == "low") {
+        spec.entropy = Entropy::Low;
+    } else if (parts[2] == "medium") {
+        spec.entropy = Entropy::Medium;
+    } else if (parts[2] == "high") {
+        spec.entropy = Entropy::High;
+    } else {
+        return false;
+    }
+    return parts.size() < 4 || parsePositive(parts[3], spec.count);
+}
+
+// Corpus padrão: PDFs pequenos a médios de cada tipo e, para cada formato disponível,
+// imagens de 0,3/2/8 MP com entropia média e de 2 MP com entropia baixa e alta
+void defaultSpecs(Options& options) {
+    options.pdfs = {{1, PdfContent::Text, 1}, {10, PdfContent::Text, 1}, {50, PdfContent::Text, 1},
+                    {4, PdfContent::Image, 1}, {20, PdfContent::Mixed, 1}};
+    for (ImageFormat format : {ImageFormat::Jpeg, ImageFormat::Png, ImageFormat::Webp}) {
+        if (!imageFormatAvailable(format)) continue;
+        for (double megapixels : {0.3, 2.0, 8.0}) options.images.push_back({format, megapixels, Entropy::Medium, 1});
+        options.images.push_back({format, 2.0, Entropy::Low, 1});
+        options.images.push_back({format, 2.0, Entropy::High, 1});
+    }
+}
+
+std::string usage(const std::string& program) {
+    return "Uso: " + program + " --out=DIR [opções]\n"
+           "  --seed=N                    Semente do corpus (padrão 1)\n"
+           "  --pdf=PÁGINAS:TIPO[:QTD]    PDF com páginas de texto, image ou mixed (alternadas)\n"
+           "  --image=FMT:MP:ENTROPIA[:QTD]  Imagem jpeg, png ou webp com MP megapixels e entropia low, medium ou high\n"
+           "  --dpi=N                     Resolução das imagens embutidas nos PDFs (padrão 150)\n"
+           "Sem --pdf nem --image, gera o corpus padrão.\n";
+}
+
+bool parseOptions(int argc, char** argv, Options& options, std::string& error) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        size_t eq = arg.find('=');
+        std::string name = arg.substr(0, eq);
+        std::string value = eq == std::string::npos ? "" : arg.substr(eq + 1);
+
+        bool valid = true;
+        if (name == "--out") {
+            valid = !value.empty();
+            options.out = value;
+        } else if (name == "--seed") {
+            char* end = nullptr;
+            options.seed = std::strtoull(value.c_str(), &end, 10);
+            valid = !value.empty() && *end == '\0';
+        } else if (name == "--dpi") {
+            valid = parsePositive(value, options.dpi) && options.dpi <= 600;
+        } else if (name == "--pdf") {
+            PdfSpec spec;
+            valid = parsePdfSpec(value, spec);
+            options.pdfs.push_back(spec);
+        } else if (name == "--image") {
+            ImageSpec spec;
+            valid = parseImageSpec(value, spec);
+            if (valid && !imageFormatAvailable(spec.format)) {
+                error = "Formato não habilitado nesta compilação: " + value;
+                return false;
+            }
+            options.images.push_back(spec);
+        } else {
+            valid = false;
+        }
+        if (!valid) {
+            error = "Opção inválida: " + arg;
+            return false;
+        }
+    }
+    if (options.out.empty()) {
+        error = "Informe o diretório de saída (--out).";
+        return false;
+    }
+    if (options.pdfs.empty() && options.images.empty()) defaultSpecs(options);
+    return true;
+}
+
+// --- Saída ---
+
+std::string formatMegapixels(double megapixels) {
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%g", megapixels);
+    return buffer;
+}
+
+bool makeDirectory(const std::string& path) { return mkdir(path.c_str(), 0755) == 0 || errno == EEXIST; }
+
+bool writeFile(const std::string& path, const std::string& data) {
+    std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+    stream.write(data.data(), static_cast<std::streamsize>(data.size()));
+    return stream.good();
+}
+
+std::string sha256(const std::string& data) {
+    ContentHash hash;
+    hash.update(data);
+    return hash.finish();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    std::string error;
+    if (!parseOptions(argc, argv, options, error)) {
+        std::cerr << error << std::endl << usage(argv[0]);
+        return 1;
+    }
+    if (!makeDirectory(options.out) || !makeDirectory(options.out + "/pdf") || !makeDirectory(options.out + "/image")) {
+        std::cerr << "Não foi possível criar " << options.out << std::endl;
+        return 1;
+    }
+
+    // Uma entrada por linha: o loadgen lê o manifesto sem um parser de JSON completo
+    std::vector<std::string> entries;
+    uint64_t total_bytes = 0;
+
+    for (const auto& spec : options.pdfs) {
+        for (int index = 0; index < spec.count; ++index) {
+            char name[96];
+            std::snprintf(name, sizeof(name), "pdf/%s-%dp-%02d.pdf", contentName(spec.content), spec.pages, index);
+            std::mt19937_64 random(fileSeed(options.seed, name));
+            std::string pdf;
+            if (!makePdf(spec, options.dpi, random, pdf, error) || !writeFile(options.out + "/" + name, pdf)) {
+                std::cerr << "Falha ao gerar " << name << ": " << error << std::endl;
+                return 1;
+            }
+            total_bytes += pdf.size();
+            entries.push_back(std::string("{\"path\":\"") + name + "\",\"kind\":\"pdf\",\"content\":\"" + contentName(spec.content) +
+                              "\",\"pages\":" + std::to_string(spec.pages) + ",\"bytes\":" + std::to_string(pdf.size()) +
+                              ",\"sha256\":\"" + sha256(pdf) + "\"}");
+            std::cerr << name << " (" << pdf.size() << " bytes)" << std::endl;
+        }
+    }
+
+    for (const auto& spec : options.images) {
+        int width = 0, height = 0;
+        dimensionsFor(spec.megapixels, width, height);
+        for (int index = 0; index < spec.count; ++index) {
+            char name[96];
+            std::snprintf(name, sizeof(name), "image/%s-%smp-%s-%02d.%s", formatName(spec.format),
+                          formatMegapixels(spec.megapixels).c_str(), entropyName(spec.entropy), index, formatExtension(spec.format));
+            std::mt19937_64 random(fileSeed(options.seed, name));
+            std::string encoded;
+            Image image = makeImage(width, height, spec.entropy, random);
+            if (encodeImage(image, spec.format, encoded, error) != ImageResult::Ok || !writeFile(options.out + "/" + name, encoded)) {
+                std::cerr << "Falha ao gerar " << name << ": " << error << std::endl;
+                return 1;
+            }
+            total_bytes += encoded.size();
+            entries.push_back(std::string("{\"path\":\"") + name + "\",\"kind\":\"image\",\"format\":\"" + formatName(spec.format) +
+                              "\",\"width\":" + std::to_string(width) + ",\"height\":" + std::to_string(height) +
+                              ",\"entropy\":\"" + entropyName(spec.entropy) + "\",\"bytes\":" + std::to_string(encoded.size()) +
+                              ",\"sha256\":\"" + sha256(encoded) + "\"}");
+            std::cerr << name << " (" << encoded.size() << " bytes)" << std::endl;
+        }
+    }
+
+    std::string manifest = "{\"generator\":\"corpus_gen\",\"version\":" + std::to_string(kGeneratorVersion) +
+                           ",\"seed\":" + std::to_string(options.seed) + ",\"dpi\":" + std::to_string(options.dpi) + ",\"files\":[\n";
+    for (size_t i = 0; i < entries.size(); ++i) manifest += entries[i] + (i + 1 < entries.size() ? ",\n" : "\n");
+    manifest += "]}\n";
+    if (!writeFile(options.out + "/manifest.json", manifest)) {
+        std::cerr << "Falha ao gravar o manifesto." << std::endl;
+        return 1;
+    }
+    std::cerr << entries.size() << " arquivos, " << total_bytes << " bytes em " << options.out << std::endl;
+    return 0;
+}
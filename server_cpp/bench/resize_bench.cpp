@@ -0,0 +1,176 @@
+// Microbenchmark do redimensionamento: kernels (scalar/SSE4.1/AVX2) e filtros do motor
+// interno, o pipeline completo (decodificar, redimensionar, codificar) comparado ao convert e a
+// geração de vários tamanhos de uma vez comparada a uma chamada por tamanho.
+//
+// Uso: ./resize_bench [--benchmark_filter=...]
+
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "image_codec.h"
+#include "image_engine.h"
+#include "image_resize.h"
+#include "process_supervisor.h"
+
+namespace {
+
+// Origem e destino de cada cenário: miniatura, redução grande de foto de 12 MP, ampliação e
+// miniatura de foto de 24 MP (no pipeline, a maior parte da redução acontece na decodificação)
+const std::vector<std::vector<int64_t>> kSizes = {
+    {640, 480, 320, 240},
+    {1920, 1080, 256, 256},
+    {4000, 3000, 1024, 768},
+    {1024, 768, 2048, 1536},
+    {6000, 4000, 256, 256},
+};
+
+// Imagem sintética com gradientes e ruído, para que o JPEG tenha conteúdo realista
+Image makeImage(int width, int height, int channels) {
+    Image image;
+    image.width = width;
+    image.height = height;
+    image.channels = channels;
+    image.pixels.resize(image.stride() * height);
+    std::mt19937 rng(42);
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            uint8_t* pixel = &image.pixels[y * image.stride() + x * channels];
+            for (int c = 0; c < channels; ++c) {
+                pixel[c] = static_cast<uint8_t>((x * (c + 1) / 4 + y / 3 + rng() % 16) & 0xFF);
+            }
+        }
+    }
+    return image;
+}
+
+std::string makeJpeg(int width, int height) {
+    std::string jpeg, error;
+    encodeImage(makeImage(width, height, 3), ImageFormat::Jpeg, jpeg, error);
+    return jpeg;
+}
+
+void applySizes(benchmark::internal::Benchmark* benchmark) {
+    for (const auto& size : kSizes) benchmark->Args(size);
+    benchmark->Unit(benchmark::kMillisecond);
+}
+
+void setSizeLabel(benchmark::State& state) {
+    state.SetLabel(std::to_string(state.range(0)) + "x" + std::to_string(state.range(1)) + " -> " +
+                   std::to_string(state.range(2)) + "x" + std::to_string(state.range(3)));
+}
+
+template <ResizeKernel Kernel, ResizeFilter Filter>
+void BM_ResizeKernel(benchmark::State& state) {
+    Image source = makeImage(static_cast<int>(state.range(0)), static_cast<int>(state.range(1)), 3);
+    ResizeOptions options;
+    options.kernel = Kernel;
+    options.filter = Filter;
+    for (auto _ : state) {
+        Image resized;
+        resizeImage(source, static_cast<int>(state.range(2)), static_cast<int>(state.range(3)), resized, options);
+        benchmark::DoNotOptimize(resized.pixels.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0) * state.range(1));
+    setSizeLabel(state);
+}
+
+void BM_NativePipeline(benchmark::State& state) {
+    std::string input = makeJpeg(static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+    ImageOperation operation;
+    operation.width = static_cast<int>(state.range(2));
+    operation.height = static_cast<int>(state.range(3));
+    for (auto _ : state) {
+        std::string output, error;
+        runNativeImage(input, operation, output, error);
+        benchmark::DoNotOptimize(output.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0) * state.range(1));
+    setSizeLabel(state);
+}
+
+// Tamanhos de miniaturas gerados a partir de uma foto de 12 MP
+const std::vector<std::pair<int, int>> kOutputSizes = {{1920, 1440}, {1024, 768}, {512, 384}, {256, 192}, {128, 96}};
+
+std::vector<ImageOperation> outputOperations() {
+    std::vector<ImageOperation> operations;
+    for (const auto& size : kOutputSizes) {
+        ImageOperation operation;
+        operation.width = size.first;
+        operation.height = size.second;
+        operations.push_back(operation);
+    }
+    return operations;
+}
+
+// ResizeImage com vários tamanhos: uma decodificação, cada tamanho a partir do anterior
+void BM_NativeOutputs(benchmark::State& state) {
+    std::string input = makeJpeg(4000, 3000);
+    std::vector<ImageOperation> operations = outputOperations();
+    for (auto _ : state) {
+        std::string error;
+        runNativeImageOutputs(input, operations, [](size_t, const std::string& data) {
+            benchmark::DoNotOptimize(data.data());
+            return true;
+        }, error);
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(operations.size()));
+}
+
+// Os mesmos tamanhos com uma chamada (e uma decodificação) por tamanho
+void BM_NativeOutputsSeparate(benchmark::State& state) {
+    std::string input = makeJpeg(4000, 3000);
+    std::vector<ImageOperation> operations = outputOperations();
+    for (auto _ : state) {
+        for (const auto& operation : operations) {
+            std::string output, error;
+            runNativeImage(input, operation, output, error);
+            benchmark::DoNotOptimize(output.data());
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(operations.size()));
+}
+
+// Caminho atual do ResizeImage com --image-engine=convert: arquivo temporário + processo convert
+void BM_ConvertPipeline(benchmark::State& state) {
+    const std::string input_path = "/tmp/resize_bench_input.jpg";
+    const std::string output_path = "/tmp/resize_bench_output.jpg";
+    std::ofstream(input_path, std::ios::binary) << makeJpeg(static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+    const std::string geometry = std::to_string(state.range(2)) + "x" + std::to_string(state.range(3)) + "!";
+    const std::vector<std::string> argv = {"convert", input_path, "-resize", geometry, output_path};
+
+    for (auto _ : state) {
+        ProcessResult result = ProcessSupervisor::instance().spawn(argv).get();
+        if (!result.ok()) {
+            state.SkipWithError("convert indisponível ou falhou");
+            break;
+        }
+    }
+    std::remove(input_path.c_str());
+    std::remove(output_path.c_str());
+    state.SetItemsProcessed(state.iterations() * state.range(0) * state.range(1));
+    setSizeLabel(state);
+}
+
+} // namespace
+
+BENCHMARK_TEMPLATE(BM_ResizeKernel, ResizeKernel::Scalar, ResizeFilter::Box)->Apply(applySizes);
+BENCHMARK_TEMPLATE(BM_ResizeKernel, ResizeKernel::Sse41, ResizeFilter::Box)->Apply(applySizes);
+BENCHMARK_TEMPLATE(BM_ResizeKernel, ResizeKernel::Avx2, ResizeFilter::Box)->Apply(applySizes);
+BENCHMARK_TEMPLATE(BM_ResizeKernel, ResizeKernel::Scalar, ResizeFilter::Bilinear)->Apply(applySizes);
+BENCHMARK_TEMPLATE(BM_ResizeKernel, ResizeKernel::Sse41, ResizeFilter::Bilinear)->Apply(applySizes);
+BENCHMARK_TEMPLATE(BM_ResizeKernel, ResizeKernel::Avx2, ResizeFilter::Bilinear)->Apply(applySizes);
+BENCHMARK_TEMPLATE(BM_ResizeKernel, ResizeKernel::Scalar, ResizeFilter::Lanczos3)->Apply(applySizes);
+BENCHMARK_TEMPLATE(BM_ResizeKernel, ResizeKernel::Sse41, ResizeFilter::Lanczos3)->Apply(applySizes);
+BENCHMARK_TEMPLATE(BM_ResizeKernel, ResizeKernel::Avx2, ResizeFilter::Lanczos3)->Apply(applySizes);
+BENCHMARK(BM_NativePipeline)->Apply(applySizes);
+BENCHMARK(BM_ConvertPipeline)->Apply(applySizes);
+BENCHMARK(BM_NativeOutputs)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_NativeOutputsSeparate)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,191 @@
+// Microbenchmarks das primitivas de E/S do servidor: gravação dos chunks recebidos, leitura do
+// resultado em chunks para envio, nomes de arquivos temporários, timestamps, montagem das
+// mensagens FileChunk e a amostragem que decide se um chunk é comprimido. Cada caso tem, ao lado, a versão original (ifstream com buffer de 4 KB
+// no envio) para servir de referência antes e depois das mudanças de E/S.
+//
+// Uso: ./server_bench [--benchmark_filter=...]
+
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "file_io.h"
+#include "file_processor.pb.h"
+#include "input_sink.h"
+#include "logging.h"
+#include "wire_compression.h"
+
+using file_processor::FileChunk;
+
+namespace {
+
+// Tamanho das entradas e saídas simuladas
+const size_t kPayloadSize = 16 * 1024 * 1024;
+
+// Tamanhos de chunk/buffer: o de 4 KB do envio original até o de 1 MB do cliente
+void applyChunkSizes(benchmark::internal::Benchmark* benchmark) {
+    for (int64_t size : {4 * 1024, 16 * 1024, 64 * 1024, 256 * 1024, 1024 * 1024}) benchmark->Arg(size);
+}
+
+std::string makePayload(size_t size) {
+    std::string payload(size, '\0');
+    std::mt19937_64 rng(42);
+    for (size_t i = 0; i + 8 <= size; i += 8) {
+        uint64_t value = rng();
+        payload.replace(i, 8, reinterpret_cast<const char*>(&value), 8);
+    }
+    return payload;
+}
+
+// Chunks como chegam do cliente
+std::vector<FileChunk> makeChunks(size_t chunk_size) {
+    static const std::string payload = makePayload(kPayloadSize);
+    std::vector<FileChunk> chunks;
+    for (size_t offset = 0; offset < payload.size(); offset += chunk_size) {
+        chunks.emplace_back();
+        chunks.back().set_content(payload.data() + offset, std::min(chunk_size, payload.size() - offset));
+    }
+    return chunks;
+}
+
+// Arquivo de resultado já gravado, como o deixado pela ferramenta externa
+class OutputFile {
+public:
+    OutputFile() : path_(generateUniqueFilename("server_bench_output")) {
+        std::ofstream(path_, std::ios::binary) << makePayload(kPayloadSize);
+    }
+    ~OutputFile() { std::remove(path_.c_str()); }
+
+    const std::string& path() const { return path_; }
+
+private:
+    std::string path_;
+};
+
+// Laço de gravação do upload no spool (SpoolSink, sucessor do temp_file.write original)
+void BM_SpoolAppend(benchmark::State& state) {
+    std::vector<FileChunk> chunks = makeChunks(static_cast<size_t>(state.range(0)));
+    const std::string path = generateUniqueFilename("server_bench_spool");
+    for (auto _ : state) {
+        std::unique_ptr<InputSink> sink = openSpoolSink(path, []() { return 0; });
+        for (const auto& chunk : chunks) sink->write(chunk.content().data(), chunk.content().size());
+        if (sink->finish() != 0) state.SkipWithError("falha no spool");
+    }
+    std::remove(path.c_str());
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * kPayloadSize));
+}
+
+// O mesmo upload acumulado em memória (motores internos)
+void BM_MemoryAppend(benchmark::State& state) {
+    std::vector<FileChunk> chunks = makeChunks(static_cast<size_t>(state.range(0)));
+    for (auto _ : state) {
+        std::string buffer;
+        std::unique_ptr<InputSink> sink = openMemorySink(buffer);
+        for (const auto& chunk : chunks) sink->write(chunk.content().data(), chunk.content().size());
+        sink->finish();
+        benchmark::DoNotOptimize(buffer.data());
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * kPayloadSize));
+}
+
+// Envio de um resultado em disco como o TransferReactor faz: arquivo mapeado e um FileChunk
+// reaproveitado por escrita
+void BM_SendFileMapped(benchmark::State& state) {
+    OutputFile output;
+    const size_t chunk_size = static_cast<size_t>(state.range(0));
+    FileChunk chunk;
+    for (auto _ : state) {
+        MappedFile file;
+        if (!file.open(output.path())) {
+            state.SkipWithError("falha ao mapear o arquivo");
+            break;
+        }
+        for (size_t offset = 0; offset < file.size(); offset += chunk_size) {
+            chunk.set_content(file.data() + offset, std::min(chunk_size, file.size() - offset));
+            benchmark::DoNotOptimize(chunk.content().data());
+        }
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * kPayloadSize));
+}
+
+// sendFile original: ifstream lido em um buffer do tamanho do chunk, um FileChunk novo por leitura
+void BM_SendFileStream(benchmark::State& state) {
+    OutputFile output;
+    std::vector<char> buffer(static_cast<size_t>(state.range(0)));
+    for (auto _ : state) {
+        std::ifstream file(output.path(), std::ios::binary);
+        while (file.read(buffer.data(), static_cast<std::streamsize>(buffer.size())) || file.gcount() > 0) {
+            FileChunk chunk;
+            chunk.set_content(buffer.data(), static_cast<size_t>(file.gcount()));
+            benchmark::DoNotOptimize(chunk.content().data());
+        }
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * kPayloadSize));
+}
+
+// Um std::random_device (leitura do /dev/urandom ou RDRAND) por chamada
+void BM_GenerateUniqueFilename(benchmark::State& state) {
+    for (auto _ : state) {
+        std::string name = generateUniqueFilename("input_compress");
+        benchmark::DoNotOptimize(name.data());
+    }
+}
+
+void BM_GetCurrentTimestamp(benchmark::State& state) {
+    for (auto _ : state) {
+        std::string timestamp = getCurrentTimestamp();
+        benchmark::DoNotOptimize(timestamp.data());
+    }
+}
+
+// Montagem de um FileChunk novo (cópia do conteúdo) a cada chunk
+void BM_FileChunkBuild(benchmark::State& state) {
+    const std::string payload = makePayload(static_cast<size_t>(state.range(0)));
+    for (auto _ : state) {
+        FileChunk chunk;
+        chunk.set_content(payload);
+        benchmark::DoNotOptimize(chunk.content().data());
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * payload.size()));
+}
+
+// Montagem e serialização, como acontece a cada escrita no stream
+void BM_FileChunkSerialize(benchmark::State& state) {
+    const std::string payload = makePayload(static_cast<size_t>(state.range(0)));
+    FileChunk chunk;
+    std::string wire;
+    for (auto _ : state) {
+        chunk.set_content(payload);
+        chunk.SerializeToString(&wire);
+        benchmark::DoNotOptimize(wire.data());
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * payload.size()));
+}
+
+// Decisão de comprimir ou não um chunk da resposta (amostra de entropia), paga em toda escrita
+// das chamadas que pedem compressão
+void BM_LooksCompressible(benchmark::State& state) {
+    const std::string payload = makePayload(static_cast<size_t>(state.range(0)));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(looksCompressible(payload.data(), payload.size()));
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * payload.size()));
+}
+
+} // namespace
+
+BENCHMARK(BM_SpoolAppend)->Apply(applyChunkSizes)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_MemoryAppend)->Apply(applyChunkSizes)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_SendFileMapped)->Apply(applyChunkSizes)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_SendFileStream)->Apply(applyChunkSizes)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_GenerateUniqueFilename);
+BENCHMARK(BM_GetCurrentTimestamp);
+BENCHMARK(BM_FileChunkBuild)->Apply(applyChunkSizes);
+BENCHMARK(BM_FileChunkSerialize)->Apply(applyChunkSizes);
+BENCHMARK(BM_LooksCompressible)->Apply(applyChunkSizes);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,195 @@
+#include "config.h"
+
+#include <cstdlib>
+
+namespace {
+
+// Converte um inteiro não negativo, rejeitando sufixos e valores vazios
+bool parseCount(const std::string& value, size_t& out) {
+    if (value.empty() || value[0] == '-') return false;
+    char* end = nullptr;
+    unsigned long long parsed = std::strtoull(value.c_str(), &end, 10);
+    if (*end != '\0') return false;
+    out = static_cast<size_t>(parsed);
+    return true;
+}
+
+// Métodos do serviço que aceitam limites próprios
+bool isServiceMethod(const std::string& name) {
+    return name == "CompressPDF" || name == "ConvertToTXT" || name == "ConvertImageFormat" || name == "ResizeImage" ||
+           name == "ProcessBatch" || name == "RunPipeline";
+}
+
+// "N" define o limite padrão; "Metodo:N" só o do método
+bool parseMaxConcurrent(const std::string& value, ServerConfig& config) {
+    size_t colon = value.find(':');
+    if (colon == std::string::npos) return parseCount(value, config.admission.max_active);
+
+    std::string method = value.substr(0, colon);
+    size_t limit = 0;
+    if (!isServiceMethod(method) || !parseCount(value.substr(colon + 1), limit)) return false;
+    config.max_concurrent_by_method[method] = limit;
+    return true;
+}
+
+// Fração entre 0 e 1, ex.: "0.05"
+bool parseFraction(const std::string& value, double& out) {
+    if (value.empty()) return false;
+    char* end = nullptr;
+    double parsed = std::strtod(value.c_str(), &end);
+    if (*end != '\0' || !(parsed >= 0.0 && parsed <= 1.0)) return false;
+    out = parsed;
+    return true;
+}
+
+} // namespace
+
+AdmissionLimits ServerConfig::admissionFor(const std::string& method) const {
+    AdmissionLimits limits = admission;
+    auto it = max_concurrent_by_method.find(method);
+    if (it != max_concurrent_by_method.end()) limits.max_active = it->second;
+    return limits;
+}
+
+bool parseServerConfig(int argc, char** argv, ServerConfig& config, std::string& error) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        std::string name = arg;
+        std::string value;
+        bool has_value = false;
+
+        // Opções no formato --nome=valor
+        size_t eq = arg.find('=');
+        if (eq != std::string::npos) {
+            name = arg.substr(0, eq);
+            value = arg.substr(eq + 1);
+            has_value = true;
+        }
+
+        bool valid = true;
+        if (name == "--address") {
+            valid = has_value && !value.empty();
+            config.address = value;
+        } else if (name == "--workers") {
+            valid = parseCount(value, config.workers);
+        } else if (name == "--max-concurrent") {
+            valid = parseMaxConcurrent(value, config);
+        } else if (name == "--max-queue") {
+            valid = parseCount(value, config.admission.max_queued);
+        } else if (name == "--queue-timeout-ms") {
+            size_t timeout = 0;
+            valid = parseCount(value, timeout);
+            config.admission.queue_timeout = std::chrono::milliseconds(timeout);
+        } else if (name == "--cache-memory-mb") {
+            valid = parseCount(value, config.cache_memory_mb);
+        } else if (name == "--cache-dir") {
+            valid = has_value && !value.empty();
+            config.cache_dir = value;
+        } else if (name == "--cache-disk-mb") {
+            valid = parseCount(value, config.cache_disk_mb);
+        } else if (name == "--log-level") {
+            valid = parseLogLevel(value, config.log.level);
+        } else if (name == "--log-file") {
+            valid = has_value;
+            config.log.file = value;
+        } else if (name == "--log-queue") {
+            valid = parseCount(value, config.log.queue_size) && config.log.queue_size > 0;
+        } else if (name == "--quiet") {
+            valid = !has_value;
+            config.log.to_stdout = false;
+        } else if (name == "--metrics-address") {
+            valid = has_value;
+            config.metrics_address = value;
+        } else if (name == "--trace-file") {
+            valid = has_value;
+            config.trace.file = value;
+        } else if (name == "--trace-sample") {
+            valid = parseFraction(value, config.trace.sample_rate);
+        } else if (name == "--chunk-size") {
+            valid = parseCount(value, config.chunk_size) && config.chunk_size >= 1024 && config.chunk_size <= kMaxChunkSize;
+        } else if (name == "--upload-dir") {
+            valid = has_value;
+            config.upload_dir = value;
+        } else if (name == "--upload-ttl-s") {
+            valid = parseCount(value, config.upload_ttl_s) && config.upload_ttl_s > 0;
+        } else if (name == "--upload-max-mb") {
+            valid = parseCount(value, config.upload_max_mb);
+        } else if (name == "--zstd-level") {
+            size_t level = 0;
+            valid = parseCount(value, level) && level >= 1 && level <= 19;
+            config.zstd_level = static_cast<int>(level);
+        } else if (name == "--stream-input") {
+            valid = !has_value;
+            config.stream_input = true;
+        } else if (name == "--gs-pool-size") {
+            valid = parseCount(value, config.gs_pool_size);
+        } else if (name == "--gs-recycle-after") {
+            valid = parseCount(value, config.gs_recycle_after) && config.gs_recycle_after > 0;
+        } else if (name == "--pdf-split-pages") {
+            valid = parseCount(value, config.pdf_split_pages);
+        } else if (name == "--pdf-split-parallelism") {
+            valid = parseCount(value, config.pdf_split_parallelism);
+        } else if (name == "--batch-parallelism") {
+            valid = parseCount(value, config.batch_parallelism);
+        } else if (name == "--batch-max-job-mb") {
+            valid = parseCount(value, config.batch_max_job_mb) && config.batch_max_job_mb > 0;
+        } else if (name == "--image-engine") {
+            if (value == "convert") {
+                config.image_engine = ImageEngine::Convert;
+            } else if (value == "native") {
+                config.image_engine = ImageEngine::Native;
+            } else {
+                valid = false;
+            }
+        } else if (name == "--resize-filter") {
+            valid = parseResizeFilter(value, config.resize_filter);
+        } else if (name == "--image-max-megapixels") {
+            valid = parseCount(value, config.image_max_megapixels);
+        } else {
+            valid = false;
+        }
+
+        if (!valid) {
+            error = "Opção inválida: " + arg;
+            return false;
+        }
+    }
+    return true;
+}
+
+std::string serverUsage(const std::string& program) {
+    return "Uso: " + program + " [opções]\n"
+           "  --address=HOST:PORTA   Endereço de escuta (padrão 0.0.0.0:50051)\n"
+           "  --workers=N            Threads de processamento (padrão 0 = número de CPUs)\n"
+           "  --max-concurrent=N     Chamadas simultâneas por método (padrão 16, 0 = sem limite);\n"
+           "                         também aceita Metodo:N, ex.: --max-concurrent=CompressPDF:4\n"
+           "  --max-queue=N          Chamadas aguardando vaga por método (padrão 64)\n"
+           "  --queue-timeout-ms=N   Espera máxima por uma vaga antes de RESOURCE_EXHAUSTED (padrão 5000)\n"
+           "  --cache-memory-mb=N    Cache de resultados em memória (padrão 128, 0 = desativado)\n"
+           "  --cache-dir=DIR        Habilita o cache de resultados em disco neste diretório\n"
+           "  --cache-disk-mb=N      Tamanho máximo do cache em disco (padrão 1024)\n"
+           "  --log-level=NIVEL      debug, info (padrão), warning ou error\n"
+           "  --log-file=ARQUIVO     Arquivo de log (padrão server.log; vazio = só a saída padrão)\n"
+           "  --log-queue=N          Mensagens aguardando gravação antes de começar a descartar (padrão 8192)\n"
+           "  --quiet                Não repete o log na saída padrão\n"
+           "  --metrics-address=H:P  Endpoint /metrics do Prometheus (padrão 127.0.0.1:9464; vazio desativa)\n"
+           "  --trace-file=ARQUIVO   Grava rastros das chamadas (OTLP/JSON, uma linha por chamada) neste arquivo\n"
+           "  --trace-sample=F       Fração das chamadas rastreadas sem traceparent do cliente (padrão 0.01)\n"
+           "  --chunk-size=BYTES     Conteúdo máximo de cada chunk enviado (padrão 1048576, de 1024 a 4193280)\n"
+           "  --upload-dir=DIR       Sessões dos uploads retomáveis (padrão /tmp/file_processor_uploads; vazio desativa)\n"
+           "  --upload-ttl-s=N       Segundos que um upload interrompido é mantido para ser retomado (padrão 3600)\n"
+           "  --upload-max-mb=N      Espaço total das sessões de upload; descarta as paradas mais antigas (padrão 4096, 0 = sem limite)\n"
+           "  --zstd-level=N         Nível da compressão zstd das respostas pedida pelo cliente (padrão 3, de 1 a 19)\n"
+           "  --stream-input         Repassa o upload de imagens direto ao stdin da ferramenta\n"
+           "  --gs-pool-size=N       Instâncias residentes do Ghostscript para o CompressPDF (padrão 0 = gs externo)\n"
+           "  --gs-recycle-after=N   Jobs por instância do Ghostscript antes de reiniciá-la (padrão 200)\n"
+           "  --pdf-split-pages=N    Divide PDFs com N ou mais páginas em intervalos paralelos (padrão 0 = nunca).\n"
+           "                         O PDF comprimido vira a junção das partes (pdfunite): maior, sem sumário\n"
+           "                         nem links internos; cada chamada também passa a contar as páginas\n"
+           "  --pdf-split-parallelism=N  Intervalos de um PDF processados ao mesmo tempo (padrão 0 = número de threads)\n"
+           "  --batch-parallelism=N  Jobs em andamento por stream do ProcessBatch (padrão 0 = número de threads)\n"
+           "  --batch-max-job-mb=N   Entrada máxima de cada job do ProcessBatch (padrão 64)\n"
+           "  --image-engine=MOTOR   convert (padrão) ou native para ConvertImageFormat/ResizeImage\n"
+           "  --resize-filter=F      box, bilinear ou lanczos3 (padrão) no motor nativo\n"
+           "  --image-max-megapixels=N  Maior imagem decodificada pelo motor nativo (padrão 200, 0 = sem limite)\n";
+}
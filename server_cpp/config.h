@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstddef>
+#include <map>
+#include <string>
+
+#include "admission.h"
+#include "image_resize.h"
+#include "logging.h"
+#include "tracing.h"
+#include "wire_compression.h"
+
+// Implementação usada por ConvertImageFormat e ResizeImage
+enum class ImageEngine {
+    Convert, // ImageMagick (convert) sobre arquivos temporários
+    Native,  // libjpeg/libpng/libwebp dentro do processo, direto da memória
+};
+
+// Os clientes gRPC recusam por padrão mensagens maiores que 4 MB; a folga cobre o cabeçalho do FileChunk
+constexpr size_t kMaxChunkSize = 4 * 1024 * 1024 - 1024;
+
+// Opções de execução do servidor, lidas da linha de comando
+struct ServerConfig {
+    std::string address = "0.0.0.0:50051";
+
+    // Tamanho máximo do conteúdo de cada FileChunk enviado ao cliente (o mesmo 1 MB usado pelos clientes)
+    size_t chunk_size = 1024 * 1024;
+
+    // Threads do executor que roda as ferramentas e os motores internos (0 = número de CPUs).
+    // As conexões em si são atendidas pelas threads do gRPC, independentemente deste valor.
+    size_t workers = 0;
+
+    // Controle de admissão: limites padrão de cada método e, opcionalmente, chamadas
+    // simultâneas específicas por método (--max-concurrent=Metodo:N)
+    AdmissionLimits admission;
+    std::map<std::string, size_t> max_concurrent_by_method;
+
+    // Limites efetivos de method
+    AdmissionLimits admissionFor(const std::string& method) const;
+
+    // Cache de resultados: nível em memória (0 desativa) e, se cache_dir for informado, em disco
+    size_t cache_memory_mb = 128;
+    std::string cache_dir;
+    size_t cache_disk_mb = 1024;
+
+    // Nível mínimo, arquivo e tamanho da fila do log
+    LogOptions log;
+
+    // Endpoint HTTP com as métricas no formato do Prometheus (vazio desativa). O mesmo
+    // conteúdo fica disponível pelo RPC GetStats.
+    std::string metrics_address = "127.0.0.1:9464";
+
+    // Rastreamento das chamadas: arquivo de saída (vazio desativa) e fração amostrada
+    TraceOptions trace;
+
+    // Uploads retomáveis (metadado x-upload-id): diretório das sessões (vazio desativa), tempo
+    // que uma sessão interrompida é mantida à espera de ser retomada e espaço total das sessões
+    // (0 = sem limite; ao atingi-lo as sessões paradas mais antigas são descartadas)
+    std::string upload_dir = "/tmp/file_processor_uploads";
+    size_t upload_ttl_s = 3600;
+    size_t upload_max_mb = 4096;
+
+    // Nível dos frames zstd quando o cliente pede "zstd" em x-response-compression (1 a 19)
+    int zstd_level = kDefaultZstdLevel;
+
+    // Inicia a ferramenta assim que o primeiro chunk chega e repassa o restante pelo stdin.
+    // Entradas que exigem acesso aleatório (PDFs) continuam indo para um spool em disco.
+    bool stream_input = false;
+
+    // Instâncias residentes do Ghostscript (libgs) para o CompressPDF; 0 usa o gs de linha de comando
+    size_t gs_pool_size = 0;
+    // Jobs executados por instância antes de ela ser reiniciada
+    size_t gs_recycle_after = 200;
+
+    // PDFs com pelo menos pdf_split_pages páginas (0 = desativado, o padrão) são divididos em
+    // intervalos processados em paralelo pelo CompressPDF e pelo ConvertToTXT, em até
+    // pdf_split_parallelism intervalos (0 = número de threads do executor). Ligado, toda chamada
+    // conta as páginas antes (pdfinfo, sem a poppler-cpp) e o PDF comprimido passa a ser a junção
+    // (pdfunite) das partes: fontes e imagens repetidas em cada parte, sem sumário nem links.
+    size_t pdf_split_pages = 0;
+    size_t pdf_split_parallelism = 0;
+
+    // ProcessBatch: jobs de um mesmo stream processando ou aguardando envio ao mesmo tempo
+    // (0 = número de threads do executor) e tamanho máximo da entrada de cada job
+    size_t batch_parallelism = 0;
+    size_t batch_max_job_mb = 64;
+
+    // Formatos que o motor nativo não suporta continuam indo para o convert
+    ImageEngine image_engine = ImageEngine::Convert;
+    // Filtro de reamostragem do ResizeImage no motor nativo
+    ResizeFilter resize_filter = ResizeFilter::Lanczos3;
+    // Maior imagem que o motor nativo decodifica, em megapixels (0 = sem limite). As reduções
+    // contam pelo tamanho já reduzido na decodificação.
+    size_t image_max_megapixels = 200;
+};
+
+// Preenche a configuração a partir de argv. Retorna false (com a mensagem em error) se alguma opção for inválida.
+bool parseServerConfig(int argc, char** argv, ServerConfig& config, std::string& error);
+
+// Texto de ajuda com as opções aceitas
+std::string serverUsage(const std::string& program);
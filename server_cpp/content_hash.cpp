@@ -0,0 +1,30 @@
+#include "content_hash.h"
+
+#include <openssl/evp.h>
+
+ContentHash::ContentHash() : context_(EVP_MD_CTX_new()) {
+    EVP_DigestInit_ex(context_, EVP_sha256(), nullptr);
+}
+
+ContentHash::~ContentHash() {
+    EVP_MD_CTX_free(context_);
+}
+
+void ContentHash::update(const void* data, size_t size) {
+    EVP_DigestUpdate(context_, data, size);
+}
+
+std::string ContentHash::finish() {
+    static const char kHex[] = "0123456789abcdef";
+    unsigned char digest[EVP_MAX_MD_SIZE];
+    unsigned int length = 0;
+    EVP_DigestFinal_ex(context_, digest, &length);
+
+    std::string hex;
+    hex.reserve(length * 2);
+    for (unsigned int i = 0; i < length; ++i) {
+        hex += kHex[digest[i] >> 4];
+        hex += kHex[digest[i] & 0x0F];
+    }
+    return hex;
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+struct evp_md_ctx_st;
+
+// SHA-256 incremental (OpenSSL), alimentado conforme os chunks chegam.
+// Identifica o conteúdo de um upload sem precisar guardá-lo inteiro.
+class ContentHash {
+public:
+    ContentHash();
+    ~ContentHash();
+
+    void update(const void* data, size_t size);
+    void update(const std::string& text) { update(text.data(), text.size()); }
+
+    // Resumo em hexadecimal (64 caracteres). Depois disso o objeto não aceita mais dados.
+    std::string finish();
+
+    ContentHash(const ContentHash&) = delete;
+    ContentHash& operator=(const ContentHash&) = delete;
+
+private:
+    evp_md_ctx_st* context_;
+};
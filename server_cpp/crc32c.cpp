@@ -0,0 +1,72 @@
+#include "crc32c.h"
+
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+uint32_t crc32cSse42(uint32_t crc, const uint8_t* data, size_t size); // crc32c_sse42.cpp
+#endif
+
+namespace {
+
+// Polinômio de Castagnoli na forma refletida
+constexpr uint32_t kPolynomial = 0x82f63b78;
+
+// tables[k][b]: CRC do byte b seguido de k bytes zero, para processar 8 bytes por iteração
+struct Tables {
+    uint32_t values[8][256];
+
+    Tables() {
+        for (uint32_t b = 0; b < 256; ++b) {
+            uint32_t crc = b;
+            for (int bit = 0; bit < 8; ++bit) crc = (crc >> 1) ^ (kPolynomial & (0u - (crc & 1)));
+            values[0][b] = crc;
+        }
+        for (uint32_t b = 0; b < 256; ++b) {
+            for (int k = 1; k < 8; ++k) values[k][b] = (values[k - 1][b] >> 8) ^ values[0][values[k - 1][b] & 0xff];
+        }
+    }
+};
+
+uint32_t crc32cTable(uint32_t crc, const uint8_t* data, size_t size) {
+    static const Tables tables;
+    const auto& t = tables.values;
+    uint32_t state = ~crc;
+    for (; size >= 8; size -= 8, data += 8) {
+        uint32_t low, high;
+        std::memcpy(&low, data, sizeof(low));
+        std::memcpy(&high, data + 4, sizeof(high));
+        low ^= state;
+        state = t[7][low & 0xff] ^ t[6][(low >> 8) & 0xff] ^ t[5][(low >> 16) & 0xff] ^ t[4][low >> 24] ^
+                t[3][high & 0xff] ^ t[2][(high >> 8) & 0xff] ^ t[1][(high >> 16) & 0xff] ^ t[0][high >> 24];
+    }
+    for (; size > 0; --size, ++data) state = (state >> 8) ^ t[0][(state ^ *data) & 0xff];
+    return ~state;
+}
+
+using Crc32cFunction = uint32_t (*)(uint32_t, const uint8_t*, size_t);
+
+bool hasSse42() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __builtin_cpu_supports("sse4.2");
+#else
+    return false;
+#endif
+}
+
+Crc32cFunction detect() {
+#if defined(__x86_64__) || defined(__i386__)
+    if (hasSse42()) return crc32cSse42;
+#endif
+    return crc32cTable;
+}
+
+} // namespace
+
+uint32_t crc32c(uint32_t crc, const void* data, size_t size) {
+    static const Crc32cFunction function = detect();
+    return function(crc, static_cast<const uint8_t*>(data), size);
+}
+
+const char* crc32cImplementation() {
+    return hasSse42() ? "sse4.2" : "table";
+}
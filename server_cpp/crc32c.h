@@ -0,0 +1,13 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// CRC32C (Castagnoli), o checksum dos chunks dos uploads retomáveis. Usa a instrução crc32
+// do SSE4.2 quando a CPU suporta e uma tabela (slicing-by-8) nas demais.
+
+// Continua o CRC de crc (0 no início) sobre data: crc32c(crc32c(0, a), b) == crc32c(0, a + b)
+uint32_t crc32c(uint32_t crc, const void* data, size_t size);
+
+// Implementação escolhida para esta CPU ("sse4.2" ou "table")
+const char* crc32cImplementation();
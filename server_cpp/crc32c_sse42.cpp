@@ -0,0 +1,30 @@
+// CRC32C com a instrução crc32 do SSE4.2: compilado com -msse4.2 e usado apenas quando a CPU suporta
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+
+#include <nmmintrin.h>
+
+uint32_t crc32cSse42(uint32_t crc, const uint8_t* data, size_t size) {
+    uint32_t state = ~crc;
+#if defined(__x86_64__)
+    uint64_t wide = state;
+    for (; size >= 8; size -= 8, data += 8) {
+        uint64_t word;
+        std::memcpy(&word, data, sizeof(word));
+        wide = _mm_crc32_u64(wide, word);
+    }
+    state = static_cast<uint32_t>(wide);
+#endif
+    for (; size >= 4; size -= 4, data += 4) {
+        uint32_t word;
+        std::memcpy(&word, data, sizeof(word));
+        state = _mm_crc32_u32(state, word);
+    }
+    for (; size > 0; --size, ++data) state = _mm_crc32_u8(state, *data);
+    return ~state;
+}
+
+#endif
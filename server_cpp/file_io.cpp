@@ -0,0 +1,53 @@
+#include "file_io.h"
+
+#include <chrono>
+#include <random>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Função para gerar um nome de arquivo aleatório e único
+std::string generateUniqueFilename(const std::string& prefix) {
+    std::random_device rd;
+    std::mt19937 gen(rd());
+    std::uniform_int_distribution<> distrib(100000, 999999);
+    return "/tmp/" + prefix + "_" + std::to_string(std::chrono::system_clock::now().time_since_epoch().count()) + "_" + std::to_string(distrib(gen));
+}
+
+MappedFile::~MappedFile() {
+    if (data_) munmap(data_, size_);
+}
+
+bool MappedFile::open(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        close(fd);
+        return false;
+    }
+    size_t size = static_cast<size_t>(info.st_size);
+    if (size > 0) {
+        void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped == MAP_FAILED) {
+            close(fd);
+            return false;
+        }
+        madvise(mapped, size, MADV_SEQUENTIAL);
+        data_ = mapped;
+    }
+    close(fd);
+    size_ = size;
+    return true;
+}
+
+bool readFile(const std::string& path, std::string& data) {
+    MappedFile file;
+    if (!file.open(path)) return false;
+    data.assign(file.data() ? file.data() : "", file.size());
+    return true;
+}
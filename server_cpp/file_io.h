@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+// Gera um caminho em /tmp que não colide com os de outras chamadas
+std::string generateUniqueFilename(const std::string& prefix);
+
+// Lê o arquivo inteiro em data. Retorna false se ele não puder ser aberto.
+bool readFile(const std::string& path, std::string& data);
+
+// Arquivo mapeado em memória somente para leitura, liberado no destrutor. Usado para enviar
+// resultados gravados em disco sem copiá-los para um buffer.
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    // Mapeia path (um arquivo vazio não é mapeado, mas é aceito). Retorna false se não puder abri-lo.
+    bool open(const std::string& path);
+
+    const char* data() const { return static_cast<const char*>(data_); }
+    size_t size() const { return size_; }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+private:
+    void* data_ = nullptr;
+    size_t size_ = 0;
+};
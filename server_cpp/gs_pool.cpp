@@ -0,0 +1,142 @@
+#include "gs_pool.h"
+
+#ifdef HAVE_GHOSTSCRIPT_API
+#include <ghostscript/iapi.h>
+#include <ghostscript/ierrors.h>
+#endif
+
+namespace {
+
+#ifdef HAVE_GHOSTSCRIPT_API
+// Escapa um caminho para uso como string PostScript entre parênteses
+std::string postscriptString(const std::string& text) {
+    std::string escaped = "(";
+    for (char c : text) {
+        if (c == '(' || c == ')' || c == '\\') escaped += '\\';
+        escaped += c;
+    }
+    return escaped + ")";
+}
+#endif
+
+} // namespace
+
+std::unique_ptr<GhostscriptPool> GhostscriptPool::create(size_t size, size_t recycle_after, std::string& error) {
+#ifdef HAVE_GHOSTSCRIPT_API
+    std::unique_ptr<GhostscriptPool> pool(new GhostscriptPool(recycle_after));
+    for (size_t i = 0; i < size; ++i) {
+        Instance instance;
+        // Versões antigas da libgs aceitam uma única instância por processo;
+        // nesse caso o pool fica com as que conseguiram iniciar
+        if (!startInstance(instance)) break;
+        pool->idle_.push_back(pool->instances_.size());
+        pool->instances_.push_back(instance);
+    }
+    if (pool->instances_.empty()) {
+        error = "Nenhuma instância do Ghostscript pôde ser iniciada.";
+        return nullptr;
+    }
+    return pool;
+#else
+    (void)size;
+    (void)recycle_after;
+    error = "Servidor compilado sem a libgs (HAVE_GHOSTSCRIPT_API).";
+    return nullptr;
+#endif
+}
+
+GhostscriptPool::~GhostscriptPool() {
+    for (auto& instance : instances_) stopInstance(instance);
+}
+
+bool GhostscriptPool::startInstance(Instance& instance) {
+#ifdef HAVE_GHOSTSCRIPT_API
+    if (gsapi_new_instance(&instance.handle, nullptr) < 0) {
+        instance.handle = nullptr;
+        return false;
+    }
+    gsapi_set_arg_encoding(instance.handle, GS_ARG_ENCODING_UTF8);
+
+    // Mesmos parâmetros do gs de linha de comando; a saída é trocada a cada job via setpagedevice
+    const char* args[] = {
+        "gs", "-dNOPAUSE", "-dQUIET", "-dSAFER",
+        "--permit-file-all=/tmp/",
+        "-sDEVICE=pdfwrite", "-dCompatibilityLevel=1.4", "-dPDFSETTINGS=/ebook",
+        "-sOutputFile=/dev/null",
+    };
+    int code = gsapi_init_with_args(instance.handle, sizeof(args) / sizeof(args[0]), const_cast<char**>(args));
+    if (code < 0 && code != gs_error_Quit) {
+        gsapi_exit(instance.handle);
+        gsapi_delete_instance(instance.handle);
+        instance.handle = nullptr;
+        return false;
+    }
+    instance.jobs = 0;
+    return true;
+#else
+    (void)instance;
+    return false;
+#endif
+}
+
+void GhostscriptPool::stopInstance(Instance& instance) {
+#ifdef HAVE_GHOSTSCRIPT_API
+    if (!instance.handle) return;
+    gsapi_exit(instance.handle);
+    gsapi_delete_instance(instance.handle);
+    instance.handle = nullptr;
+#else
+    (void)instance;
+#endif
+}
+
+int GhostscriptPool::compress(const std::string& input_path, const std::string& output_path, int first_page, int last_page) {
+#ifdef HAVE_GHOSTSCRIPT_API
+    size_t index;
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        available_.wait(lock, [this] { return !idle_.empty(); });
+        index = idle_.back();
+        idle_.pop_back();
+    }
+    Instance& instance = instances_[index];
+
+    int code = -1;
+    if (instance.handle || startInstance(instance)) {
+        // O pdfwrite só grava o arquivo ao fechar o dispositivo, por isso a saída
+        // volta para /dev/null no fim do job
+        // O runpdf procura FirstPage e LastPage no dicionário corrente, como os definidos por
+        // -dFirstPage/-dLastPage; eles são removidos no fim para não valerem no job seguinte
+        std::string range;
+        if (first_page > 0 && last_page >= first_page) {
+            range = "/FirstPage " + std::to_string(first_page) + " def /LastPage " + std::to_string(last_page) + " def ";
+        }
+        std::string job = range + "<< /OutputFile " + postscriptString(output_path) + " >> setpagedevice " +
+                          postscriptString(input_path) + " (r) file runpdf " +
+                          "<< /OutputFile (/dev/null) >> setpagedevice";
+        if (!range.empty()) job += " userdict /FirstPage undef userdict /LastPage undef";
+        int exit_code = 0;
+        code = gsapi_run_string(instance.handle, job.c_str(), 0, &exit_code);
+        if (code == gs_error_Quit) code = 0;
+
+        // Após um erro o estado do interpretador não é confiável: a instância é reciclada
+        if (code < 0 || ++instance.jobs >= recycle_after_) {
+            stopInstance(instance);
+            startInstance(instance);
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        idle_.push_back(index);
+    }
+    available_.notify_one();
+    return code;
+#else
+    (void)input_path;
+    (void)output_path;
+    (void)first_page;
+    (void)last_page;
+    return -1;
+#endif
+}
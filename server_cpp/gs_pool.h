@@ -0,0 +1,50 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Pool de interpretadores Ghostscript residentes (libgs/gsapi) para o CompressPDF.
+// As instâncias são iniciadas uma vez, com o dispositivo pdfwrite já configurado,
+// e reaproveitadas entre requisições; cada uma é reciclada após recycle_after jobs
+// para limitar vazamentos de memória e estado residual do interpretador.
+// Só está disponível quando o servidor é compilado com HAVE_GHOSTSCRIPT_API.
+class GhostscriptPool {
+public:
+    // Cria e aquece até size instâncias. Retorna nullptr (com a causa em error) se a libgs
+    // não estiver disponível ou nenhuma instância puder ser iniciada.
+    static std::unique_ptr<GhostscriptPool> create(size_t size, size_t recycle_after, std::string& error);
+
+    ~GhostscriptPool();
+
+    // Comprime input_path em output_path com os mesmos parâmetros do gs de linha de comando
+    // (pdfwrite, /ebook, compatibilidade 1.4). Bloqueia até haver uma instância livre.
+    // Com first_page e last_page (numeradas a partir de 1), só esse intervalo é processado,
+    // como com -dFirstPage/-dLastPage. Retorna 0 em caso de sucesso ou o código de erro do Ghostscript.
+    int compress(const std::string& input_path, const std::string& output_path, int first_page = 0, int last_page = 0);
+
+    size_t size() const { return instances_.size(); }
+
+    GhostscriptPool(const GhostscriptPool&) = delete;
+    GhostscriptPool& operator=(const GhostscriptPool&) = delete;
+
+private:
+    struct Instance {
+        void* handle = nullptr;
+        size_t jobs = 0;
+    };
+
+    explicit GhostscriptPool(size_t recycle_after) : recycle_after_(recycle_after) {}
+
+    static bool startInstance(Instance& instance);
+    static void stopInstance(Instance& instance);
+
+    size_t recycle_after_;
+    std::mutex mutex_;
+    std::condition_variable available_;
+    std::vector<Instance> instances_;
+    std::vector<size_t> idle_; // índices de instances_ livres
+};
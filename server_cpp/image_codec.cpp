@@ -0,0 +1,437 @@
+#include "image_codec.h"
+
+#include <algorithm>
+#include <cctype>
+#include <csetjmp>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <jpeglib.h>
+#include <png.h>
+#ifdef HAVE_WEBP
+#include <webp/decode.h>
+#include <webp/encode.h>
+#endif
+
+namespace {
+
+// Qualidade usada pelo convert quando a entrada não informa uma
+const int kJpegQuality = 92;
+const float kWebpQuality = 92.0f;
+
+// Maior redução aplicada na decodificação (a escala mínima do DCT do JPEG)
+const int kMaxShrinkFactor = 8;
+
+// Maior divisor (8, 4, 2 ou 1) que mantém width x height em pelo menos o tamanho mínimo de options
+int shrinkFactor(int width, int height, const DecodeOptions& options) {
+    if (options.min_width <= 0 || options.min_height <= 0) return 1;
+    for (int factor = kMaxShrinkFactor; factor > 1; factor /= 2) {
+        if ((width + factor - 1) / factor >= options.min_width && (height + factor - 1) / factor >= options.min_height) {
+            return factor;
+        }
+    }
+    return 1;
+}
+
+// Recusa imagens que passariam de options.max_pixels depois de decodificadas
+bool withinPixelLimit(int width, int height, const DecodeOptions& options, std::string& error) {
+    if (options.max_pixels == 0 || static_cast<size_t>(width) * static_cast<size_t>(height) <= options.max_pixels) return true;
+    error = "Imagem grande demais: " + std::to_string(width) + "x" + std::to_string(height) + " pixels (limite de " +
+            std::to_string(options.max_pixels) + ").";
+    return false;
+}
+
+// A libjpeg sinaliza erros chamando error_exit, que não deve retornar: o controle volta via longjmp
+struct JpegError {
+    jpeg_error_mgr manager;
+    jmp_buf jump;
+    char message[JMSG_LENGTH_MAX];
+};
+
+void jpegErrorExit(j_common_ptr cinfo) {
+    JpegError* error = reinterpret_cast<JpegError*>(cinfo->err);
+    (*cinfo->err->format_message)(cinfo, error->message);
+    longjmp(error->jump, 1);
+}
+
+ImageResult decodeJpeg(const std::string& data, Image& image, std::string& error, const DecodeOptions& options) {
+    jpeg_decompress_struct cinfo;
+    JpegError jerr;
+    cinfo.err = jpeg_std_error(&jerr.manager);
+    jerr.manager.error_exit = jpegErrorExit;
+    if (setjmp(jerr.jump)) {
+        jpeg_destroy_decompress(&cinfo);
+        error = jerr.message;
+        return ImageResult::Failed;
+    }
+
+    jpeg_create_decompress(&cinfo);
+    jpeg_mem_src(&cinfo, reinterpret_cast<const unsigned char*>(data.data()), data.size());
+    jpeg_read_header(&cinfo, TRUE);
+
+    // CMYK/YCCK não tem conversão para RGB na libjpeg; o convert cuida desses casos
+    if (cinfo.jpeg_color_space == JCS_CMYK || cinfo.jpeg_color_space == JCS_YCCK) {
+        jpeg_destroy_decompress(&cinfo);
+        return ImageResult::Unsupported;
+    }
+
+    cinfo.out_color_space = JCS_RGB;
+    // A escala do DCT descarta os coeficientes de alta frequência em vez de decodificá-los
+    cinfo.scale_num = 1;
+    cinfo.scale_denom = static_cast<unsigned int>(shrinkFactor(static_cast<int>(cinfo.image_width),
+                                                               static_cast<int>(cinfo.image_height), options));
+    jpeg_calc_output_dimensions(&cinfo);
+    if (!withinPixelLimit(static_cast<int>(cinfo.output_width), static_cast<int>(cinfo.output_height), options, error)) {
+        jpeg_destroy_decompress(&cinfo);
+        return ImageResult::Failed;
+    }
+    // JPEGs progressivos guardam os coeficientes da imagem inteira, qualquer que seja a escala;
+    // sem backing store, a libjpeg falha se eles passarem do equivalente a max_pixels em RGBA
+    if (options.max_pixels > 0) cinfo.mem->max_memory_to_use = static_cast<long>(options.max_pixels * 4);
+    jpeg_start_decompress(&cinfo);
+
+    image.width = static_cast<int>(cinfo.output_width);
+    image.height = static_cast<int>(cinfo.output_height);
+    image.channels = 3;
+    image.pixels.resize(image.stride() * image.height);
+    while (cinfo.output_scanline < cinfo.output_height) {
+        JSAMPROW row = image.pixels.data() + cinfo.output_scanline * image.stride();
+        jpeg_read_scanlines(&cinfo, &row, 1);
+    }
+
+    jpeg_finish_decompress(&cinfo);
+    jpeg_destroy_decompress(&cinfo);
+    return ImageResult::Ok;
+}
+
+ImageResult encodeJpeg(const Image& image, std::string& output, std::string& error) {
+    jpeg_compress_struct cinfo;
+    JpegError jerr;
+    unsigned char* buffer = nullptr;
+    unsigned long size = 0;
+    cinfo.err = jpeg_std_error(&jerr.manager);
+    jerr.manager.error_exit = jpegErrorExit;
+    if (setjmp(jerr.jump)) {
+        jpeg_destroy_compress(&cinfo);
+        std::free(buffer);
+        error = jerr.message;
+        return ImageResult::Failed;
+    }
+
+    jpeg_create_compress(&cinfo);
+    jpeg_mem_dest(&cinfo, &buffer, &size);
+    cinfo.image_width = image.width;
+    cinfo.image_height = image.height;
+    // JPEG não tem alfa: a libjpeg-turbo descarta o quarto canal na entrada RGBA
+    cinfo.input_components = image.channels;
+    cinfo.in_color_space = image.channels == 4 ? JCS_EXT_RGBA : JCS_RGB;
+    jpeg_set_defaults(&cinfo);
+    jpeg_set_quality(&cinfo, kJpegQuality, TRUE);
+    jpeg_start_compress(&cinfo, TRUE);
+    while (cinfo.next_scanline < cinfo.image_height) {
+        JSAMPROW row = const_cast<JSAMPROW>(image.pixels.data() + cinfo.next_scanline * image.stride());
+        jpeg_write_scanlines(&cinfo, &row, 1);
+    }
+    jpeg_finish_compress(&cinfo);
+    jpeg_destroy_compress(&cinfo);
+
+    output.assign(reinterpret_cast<const char*>(buffer), size);
+    std::free(buffer);
+    return ImageResult::Ok;
+}
+
+// Origem dos bytes de um PNG lido pela API de baixo nível da libpng
+struct PngSource {
+    const unsigned char* data;
+    size_t size;
+    size_t offset;
+};
+
+void pngReadFromMemory(png_structp png, png_bytep out, png_size_t length) {
+    PngSource* source = static_cast<PngSource*>(png_get_io_ptr(png));
+    if (length > source->size - source->offset) png_error(png, "PNG truncado.");
+    std::memcpy(out, source->data + source->offset, length);
+    source->offset += length;
+}
+
+void pngErrorExit(png_structp png, png_const_charp message) {
+    *static_cast<std::string*>(png_get_error_ptr(png)) = message;
+    png_longjmp(png, 1);
+}
+
+void pngIgnoreWarning(png_structp, png_const_charp) {}
+
+// Se o PNG chega ao RGB(A) sRGB de 8 bits do caminho normal sem correção de gama. A API
+// simplificada toma 16 bits sem gAMA como lineares e corrige gAMA diferente do sRGB; nesses casos
+// a redução (que não aplica gama) daria cores diferentes das do caminho normal.
+bool pngIsPlainSrgb(png_structp png, png_infop info) {
+    if (png_get_bit_depth(png, info) > 8) return false;
+    if (png_get_valid(png, info, PNG_INFO_sRGB)) return true;
+    png_fixed_point gamma = 0;
+    if (!png_get_gAMA_fixed(png, info, &gamma) || gamma == 0) return true;
+    // Mesmo critério da libpng: gama vezes 2,2 a menos de 5% de 1
+    png_fixed_point ratio = (gamma * 11 + 2) / 5;
+    return ratio >= PNG_FP_1 - 5000 && ratio <= PNG_FP_1 + 5000;
+}
+
+// Decodifica o PNG reduzindo-o por factor enquanto lê: cada pixel da saída é a média de um bloco
+// factor x factor, e só uma linha da entrada fica em memória por vez. PNGs entrelaçados (Adam7),
+// que precisam da imagem inteira, e os que pedem correção de gama (ver pngIsPlainSrgb) retornam
+// Unsupported para seguir pelo caminho normal.
+ImageResult decodePngReduced(const std::string& data, int factor, Image& image, std::string& error) {
+    png_structp png = png_create_read_struct(PNG_LIBPNG_VER_STRING, &error, pngErrorExit, pngIgnoreWarning);
+    if (!png) {
+        error = "Falha ao iniciar a libpng.";
+        return ImageResult::Failed;
+    }
+    png_infop info = png_create_info_struct(png);
+    std::vector<uint8_t> row;
+    std::vector<uint16_t> columns; // até kMaxShrinkFactor linhas de 8 bits: cabe em 16 bits
+    if (!info || setjmp(png_jmpbuf(png))) {
+        png_destroy_read_struct(&png, info ? &info : nullptr, nullptr);
+        return ImageResult::Failed;
+    }
+
+    PngSource source{reinterpret_cast<const unsigned char*>(data.data()), data.size(), 0};
+    png_set_read_fn(png, &source, pngReadFromMemory);
+    png_read_info(png, info);
+    if (png_get_interlace_type(png, info) != PNG_INTERLACE_NONE || !pngIsPlainSrgb(png, info)) {
+        png_destroy_read_struct(&png, &info, nullptr);
+        return ImageResult::Unsupported;
+    }
+
+    // As mesmas normalizações do caminho normal: paletas e tons de cinza viram RGB(A) de 8 bits
+    png_byte color_type = png_get_color_type(png, info);
+    png_set_expand(png);
+    if (color_type == PNG_COLOR_TYPE_GRAY || color_type == PNG_COLOR_TYPE_GRAY_ALPHA) png_set_gray_to_rgb(png);
+    png_read_update_info(png, info);
+
+    const int width = static_cast<int>(png_get_image_width(png, info));
+    const int height = static_cast<int>(png_get_image_height(png, info));
+    const int channels = png_get_channels(png, info);
+    image.width = (width + factor - 1) / factor;
+    image.height = (height + factor - 1) / factor;
+    image.channels = channels;
+    image.pixels.resize(image.stride() * image.height);
+    row.resize(png_get_rowbytes(png, info));
+    columns.assign(row.size(), 0);
+
+    for (int y = 0; y < height; ++y) {
+        // Soma as linhas de cada faixa coluna a coluna (laço simples, vetorizado pelo compilador)
+        png_read_row(png, row.data(), nullptr);
+        for (size_t i = 0; i < row.size(); ++i) columns[i] += row[i];
+        if ((y + 1) % factor != 0 && y + 1 != height) continue;
+
+        // Fim de uma faixa de factor linhas (ou da imagem): grava a média de cada bloco
+        const uint32_t rows = static_cast<uint32_t>(y % factor + 1);
+        uint8_t* out = &image.pixels[static_cast<size_t>(y / factor) * image.stride()];
+        for (int x = 0; x < image.width; ++x) {
+            const int first = x * factor;
+            const int last = std::min(first + factor, width);
+            const uint32_t count = rows * static_cast<uint32_t>(last - first);
+            for (int c = 0; c < channels; ++c) {
+                uint32_t sum = 0;
+                for (int k = first; k < last; ++k) sum += columns[static_cast<size_t>(k) * channels + c];
+                out[static_cast<size_t>(x) * channels + c] = static_cast<uint8_t>((sum + count / 2) / count);
+            }
+        }
+        std::fill(columns.begin(), columns.end(), 0);
+    }
+
+    png_read_end(png, nullptr);
+    png_destroy_read_struct(&png, &info, nullptr);
+    return ImageResult::Ok;
+}
+
+ImageResult decodePng(const std::string& data, Image& image, std::string& error, const DecodeOptions& options) {
+    png_image png;
+    std::memset(&png, 0, sizeof(png));
+    png.version = PNG_IMAGE_VERSION;
+    if (!png_image_begin_read_from_memory(&png, data.data(), data.size())) {
+        error = png.message;
+        return ImageResult::Failed;
+    }
+
+    int factor = shrinkFactor(static_cast<int>(png.width), static_cast<int>(png.height), options);
+    if (factor > 1) {
+        int width = (static_cast<int>(png.width) + factor - 1) / factor;
+        int height = (static_cast<int>(png.height) + factor - 1) / factor;
+        png_image_free(&png);
+        if (!withinPixelLimit(width, height, options, error)) return ImageResult::Failed;
+        ImageResult result = decodePngReduced(data, factor, image, error);
+        if (result != ImageResult::Unsupported) return result;
+        // Entrelaçado ou com correção de gama: decodifica inteiro, como sem a redução
+        std::memset(&png, 0, sizeof(png));
+        png.version = PNG_IMAGE_VERSION;
+        if (!png_image_begin_read_from_memory(&png, data.data(), data.size())) {
+            error = png.message;
+            return ImageResult::Failed;
+        }
+    }
+    if (!withinPixelLimit(static_cast<int>(png.width), static_cast<int>(png.height), options, error)) {
+        png_image_free(&png);
+        return ImageResult::Failed;
+    }
+
+    // Paletas, tons de cinza e 16 bits são normalizados para RGB(A) de 8 bits
+    bool alpha = (png.format & PNG_FORMAT_FLAG_ALPHA) != 0;
+    png.format = alpha ? PNG_FORMAT_RGBA : PNG_FORMAT_RGB;
+    image.width = static_cast<int>(png.width);
+    image.height = static_cast<int>(png.height);
+    image.channels = alpha ? 4 : 3;
+    image.pixels.resize(PNG_IMAGE_SIZE(png));
+    if (!png_image_finish_read(&png, nullptr, image.pixels.data(), 0, nullptr)) {
+        error = png.message;
+        png_image_free(&png);
+        return ImageResult::Failed;
+    }
+    return ImageResult::Ok;
+}
+
+ImageResult encodePng(const Image& image, std::string& output, std::string& error) {
+    png_image png;
+    std::memset(&png, 0, sizeof(png));
+    png.version = PNG_IMAGE_VERSION;
+    png.width = image.width;
+    png.height = image.height;
+    png.format = image.channels == 4 ? PNG_FORMAT_RGBA : PNG_FORMAT_RGB;
+
+    // Primeira chamada só calcula o tamanho necessário
+    png_alloc_size_t size = 0;
+    if (!png_image_write_to_memory(&png, nullptr, &size, 0, image.pixels.data(), 0, nullptr)) {
+        error = png.message;
+        return ImageResult::Failed;
+    }
+    output.resize(size);
+    if (!png_image_write_to_memory(&png, &output[0], &size, 0, image.pixels.data(), 0, nullptr)) {
+        error = png.message;
+        return ImageResult::Failed;
+    }
+    output.resize(size);
+    return ImageResult::Ok;
+}
+
+#ifdef HAVE_WEBP
+ImageResult decodeWebp(const std::string& data, Image& image, std::string& error, const DecodeOptions& options) {
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data.data());
+    WebPDecoderConfig config;
+    if (!WebPInitDecoderConfig(&config) || WebPGetFeatures(bytes, data.size(), &config.input) != VP8_STATUS_OK) {
+        error = "Cabeçalho WebP inválido.";
+        return ImageResult::Failed;
+    }
+    const WebPBitstreamFeatures& features = config.input;
+    // WebP animado fica com o convert
+    if (features.has_animation) return ImageResult::Unsupported;
+
+    int factor = shrinkFactor(features.width, features.height, options);
+    image.width = (features.width + factor - 1) / factor;
+    image.height = (features.height + factor - 1) / factor;
+    image.channels = features.has_alpha ? 4 : 3;
+    if (!withinPixelLimit(image.width, image.height, options, error)) return ImageResult::Failed;
+    image.pixels.resize(image.stride() * image.height);
+
+    // A libwebp reamostra cada linha assim que ela é decodificada, sem montar a imagem inteira
+    config.options.use_scaling = factor > 1;
+    config.options.scaled_width = image.width;
+    config.options.scaled_height = image.height;
+    config.output.colorspace = features.has_alpha ? MODE_RGBA : MODE_RGB;
+    config.output.is_external_memory = 1;
+    config.output.u.RGBA.rgba = image.pixels.data();
+    config.output.u.RGBA.stride = static_cast<int>(image.stride());
+    config.output.u.RGBA.size = image.pixels.size();
+    bool decoded = WebPDecode(bytes, data.size(), &config) == VP8_STATUS_OK;
+    WebPFreeDecBuffer(&config.output);
+    if (!decoded) {
+        error = "Falha ao decodificar WebP.";
+        return ImageResult::Failed;
+    }
+    return ImageResult::Ok;
+}
+
+ImageResult encodeWebp(const Image& image, std::string& output, std::string& error) {
+    uint8_t* buffer = nullptr;
+    int stride = static_cast<int>(image.stride());
+    size_t size = image.channels == 4
+        ? WebPEncodeRGBA(image.pixels.data(), image.width, image.height, stride, kWebpQuality, &buffer)
+        : WebPEncodeRGB(image.pixels.data(), image.width, image.height, stride, kWebpQuality, &buffer);
+    if (size == 0) {
+        error = "Falha ao codificar WebP.";
+        return ImageResult::Failed;
+    }
+    output.assign(reinterpret_cast<const char*>(buffer), size);
+    WebPFree(buffer);
+    return ImageResult::Ok;
+}
+#endif
+
+} // namespace
+
+ImageFormat detectImageFormat(const std::string& data) {
+    if (data.size() >= 3 && static_cast<unsigned char>(data[0]) == 0xFF &&
+        static_cast<unsigned char>(data[1]) == 0xD8 && static_cast<unsigned char>(data[2]) == 0xFF) {
+        return ImageFormat::Jpeg;
+    }
+    if (data.size() >= 8 && data.compare(0, 8, "\x89PNG\r\n\x1a\n") == 0) {
+        return ImageFormat::Png;
+    }
+    if (data.size() >= 12 && data.compare(0, 4, "RIFF") == 0 && data.compare(8, 4, "WEBP") == 0) {
+        return ImageFormat::Webp;
+    }
+    return ImageFormat::Unknown;
+}
+
+ImageFormat imageFormatFromName(const std::string& name) {
+    std::string lower = name;
+    std::transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char c) { return std::tolower(c); });
+    if (lower == "jpg" || lower == "jpeg") return ImageFormat::Jpeg;
+    if (lower == "png") return ImageFormat::Png;
+    if (lower == "webp") return ImageFormat::Webp;
+    return ImageFormat::Unknown;
+}
+
+bool imageFormatAvailable(ImageFormat format) {
+    switch (format) {
+        case ImageFormat::Jpeg:
+        case ImageFormat::Png:
+            return true;
+        case ImageFormat::Webp:
+#ifdef HAVE_WEBP
+            return true;
+#else
+            return false;
+#endif
+        default:
+            return false;
+    }
+}
+
+ImageResult decodeImage(const std::string& data, Image& image, std::string& error, const DecodeOptions& options) {
+    switch (detectImageFormat(data)) {
+        case ImageFormat::Jpeg:
+            return decodeJpeg(data, image, error, options);
+        case ImageFormat::Png:
+            return decodePng(data, image, error, options);
+#ifdef HAVE_WEBP
+        case ImageFormat::Webp:
+            return decodeWebp(data, image, error, options);
+#endif
+        default:
+            return ImageResult::Unsupported;
+    }
+}
+
+ImageResult encodeImage(const Image& image, ImageFormat format, std::string& output, std::string& error) {
+    switch (format) {
+        case ImageFormat::Jpeg:
+            return encodeJpeg(image, output, error);
+        case ImageFormat::Png:
+            return encodePng(image, output, error);
+#ifdef HAVE_WEBP
+        case ImageFormat::Webp:
+            return encodeWebp(image, output, error);
+#endif
+        default:
+            return ImageResult::Unsupported;
+    }
+}
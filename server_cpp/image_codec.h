@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Imagem decodificada: linhas contíguas de pixels intercalados de 8 bits (RGB ou RGBA)
+struct Image {
+    int width = 0;
+    int height = 0;
+    int channels = 0; // 3 = RGB, 4 = RGBA
+    std::vector<uint8_t> pixels;
+
+    size_t stride() const { return static_cast<size_t>(width) * channels; }
+};
+
+enum class ImageFormat { Unknown, Jpeg, Png, Webp };
+
+// Resultado das operações do motor nativo. Unsupported indica que a entrada é válida,
+// mas deve ser tratada pelo convert (formato ou variante não suportada aqui).
+enum class ImageResult { Ok, Unsupported, Failed };
+
+// Identifica o formato pelos bytes iniciais do arquivo
+ImageFormat detectImageFormat(const std::string& data);
+
+// Converte o nome recebido na requisição ("png", "jpg", ...) no formato correspondente
+ImageFormat imageFormatFromName(const std::string& name);
+
+// Indica se o formato foi habilitado na compilação (WebP depende da libwebp)
+bool imageFormatAvailable(ImageFormat format);
+
+// Ajustes da decodificação. Com min_width e min_height, a imagem já é reduzida ao ser
+// decodificada, sem ficar menor que esse tamanho: JPEG pela escala do DCT (1/2, 1/4, 1/8), WebP
+// pelo redimensionamento da própria libwebp e PNG não entrelaçado por média de blocos, linha a
+// linha. O redimensionamento preciso é feito depois, sobre a imagem menor.
+struct DecodeOptions {
+    int min_width = 0;
+    int min_height = 0;
+    // Pixels da imagem decodificada (0 = sem limite). Imagens maiores falham antes de qualquer
+    // alocação grande; com a redução acima, o que conta é o tamanho já reduzido.
+    size_t max_pixels = 0;
+};
+
+ImageResult decodeImage(const std::string& data, Image& image, std::string& error,
+                        const DecodeOptions& options = DecodeOptions());
+ImageResult encodeImage(const Image& image, ImageFormat format, std::string& output, std::string& error);
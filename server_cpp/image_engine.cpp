@@ -0,0 +1,122 @@
+#include "image_engine.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+
+ImageResult runNativeImage(const std::string& input, const ImageOperation& operation, std::string& output, std::string& error,
+                           size_t max_pixels) {
+    return runNativeImage(input, std::vector<ImageOperation>{operation}, output, error, max_pixels);
+}
+
+ImageResult runNativeImage(const std::string& input, const std::vector<ImageOperation>& operations, std::string& output,
+                           std::string& error, size_t max_pixels) {
+    std::string format_name;
+    for (const auto& operation : operations) {
+        if (!operation.output_format.empty()) format_name = operation.output_format;
+    }
+    ImageFormat output_format = format_name.empty() ? detectImageFormat(input) : imageFormatFromName(format_name);
+    if (!imageFormatAvailable(output_format)) return ImageResult::Unsupported;
+
+    // O primeiro redimensionamento define a resolução necessária: os seguintes partem da saída dele
+    DecodeOptions decode;
+    decode.max_pixels = max_pixels;
+    for (const auto& operation : operations) {
+        if (operation.width <= 0 && operation.height <= 0) continue;
+        decode.min_width = operation.width;
+        decode.min_height = operation.height;
+        break;
+    }
+
+    Image image;
+    ImageResult result = decodeImage(input, image, error, decode);
+    if (result != ImageResult::Ok) return result;
+
+    for (const auto& operation : operations) {
+        if (operation.width <= 0 && operation.height <= 0) continue;
+        Image resized;
+        ResizeOptions options;
+        options.filter = operation.filter;
+        if (!resizeImage(image, operation.width, operation.height, resized, options)) {
+            error = "Dimensões inválidas.";
+            return ImageResult::Failed;
+        }
+        image = std::move(resized);
+    }
+
+    return encodeImage(image, output_format, output, error);
+}
+
+std::vector<ImageOutputStep> planImageOutputs(const std::vector<ImageOperation>& outputs) {
+    auto area = [&](size_t index) { return static_cast<int64_t>(outputs[index].width) * outputs[index].height; };
+    std::vector<size_t> order(outputs.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return area(a) > area(b); });
+
+    std::vector<ImageOutputStep> steps;
+    steps.reserve(order.size());
+    for (size_t index : order) {
+        ImageOutputStep step = {index, -1};
+        for (const auto& done : steps) {
+            const ImageOperation& candidate = outputs[done.output];
+            if (candidate.width < outputs[index].width || candidate.height < outputs[index].height) continue;
+            if (step.source < 0 || area(done.output) < area(static_cast<size_t>(step.source))) {
+                step.source = static_cast<int>(done.output);
+            }
+        }
+        steps.push_back(step);
+    }
+    return steps;
+}
+
+ImageResult runNativeImageOutputs(const std::string& input, const std::vector<ImageOperation>& outputs,
+                                  const ImageOutputCallback& on_output, std::string& error, size_t max_pixels) {
+    ImageFormat input_format = detectImageFormat(input);
+    std::vector<ImageFormat> formats;
+    formats.reserve(outputs.size());
+    for (const auto& output : outputs) {
+        if (output.width <= 0 || output.height <= 0) {
+            error = "Dimensões inválidas.";
+            return ImageResult::Failed;
+        }
+        formats.push_back(output.output_format.empty() ? input_format : imageFormatFromName(output.output_format));
+        if (!imageFormatAvailable(formats.back())) return ImageResult::Unsupported;
+    }
+
+    // A decodificação pode reduzir até o maior tamanho pedido em cada dimensão
+    DecodeOptions decode;
+    decode.max_pixels = max_pixels;
+    for (const auto& output : outputs) {
+        decode.min_width = std::max(decode.min_width, output.width);
+        decode.min_height = std::max(decode.min_height, output.height);
+    }
+
+    Image source;
+    ImageResult result = decodeImage(input, source, error, decode);
+    if (result != ImageResult::Ok) return result;
+
+    // As saídas geradas ficam guardadas para servir de origem às menores
+    std::vector<Image> produced(outputs.size());
+    std::string encoded;
+    bool sent = false;
+    for (const auto& step : planImageOutputs(outputs)) {
+        const ImageOperation& output = outputs[step.output];
+        const Image& from = step.source < 0 ? source : produced[static_cast<size_t>(step.source)];
+        Image& resized = produced[step.output];
+        ResizeOptions options;
+        options.filter = output.filter;
+        if (!resizeImage(from, output.width, output.height, resized, options)) {
+            error = "Dimensões inválidas.";
+            return ImageResult::Failed;
+        }
+        result = encodeImage(resized, formats[step.output], encoded, error);
+        if (result == ImageResult::Unsupported && sent) result = ImageResult::Failed;
+        if (result != ImageResult::Ok) return result;
+        if (!on_output(step.output, encoded)) {
+            error = "Envio interrompido.";
+            return ImageResult::Failed;
+        }
+        sent = true;
+    }
+    return ImageResult::Ok;
+}
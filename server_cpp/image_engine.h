@@ -0,0 +1,48 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "image_codec.h"
+#include "image_resize.h"
+
+// Operação executada pelo motor de imagens interno (alternativa ao convert)
+struct ImageOperation {
+    std::string output_format; // vazio = mesmo formato da entrada
+    int width = 0;             // 0 = sem redimensionamento
+    int height = 0;
+    ResizeFilter filter = ResizeFilter::Lanczos3;
+};
+
+// Decodifica a entrada a partir da memória, aplica a operação e codifica a saída, sem
+// disco nem processos externos. Unsupported significa que o chamador deve usar o convert.
+// Uma redução já é feita em parte na decodificação (ver DecodeOptions); max_pixels limita o
+// tamanho da imagem decodificada (0 = sem limite).
+ImageResult runNativeImage(const std::string& input, const ImageOperation& operation, std::string& output, std::string& error,
+                           size_t max_pixels = 0);
+
+// Aplica várias operações com uma única decodificação e uma única codificação: os
+// redimensionamentos em ordem e o último formato pedido na saída (etapas fundidas do RunPipeline)
+ImageResult runNativeImage(const std::string& input, const std::vector<ImageOperation>& operations, std::string& output,
+                           std::string& error, size_t max_pixels = 0);
+
+// Uma etapa da geração de várias saídas: a saída output é redimensionada a partir da saída
+// source, já gerada, ou da imagem decodificada (source = -1)
+struct ImageOutputStep {
+    size_t output;
+    int source;
+};
+
+// Ordem de geração de várias saídas: da maior para a menor, cada uma partindo da menor já gerada
+// que ainda a cubra nas duas dimensões. Usada pelo motor interno e pelo comando do convert.
+std::vector<ImageOutputStep> planImageOutputs(const std::vector<ImageOperation>& outputs);
+
+// Recebe cada saída de runNativeImageOutputs assim que ela é codificada, com a posição dela em
+// outputs. Retornar false interrompe a geração das demais.
+using ImageOutputCallback = std::function<bool(size_t index, const std::string& data)>;
+
+// Gera várias saídas (tamanho e formato de cada uma) com uma única decodificação, na ordem de
+// planImageOutputs. Unsupported só é devolvido antes da primeira saída.
+ImageResult runNativeImageOutputs(const std::string& input, const std::vector<ImageOperation>& outputs,
+                                  const ImageOutputCallback& on_output, std::string& error, size_t max_pixels = 0);
@@ -0,0 +1,227 @@
+#include "image_resize.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#include "image_resize_kernels.h"
+
+namespace {
+
+// Tabela de pesos de uma dimensão, em ponto fixo
+struct ResampleCoeffs {
+    int taps = 0;                 // pesos por pixel de saída, múltiplo de 4 (completado com zeros)
+    std::vector<int> start;       // primeiro pixel de entrada de cada pixel de saída
+    std::vector<int16_t> weights; // start.size() * taps
+};
+
+struct Kernels {
+    RowKernel row;
+    ColumnKernel column;
+};
+
+double filterSupport(ResizeFilter filter) {
+    switch (filter) {
+        case ResizeFilter::Box: return 0.5;
+        case ResizeFilter::Bilinear: return 1.0;
+        case ResizeFilter::Lanczos3: return 3.0;
+    }
+    return 1.0;
+}
+
+double sinc(double x) {
+    if (x == 0.0) return 1.0;
+    x *= M_PI;
+    return std::sin(x) / x;
+}
+
+double filterWeight(ResizeFilter filter, double x) {
+    switch (filter) {
+        case ResizeFilter::Box:
+            return (x > -0.5 && x <= 0.5) ? 1.0 : 0.0;
+        case ResizeFilter::Bilinear:
+            x = std::fabs(x);
+            return x < 1.0 ? 1.0 - x : 0.0;
+        case ResizeFilter::Lanczos3:
+            return (x > -3.0 && x < 3.0) ? sinc(x) * sinc(x / 3.0) : 0.0;
+    }
+    return 0.0;
+}
+
+// Calcula os pesos de in_size -> out_size. Na redução o filtro é alargado pela escala
+// (cada saída cobre vários pixels de entrada); a janela de cada saída é deslocada para
+// caber inteira na imagem, o que permite aos kernels ler taps pixels sem testar bordas.
+ResampleCoeffs computeCoeffs(int in_size, int out_size, ResizeFilter filter) {
+    const double scale = static_cast<double>(in_size) / out_size;
+    const double filter_scale = std::max(scale, 1.0);
+    const double radius = filterSupport(filter) * filter_scale;
+    const int window = std::min(in_size, static_cast<int>(std::ceil(radius)) * 2 + 1);
+    const int one = 1 << kWeightBits;
+
+    ResampleCoeffs coeffs;
+    coeffs.taps = (window + 3) & ~3;
+    coeffs.start.resize(out_size);
+    coeffs.weights.assign(static_cast<size_t>(out_size) * coeffs.taps, 0);
+
+    std::vector<double> weights(window);
+    for (int i = 0; i < out_size; ++i) {
+        const double center = (i + 0.5) * scale;
+        int first = std::max(0, static_cast<int>(center - radius + 0.5));
+        int last = std::min(in_size, static_cast<int>(center + radius + 0.5));
+        int count = std::min(last - first, window);
+
+        double total = 0.0;
+        for (int j = 0; j < count; ++j) {
+            weights[j] = filterWeight(filter, (first + j - center + 0.5) / filter_scale);
+            total += weights[j];
+        }
+        if (total == 0.0) {
+            // Janela sem nenhum peso (escalas extremas com o filtro box): usa o pixel mais próximo
+            first = std::min(static_cast<int>(center), in_size - 1);
+            count = 1;
+            weights[0] = total = 1.0;
+        }
+
+        const int start = std::min(first, in_size - window);
+        int16_t* out = &coeffs.weights[static_cast<size_t>(i) * coeffs.taps + (first - start)];
+        int sum = 0;
+        int largest = 0;
+        for (int j = 0; j < count; ++j) {
+            out[j] = static_cast<int16_t>(std::lround(weights[j] / total * one));
+            sum += out[j];
+            if (std::abs(out[j]) > std::abs(out[largest])) largest = j;
+        }
+        // O erro de arredondamento vai para o maior peso, para que áreas de cor uniforme fiquem exatas
+        out[largest] = static_cast<int16_t>(out[largest] + (one - sum));
+        coeffs.start[i] = start;
+    }
+    return coeffs;
+}
+
+bool kernelSupported(ResizeKernel kernel) {
+    switch (kernel) {
+        case ResizeKernel::Scalar:
+            return true;
+#if defined(__x86_64__) || defined(__i386__)
+        case ResizeKernel::Sse41:
+            return __builtin_cpu_supports("sse4.1");
+        case ResizeKernel::Avx2:
+            return __builtin_cpu_supports("avx2");
+#endif
+        default:
+            return false;
+    }
+}
+
+Kernels kernelsFor(ResizeKernel kernel) {
+    if (kernel == ResizeKernel::Auto || !kernelSupported(kernel)) kernel = detectResizeKernel();
+    switch (kernel) {
+#if defined(__x86_64__) || defined(__i386__)
+        case ResizeKernel::Avx2:
+            return {resampleRowAvx2, resampleColumnAvx2};
+        case ResizeKernel::Sse41:
+            return {resampleRowSse41, resampleColumnSse41};
+#endif
+        default:
+            return {resampleRowScalar, resampleColumnScalar};
+    }
+}
+
+} // namespace
+
+ResizeKernel detectResizeKernel() {
+    static const ResizeKernel detected = []() {
+        if (kernelSupported(ResizeKernel::Avx2)) return ResizeKernel::Avx2;
+        if (kernelSupported(ResizeKernel::Sse41)) return ResizeKernel::Sse41;
+        return ResizeKernel::Scalar;
+    }();
+    return detected;
+}
+
+const char* resizeKernelName(ResizeKernel kernel) {
+    switch (kernel) {
+        case ResizeKernel::Auto: return resizeKernelName(detectResizeKernel());
+        case ResizeKernel::Scalar: return "scalar";
+        case ResizeKernel::Sse41: return "sse4.1";
+        case ResizeKernel::Avx2: return "avx2";
+    }
+    return "scalar";
+}
+
+const char* resizeFilterName(ResizeFilter filter) {
+    switch (filter) {
+        case ResizeFilter::Box: return "box";
+        case ResizeFilter::Bilinear: return "bilinear";
+        case ResizeFilter::Lanczos3: return "lanczos3";
+    }
+    return "lanczos3";
+}
+
+bool parseResizeFilter(const std::string& name, ResizeFilter& filter) {
+    if (name == "box") {
+        filter = ResizeFilter::Box;
+    } else if (name == "bilinear") {
+        filter = ResizeFilter::Bilinear;
+    } else if (name == "lanczos3") {
+        filter = ResizeFilter::Lanczos3;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool resizeImage(const Image& src, int width, int height, Image& dst, const ResizeOptions& options) {
+    if (width <= 0 || height <= 0 || src.width <= 0 || src.height <= 0) return false;
+    if (src.channels != 3 && src.channels != 4) return false;
+
+    const Kernels kernels = kernelsFor(options.kernel);
+    const int channels = src.channels;
+
+    // Passada horizontal: src.height linhas de width pixels
+    Image horizontal;
+    const Image* columns_source = &src;
+    if (width != src.width) {
+        ResampleCoeffs coeffs = computeCoeffs(src.width, width, options.filter);
+        horizontal.width = width;
+        horizontal.height = src.height;
+        horizontal.channels = channels;
+        horizontal.pixels.resize(horizontal.stride() * src.height);
+
+        // Cada linha é copiada para um buffer com folga, para que os kernels possam ler além do último pixel
+        std::vector<uint8_t> row(src.stride() + kRowPadding, 0);
+        for (int y = 0; y < src.height; ++y) {
+            std::memcpy(row.data(), src.pixels.data() + y * src.stride(), src.stride());
+            kernels.row(row.data(), horizontal.pixels.data() + y * horizontal.stride(), width, channels,
+                        coeffs.start.data(), coeffs.weights.data(), coeffs.taps);
+        }
+        columns_source = &horizontal;
+    }
+
+    // Passada vertical
+    if (height == src.height) {
+        dst = columns_source == &src ? src : std::move(horizontal);
+        return true;
+    }
+
+    ResampleCoeffs coeffs = computeCoeffs(src.height, height, options.filter);
+    Image result;
+    result.width = width;
+    result.height = height;
+    result.channels = channels;
+    result.pixels.resize(result.stride() * height);
+
+    const size_t source_stride = columns_source->stride();
+    std::vector<const uint8_t*> rows(coeffs.taps);
+    for (int y = 0; y < height; ++y) {
+        // Taps de preenchimento (peso zero) apontam para a última linha válida
+        for (int k = 0; k < coeffs.taps; ++k) {
+            int source_row = std::min(coeffs.start[y] + k, src.height - 1);
+            rows[k] = columns_source->pixels.data() + source_row * source_stride;
+        }
+        kernels.column(rows.data(), &coeffs.weights[static_cast<size_t>(y) * coeffs.taps], coeffs.taps,
+                       result.pixels.data() + y * result.stride(), static_cast<int>(result.stride()));
+    }
+    dst = std::move(result);
+    return true;
+}
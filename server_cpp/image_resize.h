@@ -0,0 +1,31 @@
+#pragma once
+
+#include <string>
+
+#include "image_codec.h"
+
+// Filtros de reamostragem disponíveis
+enum class ResizeFilter { Box, Bilinear, Lanczos3 };
+
+// Conjunto de instruções dos kernels; Auto escolhe o melhor suportado pela CPU
+enum class ResizeKernel { Auto, Scalar, Sse41, Avx2 };
+
+struct ResizeOptions {
+    ResizeFilter filter = ResizeFilter::Lanczos3;
+    ResizeKernel kernel = ResizeKernel::Auto;
+};
+
+// Redimensiona src para width x height (sem preservar a proporção, como o "-resize WxH!" do convert).
+// A reamostragem é separável (horizontal e depois vertical) com pesos pré-calculados em ponto fixo;
+// todos os kernels produzem exatamente o mesmo resultado.
+bool resizeImage(const Image& src, int width, int height, Image& dst, const ResizeOptions& options = ResizeOptions());
+
+// Kernel escolhido por Auto nesta CPU
+ResizeKernel detectResizeKernel();
+
+const char* resizeKernelName(ResizeKernel kernel);
+
+const char* resizeFilterName(ResizeFilter filter);
+
+// Converte "box", "bilinear" ou "lanczos3" no filtro correspondente
+bool parseResizeFilter(const std::string& name, ResizeFilter& filter);
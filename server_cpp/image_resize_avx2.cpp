@@ -0,0 +1,81 @@
+// Kernels AVX2: compilado com -mavx2 e usado apenas quando a CPU suporta
+#include "image_resize_kernels.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+
+#include <cstring>
+#include <immintrin.h>
+
+namespace {
+
+void columnTail(const uint8_t* const* rows, const int16_t* weights, int taps, uint8_t* dst, int begin, int end) {
+    for (int i = begin; i < end; ++i) {
+        int32_t sum = 1 << (kWeightBits - 1);
+        for (int k = 0; k < taps; ++k) sum += weights[k] * rows[k][i];
+        sum >>= kWeightBits;
+        dst[i] = static_cast<uint8_t>(sum < 0 ? 0 : (sum > 255 ? 255 : sum));
+    }
+}
+
+} // namespace
+
+void resampleRowAvx2(const uint8_t* src, uint8_t* dst, int out_width, int channels,
+                     const int* start, const int16_t* weights, int taps) {
+    // Quatro taps por iteração: a metade baixa do registrador recebe os pixels 0 e 1 e a alta
+    // os pixels 2 e 3, cada par com os canais intercalados em int16 para o madd
+    const __m256i shuffle = channels == 4
+        ? _mm256_setr_epi8(0, -1, 4, -1, 1, -1, 5, -1, 2, -1, 6, -1, 3, -1, 7, -1,
+                           8, -1, 12, -1, 9, -1, 13, -1, 10, -1, 14, -1, 11, -1, 15, -1)
+        : _mm256_setr_epi8(0, -1, 3, -1, 1, -1, 4, -1, 2, -1, 5, -1, -1, -1, -1, -1,
+                           6, -1, 9, -1, 7, -1, 10, -1, 8, -1, 11, -1, -1, -1, -1, -1);
+    const __m256i pair_index = _mm256_setr_epi32(0, 0, 0, 0, 1, 1, 1, 1);
+    const __m128i half = _mm_set1_epi32(1 << (kWeightBits - 1));
+
+    for (int x = 0; x < out_width; ++x) {
+        const uint8_t* in = src + start[x] * channels;
+        const int16_t* w = weights + x * taps;
+        __m256i sum = _mm256_setzero_si256();
+        for (int k = 0; k < taps; k += 4) {
+            __m128i raw = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + k * channels));
+            __m256i pixels = _mm256_shuffle_epi8(_mm256_broadcastsi128_si256(raw), shuffle);
+            // (w0,w1) repetido na metade baixa e (w2,w3) na alta
+            __m128i four = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(w + k));
+            __m256i pairs = _mm256_permutevar8x32_epi32(_mm256_castsi128_si256(four), pair_index);
+            sum = _mm256_add_epi32(sum, _mm256_madd_epi16(pixels, pairs));
+        }
+        __m128i total = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+        total = _mm_srai_epi32(_mm_add_epi32(total, half), kWeightBits);
+        __m128i words = _mm_packs_epi32(total, total);
+        __m128i packed = _mm_packus_epi16(words, words);
+        int32_t out = _mm_cvtsi128_si32(packed);
+        std::memcpy(dst + x * channels, &out, channels);
+    }
+}
+
+void resampleColumnAvx2(const uint8_t* const* rows, const int16_t* weights, int taps,
+                        uint8_t* dst, int row_bytes) {
+    const __m256i half = _mm256_set1_epi32(1 << (kWeightBits - 1));
+    int i = 0;
+    for (; i + 16 <= row_bytes; i += 16) {
+        __m256i low = half;
+        __m256i high = half;
+        for (int k = 0; k < taps; k += 2) {
+            __m256i a = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(rows[k] + i)));
+            __m256i b = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(rows[k + 1] + i)));
+            int32_t pair;
+            std::memcpy(&pair, weights + k, sizeof(pair));
+            __m256i w = _mm256_set1_epi32(pair);
+            low = _mm256_add_epi32(low, _mm256_madd_epi16(_mm256_unpacklo_epi16(a, b), w));
+            high = _mm256_add_epi32(high, _mm256_madd_epi16(_mm256_unpackhi_epi16(a, b), w));
+        }
+        low = _mm256_srai_epi32(low, kWeightBits);
+        high = _mm256_srai_epi32(high, kWeightBits);
+        // packs/packus operam por metade de 128 bits; o permute junta os 16 bytes em ordem
+        __m256i words = _mm256_packs_epi32(low, high);
+        __m256i bytes = _mm256_permute4x64_epi64(_mm256_packus_epi16(words, words), 0xD8);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm256_castsi256_si128(bytes));
+    }
+    columnTail(rows, weights, taps, dst, i, row_bytes);
+}
+
+#endif
@@ -0,0 +1,40 @@
+#pragma once
+
+// Kernels internos do redimensionamento. Cada implementação SIMD fica em um arquivo
+// compilado com as flags do seu conjunto de instruções; por isso as assinaturas usam
+// apenas ponteiros, sem templates ou funções inline compartilhadas que poderiam ser
+// instanciadas com AVX2 e usadas em uma CPU sem suporte.
+
+#include <cstdint>
+
+// Pesos em ponto fixo: 1.0 == 1 << kWeightBits (cabe em int16 mesmo com os lóbulos do Lanczos)
+constexpr int kWeightBits = 14;
+
+// Folga exigida ao final de cada linha passada para os kernels horizontais
+constexpr int kRowPadding = 64;
+
+// Passada horizontal de uma linha. src deve ter kRowPadding bytes legíveis após o último pixel.
+// Para cada pixel de saída x, combina os taps pixels a partir de start[x] com weights[x * taps].
+// taps é múltiplo de 4 e channels é 3 ou 4.
+using RowKernel = void (*)(const uint8_t* src, uint8_t* dst, int out_width, int channels,
+                           const int* start, const int16_t* weights, int taps);
+
+// Passada vertical de uma linha de saída: combina as linhas rows[0..taps) byte a byte
+using ColumnKernel = void (*)(const uint8_t* const* rows, const int16_t* weights, int taps,
+                              uint8_t* dst, int row_bytes);
+
+void resampleRowScalar(const uint8_t* src, uint8_t* dst, int out_width, int channels,
+                       const int* start, const int16_t* weights, int taps);
+void resampleColumnScalar(const uint8_t* const* rows, const int16_t* weights, int taps,
+                          uint8_t* dst, int row_bytes);
+
+#if defined(__x86_64__) || defined(__i386__)
+void resampleRowSse41(const uint8_t* src, uint8_t* dst, int out_width, int channels,
+                      const int* start, const int16_t* weights, int taps);
+void resampleColumnSse41(const uint8_t* const* rows, const int16_t* weights, int taps,
+                         uint8_t* dst, int row_bytes);
+void resampleRowAvx2(const uint8_t* src, uint8_t* dst, int out_width, int channels,
+                     const int* start, const int16_t* weights, int taps);
+void resampleColumnAvx2(const uint8_t* const* rows, const int16_t* weights, int taps,
+                        uint8_t* dst, int row_bytes);
+#endif
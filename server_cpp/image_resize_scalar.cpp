@@ -0,0 +1,31 @@
+#include "image_resize_kernels.h"
+
+namespace {
+
+inline uint8_t clampToByte(int32_t value) {
+    return static_cast<uint8_t>(value < 0 ? 0 : (value > 255 ? 255 : value));
+}
+
+} // namespace
+
+void resampleRowScalar(const uint8_t* src, uint8_t* dst, int out_width, int channels,
+                       const int* start, const int16_t* weights, int taps) {
+    for (int x = 0; x < out_width; ++x) {
+        const uint8_t* in = src + start[x] * channels;
+        const int16_t* w = weights + x * taps;
+        for (int c = 0; c < channels; ++c) {
+            int32_t sum = 1 << (kWeightBits - 1);
+            for (int k = 0; k < taps; ++k) sum += w[k] * in[k * channels + c];
+            dst[x * channels + c] = clampToByte(sum >> kWeightBits);
+        }
+    }
+}
+
+void resampleColumnScalar(const uint8_t* const* rows, const int16_t* weights, int taps,
+                          uint8_t* dst, int row_bytes) {
+    for (int i = 0; i < row_bytes; ++i) {
+        int32_t sum = 1 << (kWeightBits - 1);
+        for (int k = 0; k < taps; ++k) sum += weights[k] * rows[k][i];
+        dst[i] = clampToByte(sum >> kWeightBits);
+    }
+}
@@ -0,0 +1,77 @@
+// Kernels SSE4.1: compilado com -msse4.1 e usado apenas quando a CPU suporta
+#include "image_resize_kernels.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+
+#include <cstring>
+#include <smmintrin.h>
+
+namespace {
+
+// Par de pesos (w[k], w[k+1]) repetido nos quatro inteiros de 32 bits, no formato do _mm_madd_epi16
+__m128i weightPair(const int16_t* weights) {
+    int32_t pair;
+    std::memcpy(&pair, weights, sizeof(pair));
+    return _mm_set1_epi32(pair);
+}
+
+void columnTail(const uint8_t* const* rows, const int16_t* weights, int taps, uint8_t* dst, int begin, int end) {
+    for (int i = begin; i < end; ++i) {
+        int32_t sum = 1 << (kWeightBits - 1);
+        for (int k = 0; k < taps; ++k) sum += weights[k] * rows[k][i];
+        sum >>= kWeightBits;
+        dst[i] = static_cast<uint8_t>(sum < 0 ? 0 : (sum > 255 ? 255 : sum));
+    }
+}
+
+} // namespace
+
+void resampleRowSse41(const uint8_t* src, uint8_t* dst, int out_width, int channels,
+                      const int* start, const int16_t* weights, int taps) {
+    // Intercala os canais de dois pixels vizinhos em int16 (r0 r1 g0 g1 b0 b1 a0 a1),
+    // de modo que um madd some os dois taps de cada canal
+    const __m128i shuffle = channels == 4
+        ? _mm_setr_epi8(0, -1, 4, -1, 1, -1, 5, -1, 2, -1, 6, -1, 3, -1, 7, -1)
+        : _mm_setr_epi8(0, -1, 3, -1, 1, -1, 4, -1, 2, -1, 5, -1, -1, -1, -1, -1);
+    const __m128i half = _mm_set1_epi32(1 << (kWeightBits - 1));
+
+    for (int x = 0; x < out_width; ++x) {
+        const uint8_t* in = src + start[x] * channels;
+        const int16_t* w = weights + x * taps;
+        __m128i sum = half;
+        for (int k = 0; k < taps; k += 2) {
+            __m128i pixels = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(in + k * channels));
+            pixels = _mm_shuffle_epi8(pixels, shuffle);
+            sum = _mm_add_epi32(sum, _mm_madd_epi16(pixels, weightPair(w + k)));
+        }
+        sum = _mm_srai_epi32(sum, kWeightBits);
+        __m128i words = _mm_packs_epi32(sum, sum);
+        __m128i packed = _mm_packus_epi16(words, words);
+        int32_t out = _mm_cvtsi128_si32(packed);
+        std::memcpy(dst + x * channels, &out, channels);
+    }
+}
+
+void resampleColumnSse41(const uint8_t* const* rows, const int16_t* weights, int taps,
+                         uint8_t* dst, int row_bytes) {
+    const __m128i half = _mm_set1_epi32(1 << (kWeightBits - 1));
+    int i = 0;
+    for (; i + 8 <= row_bytes; i += 8) {
+        __m128i low = half;
+        __m128i high = half;
+        for (int k = 0; k < taps; k += 2) {
+            __m128i a = _mm_cvtepu8_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(rows[k] + i)));
+            __m128i b = _mm_cvtepu8_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(rows[k + 1] + i)));
+            __m128i w = weightPair(weights + k);
+            low = _mm_add_epi32(low, _mm_madd_epi16(_mm_unpacklo_epi16(a, b), w));
+            high = _mm_add_epi32(high, _mm_madd_epi16(_mm_unpackhi_epi16(a, b), w));
+        }
+        low = _mm_srai_epi32(low, kWeightBits);
+        high = _mm_srai_epi32(high, kWeightBits);
+        __m128i words = _mm_packs_epi32(low, high);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(words, words));
+    }
+    columnTail(rows, weights, taps, dst, i, row_bytes);
+}
+
+#endif
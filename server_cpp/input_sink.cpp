@@ -0,0 +1,172 @@
+#include "input_sink.h"
+
+#include <cerrno>
+#include <fcntl.h>
+#include <future>
+#include <unistd.h>
+
+#include "process_supervisor.h"
+
+namespace {
+
+class SpoolSink : public InputSink {
+public:
+    // O descritor não é herdado pelas ferramentas iniciadas por outras chamadas (O_CLOEXEC)
+    SpoolSink(const std::string& path, std::function<int()> process)
+        : fd_(::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600)), process_(std::move(process)) {}
+
+    ~SpoolSink() override {
+        if (fd_ >= 0) close(fd_);
+    }
+
+    bool isOpen() const { return fd_ >= 0; }
+
+    bool write(const char* data, size_t size) override {
+        while (size > 0) {
+            ssize_t written = ::write(fd_, data, size);
+            if (written < 0) {
+                if (errno == EINTR) continue;
+                failed_ = true;
+                return false;
+            }
+            data += written;
+            size -= static_cast<size_t>(written);
+        }
+        return true;
+    }
+
+    bool failed() const override { return failed_; }
+
+    int finish() override {
+        // Um erro no close (ex.: NFS, cota) também significa que a entrada pode estar incompleta
+        int result = close(fd_);
+        fd_ = -1;
+        if (result != 0 || failed_) {
+            failed_ = true;
+            return -1;
+        }
+        return run();
+    }
+
+protected:
+    virtual int run() { return process_(); }
+
+private:
+    int fd_;
+    bool failed_ = false;
+    std::function<int()> process_;
+};
+
+// Spool seguido de uma ferramenta externa, da qual guarda o resultado
+class CommandSpoolSink : public SpoolSink {
+public:
+    CommandSpoolSink(const std::string& path, const std::vector<std::string>& argv)
+        : SpoolSink(path, nullptr), argv_(argv) {}
+
+    const ProcessResult* toolResult() const override { return &result_; }
+
+protected:
+    int run() override {
+        result_ = ProcessSupervisor::instance().spawn(argv_).get();
+        return result_.status();
+    }
+
+private:
+    std::vector<std::string> argv_;
+    ProcessResult result_;
+};
+
+class MemorySink : public InputSink {
+public:
+    explicit MemorySink(std::string& buffer) : buffer_(buffer) {}
+
+    bool write(const char* data, size_t size) override {
+        buffer_.append(data, size);
+        return true;
+    }
+
+    int finish() override { return 0; }
+
+private:
+    std::string& buffer_;
+};
+
+class PipeSink : public InputSink {
+public:
+    explicit PipeSink(const std::vector<std::string>& argv) : argv_(argv) {}
+
+    ~PipeSink() override {
+        if (write_fd_ >= 0) {
+            close(write_fd_);
+            exit_.wait();
+        }
+    }
+
+    bool write(const char* data, size_t size) override {
+        // A ferramenta só é iniciada quando o primeiro chunk chega
+        if (write_fd_ < 0 && !start()) return false;
+        while (size > 0) {
+            ssize_t written = ::write(write_fd_, data, size);
+            if (written < 0) {
+                if (errno == EINTR) continue;
+                return false; // EPIPE: a ferramenta encerrou sem ler o restante
+            }
+            data += written;
+            size -= static_cast<size_t>(written);
+        }
+        return true;
+    }
+
+    int finish() override {
+        if (write_fd_ < 0 && !start()) return -1;
+        close(write_fd_);
+        write_fd_ = -1;
+        result_ = exit_.get();
+        return result_.status();
+    }
+
+    bool mayBlock() const override { return true; }
+
+    const ProcessResult* toolResult() const override { return &result_; }
+
+private:
+    bool start() {
+        int fds[2];
+        if (pipe2(fds, O_CLOEXEC) != 0) return false;
+
+        SpawnOptions options;
+        options.stdin_fd = fds[0];
+        exit_ = ProcessSupervisor::instance().spawn(argv_, options);
+        // O filho já tem sua cópia da ponta de leitura
+        close(fds[0]);
+        write_fd_ = fds[1];
+        return true;
+    }
+
+    std::vector<std::string> argv_;
+    int write_fd_ = -1;
+    std::future<ProcessResult> exit_;
+    ProcessResult result_;
+};
+
+} // namespace
+
+std::unique_ptr<InputSink> openSpoolSink(const std::string& path, std::function<int()> process) {
+    auto sink = std::make_unique<SpoolSink>(path, std::move(process));
+    if (!sink->isOpen()) return nullptr;
+    return sink;
+}
+
+std::unique_ptr<InputSink> openSpoolSink(const std::string& path, const std::vector<std::string>& argv) {
+    auto sink = std::make_unique<CommandSpoolSink>(path, argv);
+    if (!sink->isOpen()) return nullptr;
+    return sink;
+}
+
+std::unique_ptr<InputSink> openMemorySink(std::string& buffer) {
+    return std::make_unique<MemorySink>(buffer);
+}
+
+std::unique_ptr<InputSink> openPipeSink(const std::vector<std::string>& argv) {
+    return std::make_unique<PipeSink>(argv);
+}
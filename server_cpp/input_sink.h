@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "process_supervisor.h"
+
+// Destino dos bytes recebidos do cliente. A ferramenta externa é executada
+// ao final do upload (spool) ou já durante ele (pipe).
+class InputSink {
+public:
+    virtual ~InputSink() = default;
+
+    // Grava um pedaço da entrada. Retorna false se o destino não aceita mais dados
+    // (ex.: a ferramenta terminou antes de consumir todo o stdin).
+    virtual bool write(const char* data, size_t size) = 0;
+
+    // Encerra a entrada, aguarda a ferramenta e retorna seu código (0 = sucesso)
+    virtual int finish() = 0;
+
+    // Se uma escrita ou o encerramento da entrada falhou (ex.: disco cheio). Diferente de write()
+    // retornar false porque a ferramenta parou de ler: aqui a entrada ficou incompleta e nada do
+    // que for produzido a partir dela pode ser usado.
+    virtual bool failed() const { return false; }
+
+    // Indica se write() pode bloquear esperando a ferramenta consumir os dados (pipe).
+    // Nesse caso a escrita não deve rodar em uma thread de rede.
+    virtual bool mayBlock() const { return false; }
+
+    // Resultado da ferramenta externa (tempos e uso de CPU), conhecido depois de finish();
+    // nullptr se o processamento rodou dentro do servidor
+    virtual const ProcessResult* toolResult() const { return nullptr; }
+};
+
+// Grava a entrada em um arquivo e executa argv só depois do último chunk.
+// Usado para formatos que precisam de acesso aleatório (PDFs). Retorna nullptr se o arquivo não puder ser criado.
+std::unique_ptr<InputSink> openSpoolSink(const std::string& path, const std::vector<std::string>& argv);
+
+// Grava a entrada em um arquivo e chama process (que deve retornar 0 em caso de sucesso)
+// depois do último chunk. Usado pelos motores que rodam dentro do próprio servidor.
+std::unique_ptr<InputSink> openSpoolSink(const std::string& path, std::function<int()> process);
+
+// Acumula a entrada em buffer (motores que decodificam direto da memória). finish() sempre retorna 0.
+std::unique_ptr<InputSink> openMemorySink(std::string& buffer);
+
+// Inicia argv quando o primeiro chunk chega e repassa os chunks pelo stdin,
+// sobrepondo a transferência de rede com o processamento.
+std::unique_ptr<InputSink> openPipeSink(const std::vector<std::string>& argv);
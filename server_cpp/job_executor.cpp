@@ -0,0 +1,83 @@
+#include "job_executor.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+JobExecutor::JobExecutor(size_t workers) {
+    if (workers == 0) workers = std::max(1u, std::thread::hardware_concurrency());
+    threads_.reserve(workers);
+    for (size_t i = 0; i < workers; ++i) {
+        threads_.emplace_back([this]() { run(); });
+    }
+}
+
+JobExecutor::~JobExecutor() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    ready_.notify_all();
+    for (auto& thread : threads_) thread.join();
+}
+
+void JobExecutor::post(std::function<void()> job) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queue_.push_back(std::move(job));
+    }
+    ready_.notify_one();
+}
+
+void JobExecutor::parallelFor(size_t count, size_t parallelism, const std::function<void(size_t)>& body) {
+    if (count == 0) return;
+    if (parallelism == 0 || parallelism > threads_.size() + 1) parallelism = threads_.size() + 1;
+    parallelism = std::min(parallelism, count);
+
+    // Os ajudantes podem começar depois que a chamada já terminou (todos os índices feitos pela
+    // thread que chamou); por isso o estado é compartilhado e body só é usado enquanto há índices
+    struct Shared {
+        const std::function<void(size_t)>* body;
+        size_t count;
+        std::atomic<size_t> next{0};
+        std::mutex mutex;
+        std::condition_variable finished;
+        size_t done = 0;
+    };
+    auto shared = std::make_shared<Shared>();
+    shared->body = &body;
+    shared->count = count;
+
+    auto work = [shared]() {
+        size_t index;
+        while ((index = shared->next.fetch_add(1)) < shared->count) {
+            (*shared->body)(index);
+            std::lock_guard<std::mutex> lock(shared->mutex);
+            if (++shared->done == shared->count) shared->finished.notify_all();
+        }
+    };
+    for (size_t i = 1; i < parallelism; ++i) post(work);
+    work();
+
+    std::unique_lock<std::mutex> lock(shared->mutex);
+    shared->finished.wait(lock, [&shared]() { return shared->done == shared->count; });
+}
+
+size_t JobExecutor::pending() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return queue_.size();
+}
+
+void JobExecutor::run() {
+    while (true) {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            ready_.wait(lock, [this]() { return stopping_ || !queue_.empty(); });
+            if (queue_.empty()) return;
+            job = std::move(queue_.front());
+            queue_.pop_front();
+        }
+        job();
+    }
+}
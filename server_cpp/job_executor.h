@@ -0,0 +1,47 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Pool de threads de tamanho fixo para o trabalho pesado das requisições (ferramentas externas,
+// motores internos, escrita em pipes). As threads de rede do gRPC só recebem e enviam chunks
+// e entregam o restante a este pool, de modo que o número de threads não depende do número
+// de conexões abertas.
+class JobExecutor {
+public:
+    // workers == 0 usa o número de CPUs
+    explicit JobExecutor(size_t workers);
+
+    // Conclui os jobs já enfileirados e encerra as threads
+    ~JobExecutor();
+
+    // Enfileira job para execução em uma das threads do pool
+    void post(std::function<void()> job);
+
+    // Executa body(0) ... body(count - 1) em até parallelism threads (0 = todas) e retorna quando
+    // todos terminarem. A thread que chama também executa índices, então a chamada pode ser feita
+    // de dentro de um job do próprio pool sem risco de esperar por threads que estão ocupadas.
+    void parallelFor(size_t count, size_t parallelism, const std::function<void(size_t)>& body);
+
+    size_t workers() const { return threads_.size(); }
+
+    // Jobs aguardando uma thread livre
+    size_t pending();
+
+    JobExecutor(const JobExecutor&) = delete;
+    JobExecutor& operator=(const JobExecutor&) = delete;
+
+private:
+    void run();
+
+    std::mutex mutex_;
+    std::condition_variable ready_;
+    std::deque<std::function<void()>> queue_;
+    bool stopping_ = false;
+    std::vector<std::thread> threads_;
+};
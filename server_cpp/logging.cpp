@@ -0,0 +1,280 @@
+#include "logging.h"
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <ctime>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+
+// Intervalo máximo entre uma mensagem enfileirada e a sua gravação
+const std::chrono::milliseconds kFlushInterval(50);
+
+struct LogEntry {
+    std::chrono::system_clock::time_point time;
+    std::string service;
+    std::string status;
+    std::string message;
+};
+
+// Fila circular limitada com vários produtores e um consumidor, sem locks (algoritmo de
+// D. Vyukov): cada posição tem um número de sequência que indica se ela está livre para o
+// produtor da volta atual ou pronta para o consumidor.
+class LogRing {
+public:
+    explicit LogRing(size_t capacity) {
+        size_t size = 2;
+        while (size < capacity) size <<= 1;
+        mask_ = size - 1;
+        cells_.reset(new Cell[size]);
+        for (size_t i = 0; i < size; ++i) cells_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    // Retorna false se a fila estiver cheia
+    bool push(LogEntry&& entry) {
+        size_t position = enqueue_.load(std::memory_order_relaxed);
+        Cell* cell;
+        while (true) {
+            cell = &cells_[position & mask_];
+            size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+            if (diff == 0) {
+                if (enqueue_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) break;
+            } else if (diff < 0) {
+                return false;
+            } else {
+                position = enqueue_.load(std::memory_order_relaxed);
+            }
+        }
+        cell->entry = std::move(entry);
+        cell->sequence.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Só o flusher consome
+    bool pop(LogEntry& entry) {
+        Cell& cell = cells_[dequeue_ & mask_];
+        size_t sequence = cell.sequence.load(std::memory_order_acquire);
+        if (static_cast<intptr_t>(sequence) - static_cast<intptr_t>(dequeue_ + 1) < 0) return false;
+        entry = std::move(cell.entry);
+        cell.sequence.store(dequeue_ + mask_ + 1, std::memory_order_release);
+        ++dequeue_;
+        return true;
+    }
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        LogEntry entry;
+    };
+
+    std::unique_ptr<Cell[]> cells_;
+    size_t mask_ = 0;
+    alignas(64) std::atomic<size_t> enqueue_{0};
+    alignas(64) size_t dequeue_ = 0;
+};
+
+// Formata "AAAA-MM-DD HH:MM:SS" com localtime_r, reaproveitando o texto dentro do mesmo segundo
+class TimestampCache {
+public:
+    const std::string& format(std::chrono::system_clock::time_point time) {
+        time_t seconds = std::chrono::system_clock::to_time_t(time);
+        if (seconds != seconds_ || text_.empty()) {
+            std::tm local_time;
+            localtime_r(&seconds, &local_time);
+            char buffer[32];
+            std::strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S", &local_time);
+            text_ = buffer;
+            seconds_ = seconds;
+        }
+        return text_;
+    }
+
+private:
+    time_t seconds_ = 0;
+    std::string text_;
+};
+
+LogLevel levelOf(const std::string& status) {
+    if (status == "ERROR") return LogLevel::Error;
+    if (status == "WARNING") return LogLevel::Warning;
+    if (status == "DEBUG") return LogLevel::Debug;
+    return LogLevel::Info;
+}
+
+class Logger {
+public:
+    explicit Logger(const LogOptions& options) : options_(options), ring_(options.queue_size) {
+        if (!options_.file.empty()) {
+            fd_ = open(options_.file.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+        }
+        flusher_ = std::thread([this]() { flushLoop(); });
+    }
+
+    ~Logger() {
+        stopping_ = true;
+        wake_.notify_one();
+        flusher_.join();
+        if (fd_ >= 0) close(fd_);
+    }
+
+    bool enabled(LogLevel level) const { return level >= options_.level; }
+
+    void log(LogEntry&& entry) {
+        if (!ring_.push(std::move(entry))) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        if (idle_.load(std::memory_order_relaxed)) wake_.notify_one();
+    }
+
+    LogStats stats() const {
+        LogStats stats;
+        stats.written = written_.load(std::memory_order_relaxed);
+        stats.dropped = dropped_.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+private:
+    void flushLoop() {
+        std::mutex mutex;
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            bool stopping = stopping_;
+            drain();
+            if (stopping) return;
+            idle_ = true;
+            // Sem lock do lado dos produtores, um aviso pode se perder; o timeout limita a espera
+            wake_.wait_for(lock, kFlushInterval);
+            idle_ = false;
+        }
+    }
+
+    // Formata tudo o que está na fila e grava em uma única escrita por destino
+    void drain() {
+        std::string batch;
+        LogEntry entry;
+        uint64_t count = 0;
+        while (ring_.pop(entry)) {
+            appendLine(batch, entry.time, entry.service, entry.status, entry.message);
+            ++count;
+        }
+
+        uint64_t dropped = dropped_.load(std::memory_order_relaxed);
+        if (dropped != reported_dropped_) {
+            appendLine(batch, std::chrono::system_clock::now(), "Logger", "WARNING",
+                       std::to_string(dropped - reported_dropped_) + " mensagens descartadas com a fila de log cheia.");
+            reported_dropped_ = dropped;
+        }
+        if (batch.empty()) return;
+
+        if (fd_ >= 0) writeAll(fd_, batch);
+        if (options_.to_stdout) {
+            std::fwrite(batch.data(), 1, batch.size(), stdout);
+            std::fflush(stdout);
+        }
+        written_.fetch_add(count, std::memory_order_relaxed);
+    }
+
+    void appendLine(std::string& batch, std::chrono::system_clock::time_point time, const std::string& service,
+                    const std::string& status, const std::string& message) {
+        batch += '[';
+        batch += timestamps_.format(time);
+        batch += "] [";
+        batch += service;
+        batch += "] [";
+        batch += status;
+        batch += "] ";
+        batch += message;
+        batch += '\n';
+    }
+
+    static void writeAll(int fd, const std::string& data) {
+        const char* cursor = data.data();
+        size_t remaining = data.size();
+        while (remaining > 0) {
+            ssize_t written = write(fd, cursor, remaining);
+            if (written < 0) {
+                if (errno == EINTR) continue;
+                return;
+            }
+            cursor += written;
+            remaining -= static_cast<size_t>(written);
+        }
+    }
+
+    LogOptions options_;
+    LogRing ring_;
+    int fd_ = -1;
+    TimestampCache timestamps_;
+    std::atomic<uint64_t> written_{0};
+    std::atomic<uint64_t> dropped_{0};
+    uint64_t reported_dropped_ = 0;
+    std::atomic<bool> idle_{false};
+    std::atomic<bool> stopping_{false};
+    std::condition_variable wake_;
+    std::thread flusher_;
+};
+
+std::once_flag logger_once;
+std::unique_ptr<Logger> logger_instance;
+
+Logger& logger(const LogOptions& options = LogOptions()) {
+    std::call_once(logger_once, [&options]() { logger_instance.reset(new Logger(options)); });
+    return *logger_instance;
+}
+
+} // namespace
+
+bool configureLogging(const LogOptions& options) {
+    bool configured = false;
+    std::call_once(logger_once, [&]() {
+        logger_instance.reset(new Logger(options));
+        configured = true;
+    });
+    return configured;
+}
+
+bool parseLogLevel(const std::string& name, LogLevel& level) {
+    if (name == "debug") {
+        level = LogLevel::Debug;
+    } else if (name == "info") {
+        level = LogLevel::Info;
+    } else if (name == "warning") {
+        level = LogLevel::Warning;
+    } else if (name == "error") {
+        level = LogLevel::Error;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool logEnabled(LogLevel level) {
+    return logger().enabled(level);
+}
+
+// Função para obter o timestamp atual formatado
+std::string getCurrentTimestamp() {
+    TimestampCache cache;
+    return cache.format(std::chrono::system_clock::now());
+}
+
+// Função de logging
+void logOperation(const std::string& service_name, const std::string& status, const std::string& message) {
+    Logger& log = logger();
+    if (!log.enabled(levelOf(status))) return;
+    log.log(LogEntry{std::chrono::system_clock::now(), service_name, status, message});
+}
+
+LogStats logStats() {
+    return logger().stats();
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+enum class LogLevel { Debug, Info, Warning, Error };
+
+struct LogOptions {
+    LogLevel level = LogLevel::Info;
+    std::string file = "server.log"; // vazio = só a saída padrão
+    bool to_stdout = true;
+    size_t queue_size = 8192;        // entradas na fila; arredondado para potência de 2
+};
+
+struct LogStats {
+    uint64_t written = 0; // linhas gravadas pelo flusher
+    uint64_t dropped = 0; // linhas descartadas com a fila cheia
+};
+
+// Inicia o logger com options. Deve ser chamado antes da primeira mensagem; depois disso
+// (ou se nunca for chamado) vale a configuração padrão. Retorna false se já estava iniciado.
+bool configureLogging(const LogOptions& options);
+
+// Converte "debug", "info", "warning" ou "error" no nível correspondente
+bool parseLogLevel(const std::string& name, LogLevel& level);
+
+// Indica se mensagens de level seriam registradas (para evitar montar mensagens caras à toa)
+bool logEnabled(LogLevel level);
+
+// Timestamp atual no formato "AAAA-MM-DD HH:MM:SS"
+std::string getCurrentTimestamp();
+
+// Registra uma operação no log. A chamada só enfileira a mensagem: o arquivo e a saída padrão
+// são escritos em lotes por uma thread própria. status define o nível ("DEBUG", "INFO",
+// "SUCCESS", "WARNING" ou "ERROR"). Com a fila cheia a mensagem é descartada e contada.
+void logOperation(const std::string& service_name, const std::string& status, const std::string& message);
+
+LogStats logStats();
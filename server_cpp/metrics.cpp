@@ -0,0 +1,282 @@
+#include "metrics.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+#include "file_processor.pb.h"
+
+namespace {
+
+const char* const kStatusCodeNames[MethodMetrics::kStatusCodes] = {
+    "OK", "CANCELLED", "UNKNOWN", "INVALID_ARGUMENT", "DEADLINE_EXCEEDED", "NOT_FOUND",
+    "ALREADY_EXISTS", "PERMISSION_DENIED", "RESOURCE_EXHAUSTED", "FAILED_PRECONDITION", "ABORTED",
+    "OUT_OF_RANGE", "UNIMPLEMENTED", "INTERNAL", "UNAVAILABLE", "DATA_LOSS", "UNAUTHENTICATED",
+};
+
+// Limites ("le") dos histogramas exportados, em µs: potências de 4 de 128 µs a ~9 minutos.
+// Por serem potências de 2, coincidem com bordas de faixas do LatencyHistogram.
+const uint64_t kExportBounds[] = {
+    1ull << 7, 1ull << 9, 1ull << 11, 1ull << 13, 1ull << 15, 1ull << 17,
+    1ull << 19, 1ull << 21, 1ull << 23, 1ull << 25, 1ull << 27, 1ull << 29,
+};
+
+uint64_t toMicros(std::chrono::steady_clock::duration duration) {
+    auto micros = std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+    return micros < 0 ? 0 : static_cast<uint64_t>(micros);
+}
+
+uint64_t toMicros(const struct timeval& time) {
+    return static_cast<uint64_t>(time.tv_sec) * 1000000 + static_cast<uint64_t>(time.tv_usec);
+}
+
+std::string formatNumber(double value) {
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%.9g", value);
+    return buffer;
+}
+
+double seconds(uint64_t micros) { return static_cast<double>(micros) / 1e6; }
+double millis(uint64_t micros) { return static_cast<double>(micros) / 1e3; }
+
+// Monta o texto de exposição: cada família tem HELP e TYPE seguidos de todas as suas amostras
+class PrometheusWriter {
+public:
+    void family(const std::string& name, const char* type, const char* help) {
+        text_ += "# HELP " + name + " " + help + "\n";
+        text_ += "# TYPE " + name + " " + type + "\n";
+    }
+
+    void sample(const std::string& name, const std::string& labels, const std::string& value) {
+        text_ += name;
+        if (!labels.empty()) text_ += "{" + labels + "}";
+        text_ += " " + value + "\n";
+    }
+
+    void sample(const std::string& name, const std::string& labels, uint64_t value) {
+        sample(name, labels, std::to_string(value));
+    }
+
+    void histogram(const std::string& name, const std::string& labels, const LatencyHistogram::Snapshot& snapshot) {
+        std::string prefix = labels.empty() ? "" : labels + ",";
+        for (uint64_t bound : kExportBounds) {
+            sample(name + "_bucket", prefix + "le=\"" + formatNumber(seconds(bound)) + "\"", snapshot.countBelow(bound));
+        }
+        sample(name + "_bucket", prefix + "le=\"+Inf\"", snapshot.count);
+        sample(name + "_sum", labels, formatNumber(seconds(snapshot.sum_us)));
+        sample(name + "_count", labels, snapshot.count);
+    }
+
+    std::string str() { return std::move(text_); }
+
+private:
+    std::string text_;
+};
+
+std::string methodLabel(const MethodMetrics& method) { return "method=\"" + method.method + "\""; }
+
+} // namespace
+
+const char* stageName(Stage stage) {
+    switch (stage) {
+        case Stage::Queue: return "queue";
+        case Stage::Upload: return "upload";
+        case Stage::InputWrite: return "input_write";
+        case Stage::Process: return "process";
+        case Stage::Send: return "send";
+        case Stage::Total: return "total";
+    }
+    return "unknown";
+}
+
+size_t LatencyHistogram::bucketOf(uint64_t value_us) {
+    if (value_us < kSubBuckets) return static_cast<size_t>(value_us);
+    size_t msb = 63 - static_cast<size_t>(__builtin_clzll(value_us));
+    size_t shift = msb - 4; // value_us >> shift fica entre 16 e 31
+    if (shift > kMaxShift) return kBucketCount - 1;
+    return (shift + 1) * kSubBuckets + static_cast<size_t>((value_us >> shift) - kSubBuckets);
+}
+
+uint64_t LatencyHistogram::bucketUpper(size_t index) {
+    if (index < kSubBuckets) return index;
+    size_t shift = index / kSubBuckets - 1;
+    uint64_t lower = static_cast<uint64_t>(kSubBuckets + index % kSubBuckets) << shift;
+    return lower + (1ull << shift) - 1;
+}
+
+void LatencyHistogram::record(std::chrono::steady_clock::duration duration) {
+    uint64_t micros = toMicros(duration);
+    counts_[bucketOf(micros)].fetch_add(1, std::memory_order_relaxed);
+    sum_us_.fetch_add(micros, std::memory_order_relaxed);
+    uint64_t max = max_us_.load(std::memory_order_relaxed);
+    while (micros > max && !max_us_.compare_exchange_weak(max, micros, std::memory_order_relaxed)) {
+    }
+}
+
+LatencyHistogram::Snapshot LatencyHistogram::snapshot() const {
+    Snapshot snapshot;
+    snapshot.counts.resize(kBucketCount);
+    for (size_t i = 0; i < kBucketCount; ++i) {
+        snapshot.counts[i] = counts_[i].load(std::memory_order_relaxed);
+        snapshot.count += snapshot.counts[i];
+    }
+    snapshot.sum_us = sum_us_.load(std::memory_order_relaxed);
+    snapshot.max_us = max_us_.load(std::memory_order_relaxed);
+    return snapshot;
+}
+
+uint64_t LatencyHistogram::Snapshot::percentile(double q) const {
+    if (count == 0) return 0;
+    uint64_t target = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(q * static_cast<double>(count))));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < counts.size(); ++i) {
+        seen += counts[i];
+        if (seen >= target) return std::min(bucketUpper(i), max_us);
+    }
+    return max_us;
+}
+
+uint64_t LatencyHistogram::Snapshot::countBelow(uint64_t limit_us) const {
+    uint64_t below = 0;
+    for (size_t i = 0; i < counts.size() && bucketUpper(i) < limit_us; ++i) below += counts[i];
+    return below;
+}
+
+void MethodMetrics::finished(int status_code) {
+    if (status_code < 0 || static_cast<size_t>(status_code) >= kStatusCodes) status_code = 2; // UNKNOWN
+    status_codes[static_cast<size_t>(status_code)].fetch_add(1, std::memory_order_relaxed);
+}
+
+void MethodMetrics::addToolUsage(const struct rusage& usage) {
+    tool_user_us.fetch_add(toMicros(usage.ru_utime), std::memory_order_relaxed);
+    tool_system_us.fetch_add(toMicros(usage.ru_stime), std::memory_order_relaxed);
+}
+
+ServerMetrics::ServerMetrics(const std::vector<std::string>& methods) {
+    for (const auto& name : methods) methods_.push_back(std::make_unique<MethodMetrics>(name));
+}
+
+MethodMetrics* ServerMetrics::method(const std::string& name) {
+    for (auto& method : methods_) {
+        if (method->method == name) return method.get();
+    }
+    return nullptr;
+}
+
+std::string ServerMetrics::renderPrometheus(const RuntimeStats& runtime) const {
+    PrometheusWriter out;
+
+    out.family("fileproc_requests_total", "counter", "Chamadas encerradas, por método e código de status.");
+    for (const auto& method : methods_) {
+        for (size_t code = 0; code < MethodMetrics::kStatusCodes; ++code) {
+            uint64_t count = method->status_codes[code].load(std::memory_order_relaxed);
+            if (count > 0) out.sample("fileproc_requests_total", methodLabel(*method) + ",code=\"" + kStatusCodeNames[code] + "\"", count);
+        }
+    }
+
+    out.family("fileproc_stage_duration_seconds", "histogram", "Duração de cada etapa das chamadas.");
+    for (const auto& method : methods_) {
+        for (size_t stage = 0; stage < kStageCount; ++stage) {
+            out.histogram("fileproc_stage_duration_seconds",
+                          methodLabel(*method) + ",stage=\"" + stageName(static_cast<Stage>(stage)) + "\"",
+                          method->stages[stage].snapshot());
+        }
+    }
+
+    out.family("fileproc_received_bytes_total", "counter", "Bytes de entrada recebidos dos clientes.");
+    for (const auto& method : methods_) {
+        out.sample("fileproc_received_bytes_total", methodLabel(*method), method->bytes_received.load(std::memory_order_relaxed));
+    }
+    out.family("fileproc_sent_bytes_total", "counter", "Bytes de resultado enviados aos clientes.");
+    for (const auto& method : methods_) {
+        out.sample("fileproc_sent_bytes_total", methodLabel(*method), method->bytes_sent.load(std::memory_order_relaxed));
+    }
+
+    out.family("fileproc_tool_cpu_seconds_total", "counter", "CPU consumida pelas ferramentas externas (rusage do wait4).");
+    for (const auto& method : methods_) {
+        out.sample("fileproc_tool_cpu_seconds_total", methodLabel(*method) + ",mode=\"user\"",
+                   formatNumber(seconds(method->tool_user_us.load(std::memory_order_relaxed))));
+        out.sample("fileproc_tool_cpu_seconds_total", methodLabel(*method) + ",mode=\"system\"",
+                   formatNumber(seconds(method->tool_system_us.load(std::memory_order_relaxed))));
+    }
+
+    out.family("fileproc_in_flight", "gauge", "Chamadas admitidas e ainda em andamento.");
+    for (const auto& slots : runtime.admission) out.sample("fileproc_in_flight", "method=\"" + slots.first + "\"", slots.second.active);
+    out.family("fileproc_queued", "gauge", "Chamadas aguardando uma vaga no controle de admissão.");
+    for (const auto& slots : runtime.admission) out.sample("fileproc_queued", "method=\"" + slots.first + "\"", slots.second.queued);
+
+    out.family("fileproc_executor_workers", "gauge", "Threads do executor de processamento.");
+    out.sample("fileproc_executor_workers", "", runtime.workers);
+    out.family("fileproc_executor_pending", "gauge", "Jobs aguardando uma thread do executor.");
+    out.sample("fileproc_executor_pending", "", runtime.executor_pending);
+
+    out.family("fileproc_cache_hits_total", "counter", "Resultados servidos pelo cache.");
+    out.sample("fileproc_cache_hits_total", "tier=\"memory\"", runtime.cache.memory_hits);
+    out.sample("fileproc_cache_hits_total", "tier=\"disk\"", runtime.cache.disk_hits);
+    out.family("fileproc_cache_misses_total", "counter", "Consultas ao cache sem resultado.");
+    out.sample("fileproc_cache_misses_total", "", runtime.cache.misses);
+    out.family("fileproc_cache_bytes", "gauge", "Bytes ocupados pelo cache de resultados.");
+    out.sample("fileproc_cache_bytes", "tier=\"memory\"", runtime.cache.memory_bytes);
+    out.sample("fileproc_cache_bytes", "tier=\"disk\"", runtime.cache.disk_bytes);
+    out.family("fileproc_coalesced_total", "counter", "Chamadas atendidas com o resultado de outra idêntica em andamento.");
+    out.sample("fileproc_coalesced_total", "", runtime.coalesced);
+
+    out.family("fileproc_log_written_total", "counter", "Linhas gravadas no log.");
+    out.sample("fileproc_log_written_total", "", runtime.log.written);
+    out.family("fileproc_log_dropped_total", "counter", "Linhas descartadas com a fila de log cheia.");
+    out.sample("fileproc_log_dropped_total", "", runtime.log.dropped);
+
+    out.family("fileproc_traces_exported_total", "counter", "Rastros de chamadas gravados no arquivo de rastros.");
+    out.sample("fileproc_traces_exported_total", "", runtime.traces_exported);
+    out.family("fileproc_traces_dropped_total", "counter", "Rastros descartados com a fila do exportador cheia.");
+    out.sample("fileproc_traces_dropped_total", "", runtime.traces_dropped);
+
+    out.family("fileproc_uptime_seconds", "gauge", "Tempo desde a partida do servidor.");
+    out.sample("fileproc_uptime_seconds", "", formatNumber(std::chrono::duration<double>(runtime.uptime).count()));
+    return out.str();
+}
+
+void ServerMetrics::fillStatsReply(const RuntimeStats& runtime, file_processor::StatsReply& reply) const {
+    for (const auto& method : methods_) {
+        file_processor::MethodStats* stats = reply.add_methods();
+        stats->set_method(method->method);
+        auto slots = runtime.admission.find(method->method);
+        if (slots != runtime.admission.end()) {
+            stats->set_in_flight(slots->second.active);
+            stats->set_queued(slots->second.queued);
+        }
+        stats->set_bytes_received(method->bytes_received.load(std::memory_order_relaxed));
+        stats->set_bytes_sent(method->bytes_sent.load(std::memory_order_relaxed));
+        stats->set_tool_user_seconds(seconds(method->tool_user_us.load(std::memory_order_relaxed)));
+        stats->set_tool_system_seconds(seconds(method->tool_system_us.load(std::memory_order_relaxed)));
+        for (size_t code = 0; code < MethodMetrics::kStatusCodes; ++code) {
+            uint64_t count = method->status_codes[code].load(std::memory_order_relaxed);
+            if (count > 0) (*stats->mutable_status_codes())[kStatusCodeNames[code]] = count;
+        }
+        for (size_t stage = 0; stage < kStageCount; ++stage) {
+            LatencyHistogram::Snapshot snapshot = method->stages[stage].snapshot();
+            file_processor::StageStats* latency = stats->add_stages();
+            latency->set_stage(stageName(static_cast<Stage>(stage)));
+            latency->set_count(snapshot.count);
+            if (snapshot.count == 0) continue;
+            latency->set_mean_ms(millis(snapshot.sum_us) / static_cast<double>(snapshot.count));
+            latency->set_p50_ms(millis(snapshot.percentile(0.50)));
+            latency->set_p90_ms(millis(snapshot.percentile(0.90)));
+            latency->set_p99_ms(millis(snapshot.percentile(0.99)));
+            latency->set_p999_ms(millis(snapshot.percentile(0.999)));
+            latency->set_max_ms(millis(snapshot.max_us));
+        }
+    }
+
+    reply.set_workers(static_cast<uint32_t>(runtime.workers));
+    reply.set_executor_pending(runtime.executor_pending);
+    reply.set_cache_memory_hits(runtime.cache.memory_hits);
+    reply.set_cache_disk_hits(runtime.cache.disk_hits);
+    reply.set_cache_misses(runtime.cache.misses);
+    reply.set_cache_memory_bytes(runtime.cache.memory_bytes);
+    reply.set_cache_disk_bytes(runtime.cache.disk_bytes);
+    reply.set_coalesced(runtime.coalesced);
+    reply.set_log_written(runtime.log.written);
+    reply.set_log_dropped(runtime.log.dropped);
+    reply.set_uptime_seconds(std::chrono::duration<double>(runtime.uptime).count());
+}
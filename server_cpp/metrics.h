@@ -0,0 +1,124 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <sys/resource.h>
+
+#include "logging.h"
+#include "result_cache.h"
+
+namespace file_processor {
+class StatsReply;
+}
+
+// Etapas de uma chamada medidas separadamente
+enum class Stage {
+    Queue,      // espera por uma vaga no controle de admissão
+    Upload,     // do início da leitura ao último chunk recebido
+    InputWrite, // soma das escritas da entrada no destino (spool, pipe ou memória)
+    Process,    // ferramenta externa ou motor interno (inclui o texto enviado aos poucos)
+    Send,       // do primeiro chunk do resultado ao fim da chamada
+    Total,      // da chegada da chamada ao fim
+};
+constexpr size_t kStageCount = 6;
+
+const char* stageName(Stage stage);
+
+// Histograma de latência no estilo HDR: 16 faixas lineares dentro de cada potência de 2
+// (erro relativo abaixo de 6,25%), de 1 µs a cerca de 19 horas. record() só incrementa
+// contadores atômicos, sem lock, e pode ser chamado de qualquer thread.
+class LatencyHistogram {
+public:
+    static constexpr size_t kSubBuckets = 16;
+    static constexpr size_t kMaxShift = 36;
+    static constexpr size_t kBucketCount = (kMaxShift + 2) * kSubBuckets;
+
+    struct Snapshot {
+        std::vector<uint64_t> counts;
+        uint64_t count = 0;
+        uint64_t sum_us = 0;
+        uint64_t max_us = 0;
+
+        // Valor (em µs) abaixo do qual está a fração q das amostras
+        uint64_t percentile(double q) const;
+        // Amostras com menos de limit_us; exato quando limit_us é uma potência de 2
+        uint64_t countBelow(uint64_t limit_us) const;
+    };
+
+    void record(std::chrono::steady_clock::duration duration);
+    Snapshot snapshot() const;
+
+    static size_t bucketOf(uint64_t value_us);
+    // Maior valor que cai na faixa index
+    static uint64_t bucketUpper(size_t index);
+
+private:
+    std::array<std::atomic<uint64_t>, kBucketCount> counts_{};
+    std::atomic<uint64_t> sum_us_{0};
+    std::atomic<uint64_t> max_us_{0};
+};
+
+// Contadores de um método do serviço
+struct MethodMetrics {
+    static constexpr size_t kStatusCodes = 17; // grpc::StatusCode vai de OK (0) a UNAUTHENTICATED (16)
+
+    explicit MethodMetrics(std::string name) : method(std::move(name)) {}
+
+    void record(Stage stage, std::chrono::steady_clock::duration duration) {
+        stages[static_cast<size_t>(stage)].record(duration);
+    }
+    void finished(int status_code);
+    void addToolUsage(const struct rusage& usage);
+
+    const std::string method;
+    std::array<LatencyHistogram, kStageCount> stages;
+    std::array<std::atomic<uint64_t>, kStatusCodes> status_codes{};
+    std::atomic<uint64_t> bytes_received{0};
+    std::atomic<uint64_t> bytes_sent{0};
+    std::atomic<uint64_t> tool_user_us{0};   // CPU dos processos filhos (wait4), em modo usuário
+    std::atomic<uint64_t> tool_system_us{0}; // e em modo kernel
+};
+
+// Estado instantâneo dos componentes compartilhados, coletado a cada consulta
+struct RuntimeStats {
+    struct Slots {
+        size_t active = 0;
+        size_t queued = 0;
+    };
+    std::map<std::string, Slots> admission; // por método
+    size_t workers = 0;
+    size_t executor_pending = 0;
+    ResultCache::Stats cache;
+    uint64_t coalesced = 0;
+    LogStats log;
+    uint64_t traces_exported = 0;
+    uint64_t traces_dropped = 0;
+    std::chrono::steady_clock::duration uptime{};
+};
+
+// Métricas de todas as chamadas do servidor, por método. Os métodos são registrados na
+// construção e não mudam depois, então as consultas não precisam de lock.
+class ServerMetrics {
+public:
+    explicit ServerMetrics(const std::vector<std::string>& methods);
+
+    // nullptr se method não foi registrado
+    MethodMetrics* method(const std::string& name);
+
+    // Texto no formato de exposição do Prometheus (versão 0.0.4)
+    std::string renderPrometheus(const RuntimeStats& runtime) const;
+
+    // Resposta do GetStats, com percentis calculados a partir dos histogramas
+    void fillStatsReply(const RuntimeStats& runtime, file_processor::StatsReply& reply) const;
+
+private:
+    std::vector<std::unique_ptr<MethodMetrics>> methods_;
+};
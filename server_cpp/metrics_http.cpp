@@ -0,0 +1,150 @@
+#include "metrics_http.h"
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+
+#include <netdb.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+namespace {
+
+// Um coletor lento ou parado não pode prender a thread
+const int kIoTimeoutSeconds = 2;
+const size_t kMaxRequestSize = 8192;
+
+void sendAll(int fd, const std::string& data) {
+    const char* cursor = data.data();
+    size_t remaining = data.size();
+    while (remaining > 0) {
+        ssize_t sent = send(fd, cursor, remaining, MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EINTR) continue;
+            return;
+        }
+        cursor += sent;
+        remaining -= static_cast<size_t>(sent);
+    }
+}
+
+std::string response(const char* status, const char* content_type, const std::string& body) {
+    return std::string("HTTP/1.1 ") + status + "\r\nContent-Type: " + content_type +
+           "\r\nContent-Length: " + std::to_string(body.size()) + "\r\nConnection: close\r\n\r\n" + body;
+}
+
+} // namespace
+
+std::unique_ptr<MetricsHttpServer> MetricsHttpServer::start(const std::string& address, Render render, std::string& error) {
+    size_t colon = address.rfind(':');
+    if (colon == std::string::npos) {
+        error = "endereço sem porta: " + address;
+        return nullptr;
+    }
+    std::string host = address.substr(0, colon);
+    std::string port = address.substr(colon + 1);
+    if (host.size() >= 2 && host.front() == '[' && host.back() == ']') host = host.substr(1, host.size() - 2);
+
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE;
+    addrinfo* found = nullptr;
+    int lookup = getaddrinfo(host.empty() ? nullptr : host.c_str(), port.c_str(), &hints, &found);
+    if (lookup != 0) {
+        error = gai_strerror(lookup);
+        return nullptr;
+    }
+
+    int fd = -1;
+    for (addrinfo* candidate = found; candidate; candidate = candidate->ai_next) {
+        fd = socket(candidate->ai_family, candidate->ai_socktype | SOCK_CLOEXEC, candidate->ai_protocol);
+        if (fd < 0) continue;
+        int reuse = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+        if (bind(fd, candidate->ai_addr, candidate->ai_addrlen) == 0 && listen(fd, 16) == 0) break;
+        error = std::strerror(errno);
+        close(fd);
+        fd = -1;
+    }
+    freeaddrinfo(found);
+    if (fd < 0) return nullptr;
+
+    int wake_fd = eventfd(0, EFD_CLOEXEC);
+    if (wake_fd < 0) {
+        error = std::strerror(errno);
+        close(fd);
+        return nullptr;
+    }
+    return std::unique_ptr<MetricsHttpServer>(new MetricsHttpServer(fd, wake_fd, std::move(render)));
+}
+
+MetricsHttpServer::MetricsHttpServer(int listen_fd, int wake_fd, Render render)
+    : listen_fd_(listen_fd), wake_fd_(wake_fd), render_(std::move(render)) {
+    thread_ = std::thread([this]() { serveLoop(); });
+}
+
+MetricsHttpServer::~MetricsHttpServer() {
+    uint64_t one = 1;
+    ssize_t ignored = write(wake_fd_, &one, sizeof(one));
+    (void)ignored;
+    thread_.join();
+    close(listen_fd_);
+    close(wake_fd_);
+}
+
+void MetricsHttpServer::serveLoop() {
+    pollfd fds[2] = {{listen_fd_, POLLIN, 0}, {wake_fd_, POLLIN, 0}};
+    while (true) {
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) continue;
+            return;
+        }
+        if (fds[1].revents) return;
+        if (!(fds[0].revents & POLLIN)) continue;
+
+        int client = accept4(listen_fd_, nullptr, nullptr, SOCK_CLOEXEC);
+        if (client < 0) continue;
+        timeval timeout{kIoTimeoutSeconds, 0};
+        setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+        handle(client);
+        close(client);
+    }
+}
+
+// Lê só o cabeçalho da requisição: o corpo, se houver, é ignorado
+void MetricsHttpServer::handle(int fd) {
+    std::string request;
+    char buffer[1024];
+    while (request.find("\r\n\r\n") == std::string::npos && request.size() < kMaxRequestSize) {
+        ssize_t count = recv(fd, buffer, sizeof(buffer), 0);
+        if (count < 0 && errno == EINTR) continue;
+        if (count <= 0) return;
+        request.append(buffer, static_cast<size_t>(count));
+    }
+
+    size_t line_end = request.find("\r\n");
+    std::string line = request.substr(0, line_end);
+    bool is_get = line.compare(0, 4, "GET ") == 0;
+    bool is_head = line.compare(0, 5, "HEAD ") == 0;
+    if (!is_get && !is_head) {
+        sendAll(fd, response("405 Method Not Allowed", "text/plain; charset=utf-8", "Use GET /metrics\n"));
+        return;
+    }
+
+    size_t path_start = line.find(' ') + 1;
+    std::string path = line.substr(path_start, line.find(' ', path_start) - path_start);
+    path = path.substr(0, path.find('?'));
+    if (path != "/metrics" && path != "/") {
+        sendAll(fd, response("404 Not Found", "text/plain; charset=utf-8", "Use GET /metrics\n"));
+        return;
+    }
+
+    std::string reply = response("200 OK", "text/plain; version=0.0.4; charset=utf-8", render_());
+    if (is_head) reply = reply.substr(0, reply.find("\r\n\r\n") + 4);
+    sendAll(fd, reply);
+}
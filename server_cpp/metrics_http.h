@@ -0,0 +1,33 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+
+// Servidor HTTP mínimo que responde GET /metrics com o texto produzido por render, para
+// coleta pelo Prometheus. Atende uma conexão por vez em uma thread própria; não deve ser
+// exposto fora da máquina (o padrão é escutar só em 127.0.0.1).
+class MetricsHttpServer {
+public:
+    using Render = std::function<std::string()>;
+
+    // Abre address ("HOST:PORTA"). Retorna nullptr, com a causa em error, se não conseguir.
+    static std::unique_ptr<MetricsHttpServer> start(const std::string& address, Render render, std::string& error);
+
+    ~MetricsHttpServer();
+
+    MetricsHttpServer(const MetricsHttpServer&) = delete;
+    MetricsHttpServer& operator=(const MetricsHttpServer&) = delete;
+
+private:
+    MetricsHttpServer(int listen_fd, int wake_fd, Render render);
+
+    void serveLoop();
+    void handle(int fd);
+
+    int listen_fd_;
+    int wake_fd_;
+    Render render_;
+    std::thread thread_;
+};
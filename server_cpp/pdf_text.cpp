@@ -0,0 +1,123 @@
+#include "pdf_text.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <memory>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "process_supervisor.h"
+
+#ifdef HAVE_POPPLER_CPP
+#include <poppler/cpp/poppler-document.h>
+#include <poppler/cpp/poppler-page.h>
+#endif
+
+size_t TextLimit::fit(const char* text, size_t size) {
+    if (!limited_) return size;
+    for (size_t i = 0; i < size; ++i) {
+        unsigned char byte = static_cast<unsigned char>(text[i]);
+        if ((byte & 0xC0) == 0x80) {
+            // Continuação do caractere anterior: acompanha o que já foi aceito
+            if (continuation_ > 0) --continuation_;
+            continue;
+        }
+        if (remaining_ == 0) return i;
+        --remaining_;
+        continuation_ = byte >= 0xF0 ? 3 : byte >= 0xE0 ? 2 : byte >= 0xC0 ? 1 : 0;
+    }
+    return size;
+}
+
+bool pdfTextAvailable() {
+#ifdef HAVE_POPPLER_CPP
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool extractPdfText(const std::string& path, const PageTextCallback& on_page, std::string& error,
+                    int first_page, int last_page) {
+#ifdef HAVE_POPPLER_CPP
+    std::unique_ptr<poppler::document> document(poppler::document::load_from_file(path));
+    if (!document) {
+        error = "Não foi possível abrir o PDF.";
+        return false;
+    }
+    if (document->is_locked()) {
+        error = "PDF protegido por senha.";
+        return false;
+    }
+
+    int pages = document->pages();
+    // Como o pdftotext, uma primeira página além do fim é falha, não texto vazio
+    if (first_page > pages) {
+        error = "Página " + std::to_string(first_page) + " além do fim do documento.";
+        return false;
+    }
+    if (last_page > 0 && last_page < pages) pages = last_page;
+    for (int i = std::max(first_page, 1) - 1; i < pages; ++i) {
+        std::string text;
+        std::unique_ptr<poppler::page> page(document->create_page(i));
+        if (page) {
+            poppler::byte_array utf8 = page->text().to_utf8();
+            text.assign(utf8.begin(), utf8.end());
+        }
+        text += '\f';
+        if (!on_page(text)) {
+            error = "Extração interrompida na página " + std::to_string(i + 1) + ".";
+            return false;
+        }
+    }
+    return true;
+#else
+    (void)path;
+    (void)on_page;
+    (void)first_page;
+    (void)last_page;
+    error = "Servidor compilado sem a poppler-cpp (HAVE_POPPLER_CPP).";
+    return false;
+#endif
+}
+
+int pdfPageCount(const std::string& path, std::string& error) {
+#ifdef HAVE_POPPLER_CPP
+    std::unique_ptr<poppler::document> document(poppler::document::load_from_file(path));
+    if (!document || document->is_locked()) {
+        error = "Não foi possível abrir o PDF.";
+        return -1;
+    }
+    return document->pages();
+#else
+    // O pdfinfo vem no mesmo pacote do pdftotext; a contagem está na linha "Pages:"
+    int fds[2];
+    if (pipe2(fds, O_CLOEXEC) != 0) {
+        error = "Falha ao criar o pipe do pdfinfo.";
+        return -1;
+    }
+    SpawnOptions options;
+    options.stdout_fd = fds[1];
+    std::future<ProcessResult> exit = ProcessSupervisor::instance().spawn({"pdfinfo", path}, options);
+    close(fds[1]);
+
+    std::string output;
+    char buffer[4096];
+    while (true) {
+        ssize_t count = read(fds[0], buffer, sizeof(buffer));
+        if (count < 0 && errno == EINTR) continue;
+        if (count <= 0) break;
+        output.append(buffer, static_cast<size_t>(count));
+    }
+    close(fds[0]);
+    ProcessResult result = exit.get();
+
+    size_t line = output.find("Pages:");
+    if (!result.ok() || line == std::string::npos) {
+        error = "Falha na execução do pdfinfo. Código: " + std::to_string(result.status());
+        return -1;
+    }
+    return std::atoi(output.c_str() + line + 6);
+#endif
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+// Recebe o texto de uma página assim que ele é extraído. Retornar false interrompe a
+// extração (ex.: o cliente desconectou).
+using PageTextCallback = std::function<bool(const std::string& text)>;
+
+// Limite de caracteres do texto devolvido ao cliente. Conta caracteres UTF-8, não bytes, e
+// nunca corta um caractere ao meio, mesmo que ele chegue dividido entre dois blocos.
+class TextLimit {
+public:
+    // max_chars == 0 não limita
+    explicit TextLimit(uint64_t max_chars) : limited_(max_chars > 0), remaining_(max_chars) {}
+
+    // Quantos bytes do início de text ainda cabem no limite (descontados do que resta)
+    size_t fit(const char* text, size_t size);
+
+    // O limite foi atingido: nenhum byte a mais será aceito e a extração pode parar
+    bool reached() const { return limited_ && remaining_ == 0 && continuation_ == 0; }
+
+private:
+    bool limited_;
+    uint64_t remaining_;
+    int continuation_ = 0; // bytes que ainda faltam do último caractere aceito
+};
+
+// Indica se o servidor foi compilado com a poppler-cpp (HAVE_POPPLER_CPP)
+bool pdfTextAvailable();
+
+// Extrai o texto do PDF em path página por página, dentro do próprio processo, da página
+// first_page até last_page (numeradas a partir de 1; 0 = até a última). Cada página termina
+// com um form feed, como na saída do pdftotext.
+// Retorna false (com a causa em error) se o documento não puder ser aberto, se first_page
+// estiver além da última página ou se on_page interromper a extração.
+bool extractPdfText(const std::string& path, const PageTextCallback& on_page, std::string& error,
+                    int first_page = 1, int last_page = 0);
+
+// Número de páginas do PDF em path, lido pela poppler-cpp ou, sem ela, pelo pdfinfo.
+// Retorna -1 (com a causa em error) se o documento não puder ser aberto.
+int pdfPageCount(const std::string& path, std::string& error);
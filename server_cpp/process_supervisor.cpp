@@ -0,0 +1,172 @@
+#include "process_supervisor.h"
+
+#include <cerrno>
+#include <csignal>
+#include <fcntl.h>
+#include <spawn.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char** environ;
+
+namespace {
+
+int openPidfd(pid_t pid) {
+#ifdef SYS_pidfd_open
+    return static_cast<int>(syscall(SYS_pidfd_open, pid, 0));
+#else
+    errno = ENOSYS;
+    return -1;
+#endif
+}
+
+} // namespace
+
+ProcessSupervisor& ProcessSupervisor::instance() {
+    static ProcessSupervisor supervisor;
+    return supervisor;
+}
+
+ProcessSupervisor::ProcessSupervisor() {
+    epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+    wake_fd_ = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.fd = wake_fd_;
+    epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wake_fd_, &event);
+    reaper_ = std::thread(&ProcessSupervisor::reapLoop, this);
+}
+
+ProcessSupervisor::~ProcessSupervisor() {
+    uint64_t one = 1;
+    (void)::write(wake_fd_, &one, sizeof(one));
+    if (reaper_.joinable()) reaper_.join();
+    for (auto& entry : children_) close(entry.first);
+    close(wake_fd_);
+    close(epoll_fd_);
+}
+
+pid_t ProcessSupervisor::spawn(const std::vector<std::string>& argv, const SpawnOptions& options, ExitCallback on_exit) {
+    std::vector<char*> args;
+    for (const auto& arg : argv) args.push_back(const_cast<char*>(arg.c_str()));
+    args.push_back(nullptr);
+
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    if (options.stdin_fd >= 0) {
+        posix_spawn_file_actions_adddup2(&actions, options.stdin_fd, STDIN_FILENO);
+    } else {
+        posix_spawn_file_actions_addopen(&actions, STDIN_FILENO, "/dev/null", O_RDONLY, 0);
+    }
+    if (options.stdout_fd >= 0) {
+        posix_spawn_file_actions_adddup2(&actions, options.stdout_fd, STDOUT_FILENO);
+    }
+
+    // O servidor ignora SIGPIPE e as threads do gRPC podem bloquear sinais;
+    // o filho deve começar com disposições e máscara padrão
+    posix_spawnattr_t attr;
+    posix_spawnattr_init(&attr);
+    sigset_t default_signals, empty_mask;
+    sigemptyset(&default_signals);
+    sigaddset(&default_signals, SIGPIPE);
+    sigemptyset(&empty_mask);
+    posix_spawnattr_setsigdefault(&attr, &default_signals);
+    posix_spawnattr_setsigmask(&attr, &empty_mask);
+    posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSIGDEF | POSIX_SPAWN_SETSIGMASK);
+
+    pid_t pid = -1;
+    auto spawn_started = std::chrono::steady_clock::now();
+    int err = args.size() > 1 ? posix_spawnp(&pid, args[0], &actions, &attr, args.data(), environ) : EINVAL;
+    auto started = std::chrono::steady_clock::now();
+    posix_spawn_file_actions_destroy(&actions);
+    posix_spawnattr_destroy(&attr);
+
+    if (err != 0) {
+        ProcessResult failed;
+        failed.spawn_started = spawn_started;
+        failed.started = failed.exited = started;
+        on_exit(failed);
+        return -1;
+    }
+    on_exit = [spawn_started, started, on_exit = std::move(on_exit)](const ProcessResult& exited) {
+        ProcessResult result = exited;
+        result.spawn_started = spawn_started;
+        result.started = started;
+        on_exit(result);
+    };
+
+    int pidfd = openPidfd(pid);
+    if (pidfd < 0) {
+        // Kernel sem pidfd (< 5.3): recolhe o filho em uma thread dedicada
+        std::thread([pid, on_exit = std::move(on_exit)]() { on_exit(waitChild(pid)); }).detach();
+        return pid;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        children_.emplace(pidfd, Child{pid, std::move(on_exit)});
+    }
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.fd = pidfd;
+    epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, pidfd, &event);
+    return pid;
+}
+
+std::future<ProcessResult> ProcessSupervisor::spawn(const std::vector<std::string>& argv, const SpawnOptions& options) {
+    auto promise = std::make_shared<std::promise<ProcessResult>>();
+    auto future = promise->get_future();
+    spawn(argv, options, [promise](const ProcessResult& result) { promise->set_value(result); });
+    return future;
+}
+
+ProcessResult ProcessSupervisor::waitChild(pid_t pid) {
+    ProcessResult result;
+    int status = 0;
+    pid_t waited;
+    do {
+        waited = wait4(pid, &status, 0, &result.usage);
+    } while (waited < 0 && errno == EINTR);
+
+    result.exited = std::chrono::steady_clock::now();
+    if (waited == pid) {
+        if (WIFEXITED(status)) {
+            result.exit_code = WEXITSTATUS(status);
+        } else if (WIFSIGNALED(status)) {
+            result.exit_code = -1;
+            result.term_signal = WTERMSIG(status);
+        }
+    }
+    return result;
+}
+
+void ProcessSupervisor::reapLoop() {
+    epoll_event events[64];
+    while (true) {
+        int count = epoll_wait(epoll_fd_, events, 64, -1);
+        if (count < 0) {
+            if (errno == EINTR) continue;
+            return;
+        }
+        for (int i = 0; i < count; ++i) {
+            int fd = events[i].data.fd;
+            if (fd == wake_fd_) return;
+
+            Child child;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                auto it = children_.find(fd);
+                if (it == children_.end()) continue;
+                child = std::move(it->second);
+                children_.erase(it);
+            }
+            // pidfd legível significa que o filho terminou; wait4 não bloqueia aqui
+            epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+            close(fd);
+            child.on_exit(waitChild(child.pid));
+        }
+    }
+}
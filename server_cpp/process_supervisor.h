@@ -0,0 +1,73 @@
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <sys/resource.h>
+#include <sys/types.h>
+
+// Resultado de um processo filho já encerrado
+struct ProcessResult {
+    int exit_code = -1;     // código de saída; -1 se o processo não pôde ser iniciado
+    int term_signal = 0;    // sinal que encerrou o processo, se houver
+    struct rusage usage {}; // uso de CPU/memória informado por wait4
+
+    // Momentos (steady_clock) da chamada ao posix_spawn, do seu retorno e do fim do processo
+    std::chrono::steady_clock::time_point spawn_started;
+    std::chrono::steady_clock::time_point started;
+    std::chrono::steady_clock::time_point exited;
+
+    bool ok() const { return exit_code == 0 && term_signal == 0; }
+
+    // Código no formato do shell: exit_code, ou 128 + sinal se o processo foi morto
+    int status() const { return term_signal ? 128 + term_signal : exit_code; }
+};
+
+struct SpawnOptions {
+    int stdin_fd = -1;  // fd usado como stdin do filho; -1 = /dev/null
+    int stdout_fd = -1; // fd usado como stdout do filho; -1 = herda o do servidor
+};
+
+// Inicia ferramentas externas com posix_spawn (sem copiar o espaço de endereçamento do
+// servidor e sem passar por /bin/sh) e recolhe todos os filhos em uma única thread,
+// que espera os pidfds em um epoll. Quem inicia o processo recebe um future ou callback
+// em vez de bloquear uma thread em waitpid.
+class ProcessSupervisor {
+public:
+    using ExitCallback = std::function<void(const ProcessResult&)>;
+
+    static ProcessSupervisor& instance();
+
+    // Executa argv[0] (buscado no PATH). on_exit é chamado exatamente uma vez, na thread
+    // do supervisor, ou imediatamente se o processo não puder ser iniciado. Retorna o pid ou -1.
+    pid_t spawn(const std::vector<std::string>& argv, const SpawnOptions& options, ExitCallback on_exit);
+
+    std::future<ProcessResult> spawn(const std::vector<std::string>& argv, const SpawnOptions& options = {});
+
+    ProcessSupervisor(const ProcessSupervisor&) = delete;
+    ProcessSupervisor& operator=(const ProcessSupervisor&) = delete;
+
+private:
+    struct Child {
+        pid_t pid;
+        ExitCallback on_exit;
+    };
+
+    ProcessSupervisor();
+    ~ProcessSupervisor();
+
+    void reapLoop();
+    static ProcessResult waitChild(pid_t pid);
+
+    int epoll_fd_ = -1;
+    int wake_fd_ = -1;
+    std::mutex mutex_;
+    std::unordered_map<int, Child> children_; // pidfd -> filho
+    std::thread reaper_;
+};
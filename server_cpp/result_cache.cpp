@@ -0,0 +1,165 @@
+#include "result_cache.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <dirent.h>
+#include <sys/stat.h>
+
+namespace {
+
+// Um único resultado não ocupa mais que esta fração de um nível, para não esvaziar o cache sozinho
+const size_t kMaxEntryFraction = 4;
+
+bool isCacheKey(const std::string& name) {
+    if (name.size() != 64) return false;
+    return std::all_of(name.begin(), name.end(), [](char c) { return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f'); });
+}
+
+} // namespace
+
+ResultCache::ResultCache(size_t memory_limit, const std::string& disk_dir, size_t disk_limit)
+    : memory_limit_(memory_limit), disk_dir_(disk_dir) {
+    memory_.limit = memory_limit;
+    disk_.limit = disk_dir.empty() ? 0 : disk_limit;
+    if (!disk_dir_.empty()) {
+        mkdir(disk_dir_.c_str(), 0700);
+        loadDiskIndex();
+    }
+}
+
+bool ResultCache::accepts(size_t size) const {
+    return size <= memory_.limit / kMaxEntryFraction || size <= disk_.limit / kMaxEntryFraction;
+}
+
+bool ResultCache::lookup(const std::string& key, Hit& hit) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto memory = memory_.entries.find(key);
+    if (memory != memory_.entries.end()) {
+        touch(memory_, memory->second);
+        hit.data = memory->second.data;
+        ++stats_.memory_hits;
+        return true;
+    }
+    auto disk = disk_.entries.find(key);
+    if (disk != disk_.entries.end()) {
+        touch(disk_, disk->second);
+        hit.path = diskPath(key);
+        ++stats_.disk_hits;
+        return true;
+    }
+    ++stats_.misses;
+    return false;
+}
+
+void ResultCache::store(const std::string& key, const std::shared_ptr<const std::string>& data) {
+    const size_t size = data->size();
+    bool to_memory = size <= memory_.limit / kMaxEntryFraction;
+    bool to_disk = size <= disk_.limit / kMaxEntryFraction;
+
+    if (to_disk) {
+        // Grava com outro nome e renomeia, para que um leitor nunca veja um arquivo pela metade
+        std::string temp = diskPath(key) + ".tmp" + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id()));
+        std::ofstream file(temp, std::ios::binary);
+        file.write(data->data(), static_cast<std::streamsize>(size));
+        file.close();
+        if (!file.good() || std::rename(temp.c_str(), diskPath(key).c_str()) != 0) {
+            std::remove(temp.c_str());
+            to_disk = false;
+        }
+    }
+
+    std::list<std::string> evicted_files;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (to_memory) {
+            Entry entry;
+            entry.size = size;
+            entry.data = data;
+            insert(memory_, key, std::move(entry));
+        }
+        if (to_disk) {
+            Entry entry;
+            entry.size = size;
+            evicted_files = insert(disk_, key, std::move(entry));
+        }
+        if (to_memory || to_disk) ++stats_.stores;
+    }
+    // Arquivos descartados podem estar mapeados por um envio em andamento; o unlink não os invalida
+    for (const auto& evicted : evicted_files) std::remove(diskPath(evicted).c_str());
+}
+
+ResultCache::Stats ResultCache::stats() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stats stats = stats_;
+    stats.memory_entries = memory_.entries.size();
+    stats.memory_bytes = memory_.bytes;
+    stats.disk_entries = disk_.entries.size();
+    stats.disk_bytes = disk_.bytes;
+    return stats;
+}
+
+std::list<std::string> ResultCache::insert(Tier& tier, const std::string& key, Entry entry) {
+    auto existing = tier.entries.find(key);
+    if (existing != tier.entries.end()) {
+        tier.bytes -= existing->second.size;
+        tier.order.erase(existing->second.position);
+        tier.entries.erase(existing);
+    }
+    tier.order.push_front(key);
+    entry.position = tier.order.begin();
+    tier.bytes += entry.size;
+    tier.entries.emplace(key, std::move(entry));
+
+    std::list<std::string> evicted;
+    while (tier.bytes > tier.limit && !tier.order.empty()) {
+        const std::string& oldest = tier.order.back();
+        auto it = tier.entries.find(oldest);
+        tier.bytes -= it->second.size;
+        tier.entries.erase(it);
+        evicted.splice(evicted.end(), tier.order, std::prev(tier.order.end()));
+    }
+    return evicted;
+}
+
+void ResultCache::touch(Tier& tier, Entry& entry) {
+    tier.order.splice(tier.order.begin(), tier.order, entry.position);
+}
+
+// Reconstrói o índice do nível em disco, do arquivo modificado há mais tempo para o mais recente
+void ResultCache::loadDiskIndex() {
+    DIR* dir = opendir(disk_dir_.c_str());
+    if (!dir) {
+        disk_dir_.clear();
+        disk_.limit = 0;
+        return;
+    }
+
+    std::vector<std::pair<time_t, std::pair<std::string, size_t>>> found;
+    while (dirent* item = readdir(dir)) {
+        std::string name = item->d_name;
+        std::string path = diskPath(name);
+        struct stat info;
+        if (stat(path.c_str(), &info) != 0 || !S_ISREG(info.st_mode)) continue;
+        if (!isCacheKey(name)) {
+            // Sobras de gravações interrompidas
+            if (name.find(".tmp") != std::string::npos) std::remove(path.c_str());
+            continue;
+        }
+        found.push_back({info.st_mtime, {name, static_cast<size_t>(info.st_size)}});
+    }
+    closedir(dir);
+
+    std::sort(found.begin(), found.end());
+    for (const auto& item : found) {
+        Entry entry;
+        entry.size = item.second.second;
+        for (const auto& evicted : insert(disk_, item.second.first, std::move(entry))) {
+            std::remove(diskPath(evicted).c_str());
+        }
+    }
+}
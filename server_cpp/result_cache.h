@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+// Cache de resultados endereçado por conteúdo, em dois níveis: um LRU em memória limitado
+// em bytes e, opcionalmente, um diretório em disco (também LRU, reconstruído na partida).
+// A chave é o hash da entrada e dos parâmetros da chamada (ver TransferReactor::shareResults);
+// um acerto é enviado direto ao cliente, sem executar nenhuma ferramenta.
+class ResultCache {
+public:
+    struct Stats {
+        uint64_t memory_hits = 0;
+        uint64_t disk_hits = 0;
+        uint64_t misses = 0;
+        uint64_t stores = 0;
+        size_t memory_entries = 0;
+        size_t memory_bytes = 0;
+        size_t disk_entries = 0;
+        size_t disk_bytes = 0;
+    };
+
+    // Resultado de um acerto: o conteúdo em memória ou o arquivo do nível em disco
+    struct Hit {
+        std::shared_ptr<const std::string> data;
+        std::string path;
+    };
+
+    // memory_limit == 0 desativa o nível em memória; disk_dir vazio desativa o nível em disco
+    ResultCache(size_t memory_limit, const std::string& disk_dir, size_t disk_limit);
+
+    bool enabled() const { return memory_limit_ > 0 || !disk_dir_.empty(); }
+
+    // Indica se um resultado de size bytes caberia em algum nível
+    bool accepts(size_t size) const;
+
+    // Procura key na memória e depois no disco, atualizando a ordem do LRU
+    bool lookup(const std::string& key, Hit& hit);
+
+    // Guarda o resultado nos níveis em que ele couber, descartando os menos usados.
+    // A escrita em disco acontece na thread de quem chama.
+    void store(const std::string& key, const std::shared_ptr<const std::string>& data);
+
+    Stats stats();
+
+private:
+    struct Entry {
+        size_t size = 0;
+        std::list<std::string>::iterator position; // posição em order (início = mais recente)
+        std::shared_ptr<const std::string> data;   // só no nível em memória
+    };
+
+    struct Tier {
+        size_t limit = 0;
+        size_t bytes = 0;
+        std::list<std::string> order;
+        std::unordered_map<std::string, Entry> entries;
+    };
+
+    // Insere ou atualiza key em tier e devolve as chaves descartadas para caber no limite
+    static std::list<std::string> insert(Tier& tier, const std::string& key, Entry entry);
+    static void touch(Tier& tier, Entry& entry);
+
+    void loadDiskIndex();
+    std::string diskPath(const std::string& key) const { return disk_dir_ + "/" + key; }
+
+    size_t memory_limit_;
+    std::string disk_dir_;
+
+    std::mutex mutex_;
+    Tier memory_;
+    Tier disk_;
+    Stats stats_;
+};
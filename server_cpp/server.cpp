@@ -1,239 +1,1154 @@
 #include <iostream>
-#include <fstream>
 #include <string>
 #include <memory>
 #include <vector>
 #include <cstdio>
+#include <cstdlib>
 #include <chrono>
-#include <iomanip>
-#include <sstream>
-#include <random> // Adicionado para nomes de arquivo únicos
+#include <csignal>
+#include <cctype>
+#include <algorithm>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
 
 #include <grpcpp/grpcpp.h>
 #include "file_processor.grpc.pb.h"
+#include "config.h"
+#include "file_io.h"
+#include "logging.h"
+#include "input_sink.h"
+#include "job_executor.h"
+#include "admission.h"
+#include "result_cache.h"
+#include "single_flight.h"
+#include "metrics.h"
+#include "metrics_http.h"
+#include "tracing.h"
+#include "transfer_reactor.h"
+#include "batch_reactor.h"
+#include "gs_pool.h"
+#include "image_engine.h"
+#include "pdf_text.h"
+#include "process_supervisor.h"
+#include "upload_store.h"
+#include "wire_compression.h"
 
+using grpc::CallbackServerContext;
 using grpc::Server;
+using grpc::ServerBidiReactor;
 using grpc::ServerBuilder;
-using grpc::ServerContext;
-using grpc::ServerReaderWriter;
+using grpc::ServerUnaryReactor;
 using grpc::Status;
 using namespace file_processor;
 
-// Função para obter o timestamp atual formatado
-std::string getCurrentTimestamp() {
-    auto now = std::chrono::system_clock::now();
-    auto in_time_t = std::chrono::system_clock::to_time_t(now);
-    std::stringstream ss;
-    ss << std::put_time(std::localtime(&in_time_t), "%Y-%m-%d %H:%M:%S");
-    return ss.str();
+// O formato vira a extensão do arquivo de saída, que o convert usa para escolher o codificador.
+// Só letras e dígitos são aceitos para evitar caminhos ou prefixos do tipo "fmt:arquivo".
+bool isValidFormat(const std::string& format) {
+    if (format.empty() || format.size() > 10) return false;
+    for (char c : format) {
+        if (!std::isalnum(static_cast<unsigned char>(c))) return false;
+    }
+    return true;
 }
 
-// Função de logging
-void logOperation(const std::string& service_name, const std::string& status, const std::string& message) {
-    std::ofstream log_file("server.log", std::ios::app);
-    std::string log_entry = "[" + getCurrentTimestamp() + "] [" + service_name + "] [" + status + "] " + message;
-    if (log_file.is_open()) {
-        log_file << log_entry << std::endl;
+// Estado de uma chamada de imagem, compartilhado entre a leitura do cabeçalho e o processamento
+struct ImageJob {
+    std::string input_path;
+    std::string output_path;
+    std::string input;                    // upload completo (motor interno)
+    std::vector<ImageOperation> operations; // operações equivalentes no motor interno, em ordem
+    std::vector<std::string> convert_ops; // argumentos do convert entre a entrada e a saída
+    std::string result_params;             // parâmetros que identificam o resultado (cache e deduplicação)
+    std::vector<std::string> output_paths; // ResizeImage com vários tamanhos: uma saída por operação
+
+    // Linha de comando do convert lendo de input ("-" = stdin)
+    std::vector<std::string> convertCommand(const std::string& input) const {
+        std::vector<std::string> command = {"convert", input};
+        command.insert(command.end(), convert_ops.begin(), convert_ops.end());
+        command.push_back(output_path);
+        return command;
     }
-    std::cout << log_entry << std::endl;
-}
+};
 
-// Função para gerar um nome de arquivo aleatório e único
-std::string generateUniqueFilename(const std::string& prefix) {
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<> distrib(100000, 999999);
-    return "/tmp/" + prefix + "_" + std::to_string(std::chrono::system_clock::now().time_since_epoch().count()) + "_" + std::to_string(distrib(gen));
-}
+// Etapas de um RunPipeline já validadas. As etapas de imagem são fundidas em um único ImageJob;
+// as de PDF são compressões em sequência, opcionalmente seguidas da extração de texto.
+struct PipelinePlan {
+    bool image = false;
+    ImageJob image_job;
+    std::string input_path;                // spool da entrada (PDF)
+    std::vector<BatchOperation> pdf_steps;
+    std::string result_params;             // parâmetros que identificam o resultado (cache e deduplicação)
+
+    // Entrada da etapa de PDF step; a saída de cada compressão é a entrada da seguinte
+    std::string pdfPath(size_t step) const {
+        return step == 0 ? input_path : input_path + "_" + std::to_string(step) + ".pdf";
+    }
+};
+
+// Limite de etapas de um RunPipeline
+const int kMaxPipelineSteps = 16;
+
+// Limite de saídas de um ResizeImage com vários tamanhos
+const int kMaxResizeOutputs = 16;
+
+// Métodos de transferência do serviço, com limites de admissão e métricas próprios
+const std::vector<std::string> kTransferMethods = {"CompressPDF", "ConvertToTXT", "ConvertImageFormat", "ResizeImage", "ProcessBatch", "RunPipeline"};
+
+// Intervalo de páginas de um PDF dividido, numeradas a partir de 1 e com as duas pontas incluídas
+struct PageRange {
+    int first;
+    int last;
+};
+
+// Páginas e limite de caracteres pedidos ao ConvertToTXT (TextOptions); o padrão é o documento inteiro
+struct TextSelection {
+    int first_page = 1;
+    int last_page = 0;      // 0 = até a última
+    uint64_t max_chars = 0; // 0 = sem limite
+};
 
+// Maior página aceita em TextOptions (mantém os números dentro de um int)
+const uint32_t kMaxTextPage = 1000000;
 
-// Classe de implementação do serviço
-class FileProcessorServiceImpl final : public FileProcessorService::Service {
+// Menor intervalo em que um PDF é dividido: abaixo disso o custo de abrir o documento em cada
+// intervalo e de juntar as partes supera o ganho
+const int kMinRangePages = 16;
+
+// Linha de comando do Ghostscript equivalente ao pool (pdfwrite, /ebook, compatibilidade 1.4),
+// opcionalmente restrita às páginas de range
+std::vector<std::string> gsCommand(const std::string& input_path, const std::string& output_path,
+                                   const PageRange* range = nullptr) {
+    std::vector<std::string> command = {"gs", "-sDEVICE=pdfwrite", "-dCompatibilityLevel=1.4", "-dPDFSETTINGS=/ebook",
+                                        "-dNOPAUSE", "-dQUIET", "-dBATCH", "-sOutputFile=" + output_path};
+    if (range) {
+        command.push_back("-dFirstPage=" + std::to_string(range->first));
+        command.push_back("-dLastPage=" + std::to_string(range->last));
+    }
+    command.push_back(input_path);
+    return command;
+}
+
+// Classe de implementação do serviço. Os handlers só montam um TransferReactor: a rede fica
+// com as threads do gRPC e o processamento com o executor_, dimensionado por --workers.
+class FileProcessorServiceImpl final : public FileProcessorService::CallbackService {
 private:
-    // Função auxiliar para enviar o arquivo via stream
-    bool sendFile(ServerReaderWriter<FileChunk, FileChunk>* stream, const std::string& file_path) {
-        std::ifstream file(file_path, std::ios::binary);
-        if (!file.is_open()) {
-            return false;
+    ServerConfig config_;
+    std::chrono::steady_clock::time_point started_at_;
+    ServerMetrics metrics_;
+    std::unique_ptr<Tracer> tracer_; // antes do executor_: os rastros são entregues quando as chamadas terminam
+    ResultCache cache_; // declarado antes do executor_, que ainda pode ter gravações pendentes ao encerrar
+    SingleFlight flights_;
+    UploadStore uploads_;
+    JobExecutor executor_;
+    AdmissionController admission_;
+    std::unique_ptr<GhostscriptPool> gs_pool_;
+    std::unique_ptr<MetricsHttpServer> metrics_http_; // por último: lê todos os membros acima
+
+    // Estado atual dos componentes compartilhados, para o GetStats e o endpoint /metrics
+    RuntimeStats runtimeStats() {
+        RuntimeStats runtime;
+        for (const auto& method : kTransferMethods) {
+            AdmissionController::Usage usage = admission_.usage(method);
+            runtime.admission[method] = {usage.active, usage.queued};
         }
-        char buffer[4096];
-        while (file.read(buffer, sizeof(buffer))) {
-            FileChunk chunk;
-            chunk.set_content(buffer, file.gcount());
-            if (!stream->Write(chunk)) break;
+        runtime.workers = executor_.workers();
+        runtime.executor_pending = executor_.pending();
+        runtime.cache = cache_.stats();
+        runtime.coalesced = flights_.coalesced();
+        runtime.log = logStats();
+        if (tracer_) {
+            Tracer::Stats traces = tracer_->stats();
+            runtime.traces_exported = traces.exported;
+            runtime.traces_dropped = traces.dropped;
         }
-        if (file.gcount() > 0) {
-            FileChunk chunk;
-            chunk.set_content(buffer, file.gcount());
-            stream->Write(chunk);
+        runtime.uptime = std::chrono::steady_clock::now() - started_at_;
+        return runtime;
+    }
+
+    // Inicia o rastro de uma chamada amostrada, respeitando o "traceparent" do cliente, e devolve
+    // o do span do servidor nos metadados iniciais
+    std::unique_ptr<CallTrace> startTrace(CallbackServerContext* context, const std::string& service) {
+        if (!tracer_) return nullptr;
+        auto header = context->client_metadata().find("traceparent");
+        std::string traceparent = header == context->client_metadata().end()
+            ? std::string() : std::string(header->second.data(), header->second.size());
+        std::unique_ptr<CallTrace> trace = tracer_->startCall(service, traceparent);
+        if (trace) context->AddInitialMetadata("traceparent", trace->traceparent());
+        return trace;
+    }
+
+    // Sessão de upload retomável pedida nos metadados "x-upload-id" e, opcionalmente, "x-upload-size"
+    template <typename Request>
+    void attachUpload(CallbackServerContext* context, TransferReactor<Request>* reactor) {
+        const auto& metadata = context->client_metadata();
+        auto id = metadata.find("x-upload-id");
+        if (id == metadata.end()) return;
+        uint64_t expected_size = 0;
+        auto size = metadata.find("x-upload-size");
+        if (size != metadata.end()) expected_size = std::strtoull(std::string(size->second.data(), size->second.size()).c_str(), nullptr, 10);
+        reactor->setUpload(&uploads_, std::string(id->second.data(), id->second.size()), expected_size);
+    }
+
+    // Compressão das respostas pedida no metadado x-response-compression. Nomes desconhecidos são
+    // ignorados e, sem a libzstd, "zstd" vira gzip; a escolha volta ao cliente nos metadados iniciais.
+    WireCompression negotiateCompression(CallbackServerContext* context, CallTrace* trace) {
+        auto header = context->client_metadata().find(kCompressionMetadata);
+        if (header == context->client_metadata().end()) return WireCompression::None;
+        WireCompression compression = WireCompression::None;
+        if (!parseWireCompression(std::string(header->second.data(), header->second.size()), compression)) {
+            return WireCompression::None;
         }
-        return true;
+        if (compression == WireCompression::Zstd && !zstdAvailable()) compression = WireCompression::Gzip;
+        if (compression == WireCompression::Gzip) context->set_compression_algorithm(GRPC_COMPRESS_GZIP);
+        if (compression == WireCompression::Deflate) context->set_compression_algorithm(GRPC_COMPRESS_DEFLATE);
+        context->AddInitialMetadata(kCompressionMetadata, wireCompressionName(compression));
+        if (trace) trace->attribute(CallTrace::kRoot, "rpc.response.compression", std::string(wireCompressionName(compression)));
+        return compression;
     }
 
-public:
-    Status CompressPDF(ServerContext* context, ServerReaderWriter<FileChunk, FileChunk>* stream) override {
-        logOperation("CompressPDF", "INFO", "Requisição recebida.");
-        std::string input_path = generateUniqueFilename("input_compress");
-        std::string output_path = input_path + "_out.pdf";
+    // Inicia o reactor assim que o controle de admissão liberar uma vaga. Se a vaga não vier, a
+    // chamada termina com RESOURCE_EXHAUSTED e a espera sugerida no metadado final "retry-after-ms".
+    template <typename Reactor>
+    void admit(CallbackServerContext* context, const std::string& service, Reactor* reactor) {
+        admission_.acquire(service, [this, context, reactor, service](bool admitted, std::chrono::milliseconds retry_after) {
+            if (!admitted) {
+                logOperation(service, "WARNING", "Requisição recusada por sobrecarga; nova tentativa sugerida em " +
+                                                     std::to_string(retry_after.count()) + " ms.");
+                context->AddTrailingMetadata("retry-after-ms", std::to_string(retry_after.count()));
+                reactor->reject(Status(grpc::StatusCode::RESOURCE_EXHAUSTED, "Servidor sobrecarregado, tente novamente mais tarde."));
+                return;
+            }
+            auto admitted_at = std::chrono::steady_clock::now();
+            reactor->begin([this, service, admitted_at]() { admission_.release(service, std::chrono::steady_clock::now() - admitted_at); });
+        });
+    }
 
-        std::ofstream temp_file(input_path, std::ios::binary);
-        if (!temp_file.is_open()) {
-            logOperation("CompressPDF", "ERROR", "Falha ao criar arquivo temporário de entrada.");
-            return Status(grpc::StatusCode::INTERNAL, "Erro ao salvar arquivo de entrada.");
+    // Cria o reactor da chamada e o inicia pelo controle de admissão (ver admit). Chamadas
+    // rastreadas devolvem o "traceparent" do span do servidor nos metadados iniciais.
+    template <typename Request>
+    TransferReactor<Request>* transfer(CallbackServerContext* context, const std::string& service,
+                                       typename TransferReactor<Request>::Start start,
+                                       typename TransferReactor<Request>::Process process) {
+        logOperation(service, "INFO", "Requisição recebida.");
+        std::unique_ptr<CallTrace> trace = startTrace(context, service);
+        auto* reactor = new TransferReactor<Request>(service, executor_, config_.chunk_size, ResultSharing{&cache_, &flights_},
+                                                     metrics_.method(service), std::move(start), std::move(process));
+        reactor->setCompression(negotiateCompression(context, trace.get()), config_.zstd_level);
+        attachUpload(context, reactor);
+        if (trace) reactor->setTrace(std::move(trace));
+        admit(context, service, reactor);
+        return reactor;
+    }
+
+    // Grava no spool uma entrada já recebida em memória e executa argv sobre ele
+    template <typename Request>
+    int runOnSpool(TransferReactor<Request>& reactor, const std::string& path, const std::string& input,
+                   const std::vector<std::string>& argv) {
+        auto sink = openSpoolSink(path, argv);
+        if (!sink) return -1;
+        sink->write(input.data(), input.size());
+        int result = sink->finish();
+        if (const ProcessResult* tool = sink->toolResult()) reactor.addToolResult(*tool);
+        return result;
+    }
+
+    // Executa argv com o stdout ligado a um pipe e repassa cada bloco lido ao cliente assim que chega.
+    // Se o cliente desconectar, ou se limit for atingido, a ponta de leitura é fechada e a
+    // ferramenta encerra com SIGPIPE.
+    template <typename Request>
+    int streamCommandOutput(TransferReactor<Request>& reactor, const std::vector<std::string>& argv, TextLimit* limit = nullptr) {
+        int fds[2];
+        if (pipe2(fds, O_CLOEXEC) != 0) return -1;
+
+        SpawnOptions options;
+        options.stdout_fd = fds[1];
+        std::future<ProcessResult> exit = ProcessSupervisor::instance().spawn(argv, options);
+        close(fds[1]);
+
+        TraceSpan read_span(reactor.trace(), "output_read", reactor.traceParent());
+        std::vector<char> buffer(config_.chunk_size);
+        while (true) {
+            ssize_t count = read(fds[0], buffer.data(), buffer.size());
+            if (count < 0 && errno == EINTR) continue;
+            if (count <= 0) break;
+            size_t size = limit ? limit->fit(buffer.data(), static_cast<size_t>(count)) : static_cast<size_t>(count);
+            if (!reactor.stream(buffer.data(), size)) break;
+            if (limit && limit->reached()) break;
         }
-        FileChunk chunk;
-        while (stream->Read(&chunk)) {
-            temp_file.write(chunk.content().c_str(), chunk.content().length());
+        close(fds[0]);
+        ProcessResult result = exit.get();
+        reactor.addToolResult(result);
+        return result.status();
+    }
+
+    // Extrai o texto das páginas de range (todas, se nullptr) para text, com a poppler-cpp ou o pdftotext
+    template <typename Request>
+    bool extractPdfTextPages(TransferReactor<Request>& reactor, const std::string& input_path, const PageRange& range,
+                             std::string& text, std::string& error) {
+        if (pdfTextAvailable()) {
+            auto append_page = [&text](const std::string& page) {
+                text += page;
+                return true;
+            };
+            return extractPdfText(input_path, append_page, error, range.first, range.last);
         }
-        temp_file.close();
-        
-        std::string command = "gs -sDEVICE=pdfwrite -dCompatibilityLevel=1.4 -dPDFSETTINGS=/ebook -dNOPAUSE -dQUIET -dBATCH -sOutputFile=" + output_path + " " + input_path;
-        int result = std::system(command.c_str());
+        std::string output_path = input_path + "_pages" + std::to_string(range.first) + ".txt";
+        ProcessResult result = ProcessSupervisor::instance().spawn(
+            {"pdftotext", "-f", std::to_string(range.first), "-l", std::to_string(range.last), input_path, output_path}).get();
+        reactor.addToolResult(result);
+        bool read = result.ok() && readFile(output_path, text);
+        std::remove(output_path.c_str());
+        if (!read) error = "Falha na execução do pdftotext. Código: " + std::to_string(result.status());
+        return read;
+    }
 
-        if (result == 0) {
-            if (!sendFile(stream, output_path)) {
-                logOperation("CompressPDF", "ERROR", "Falha ao enviar arquivo comprimido.");
-                return Status(grpc::StatusCode::INTERNAL, "Erro ao enviar arquivo de saída.");
+    // Extrai o texto das páginas de selection do PDF em input_path e o envia conforme é produzido.
+    // Documentos grandes são divididos em intervalos de páginas extraídos em paralelo no executor; o
+    // texto de cada um é enviado, em ordem, quando todos terminam. Com um limite de caracteres a
+    // extração é sequencial e para, encerrando a ferramenta, assim que o limite é atingido.
+    template <typename Request>
+    Status sendPdfText(TransferReactor<Request>& reactor, const std::string& input_path, const std::string& service,
+                       const TextSelection& selection = TextSelection()) {
+        // Uma primeira página além do fim é erro do pedido nos dois extratores (o pdftotext
+        // falharia e a poppler-cpp devolveria texto vazio); se a contagem falhar, o extrator decide
+        if (selection.first_page > 1) {
+            std::string count_error;
+            int pages;
+            {
+                TraceSpan span(reactor.trace(), "pdf_page_count", reactor.traceParent());
+                pages = pdfPageCount(input_path, count_error);
+            }
+            if (pages >= 0 && selection.first_page > pages) {
+                logOperation(service, "ERROR", "Página inicial " + std::to_string(selection.first_page) +
+                                                   " além do fim do documento (" + std::to_string(pages) + " páginas).");
+                return Status(grpc::StatusCode::OUT_OF_RANGE, "A página inicial pedida não existe no documento.");
+            }
+        }
+        std::vector<PageRange> ranges;
+        if (selection.max_chars == 0) ranges = pageRanges(reactor, input_path, selection.first_page, selection.last_page);
+        if (!ranges.empty()) {
+            std::vector<std::string> texts(ranges.size());
+            std::vector<std::string> errors(ranges.size());
+            std::vector<char> extracted(ranges.size(), 0);
+            {
+                TraceSpan span(reactor.trace(), "pdf_split", reactor.traceParent());
+                if (reactor.trace()) reactor.trace()->attribute(span.id(), "pdf.ranges", static_cast<int64_t>(ranges.size()));
+                executor_.parallelFor(ranges.size(), ranges.size(), [&](size_t i) {
+                    extracted[i] = extractPdfTextPages(reactor, input_path, ranges[i], texts[i], errors[i]);
+                });
             }
-            logOperation("CompressPDF", "SUCCESS", "Arquivo comprimido e enviado com sucesso.");
+            auto failed = std::find(extracted.begin(), extracted.end(), 0);
+            if (failed == extracted.end()) {
+                for (const auto& text : texts) {
+                    if (!reactor.stream(text.data(), text.size())) {
+                        return Status(grpc::StatusCode::CANCELLED, "O cliente deixou de receber o texto.");
+                    }
+                }
+                return Status::OK;
+            }
+            logOperation(service, "WARNING", "Falha na extração de texto em intervalos (" + errors[failed - extracted.begin()] +
+                                                 "); extraindo o documento inteiro.");
+        }
+
+        std::string error;
+        int result;
+        TextLimit limit(selection.max_chars);
+        if (pdfTextAvailable()) {
+            // poppler-cpp: cada página segue para o cliente assim que seu texto é extraído
+            auto send_page = [&reactor, &limit](const std::string& text) {
+                return reactor.stream(text.data(), limit.fit(text.data(), text.size())) && !limit.reached();
+            };
+            result = extractPdfText(input_path, send_page, error, selection.first_page, selection.last_page) ? 0 : 1;
         } else {
-            logOperation("CompressPDF", "ERROR", "Falha na execução do Ghostscript. Código: " + std::to_string(result));
-            return Status(grpc::StatusCode::INTERNAL, "Falha ao comprimir PDF.");
+            // Sem a poppler-cpp, o pdftotext escreve no stdout ("-") e o texto é repassado pelo pipe
+            std::vector<std::string> command = {"pdftotext"};
+            if (selection.first_page > 1) command.insert(command.end(), {"-f", std::to_string(selection.first_page)});
+            if (selection.last_page > 0) command.insert(command.end(), {"-l", std::to_string(selection.last_page)});
+            command.insert(command.end(), {input_path, "-"});
+            result = streamCommandOutput(reactor, command, &limit);
+        }
+        // Ao atingir o limite a extração é interrompida de propósito
+        if (limit.reached()) return Status::OK;
+        // Com o cliente desconectado a extração também é interrompida: não é uma falha do servidor
+        if (result != 0 && reactor.cancelled()) {
+            return Status(grpc::StatusCode::CANCELLED, "O cliente deixou de receber o texto.");
         }
 
-        std::remove(input_path.c_str());
-        std::remove(output_path.c_str());
+        if (result != 0) {
+            if (pdfTextAvailable()) {
+                logOperation(service, "ERROR", "Falha na extração de texto: " + error);
+            } else {
+                logOperation(service, "ERROR", "Falha na execução do pdftotext. Código: " + std::to_string(result));
+            }
+            return Status(grpc::StatusCode::INTERNAL, "Falha ao converter PDF para TXT.");
+        }
         return Status::OK;
     }
 
-    Status ConvertToTXT(ServerContext* context, ServerReaderWriter<FileChunk, FileChunk>* stream) override {
-        logOperation("ConvertToTXT", "INFO", "Requisição recebida.");
-        std::string input_path = generateUniqueFilename("input_totext");
-        std::string output_path = input_path + "_out.txt";
-
-        std::ofstream temp_file(input_path, std::ios::binary);
-        if (!temp_file.is_open()) {
-             logOperation("ConvertToTXT", "ERROR", "Falha ao salvar arquivo temporário.");
-             return Status(grpc::StatusCode::INTERNAL, "Erro ao salvar arquivo de entrada.");
+    // Parâmetros que identificam o resultado de cada método no cache e na deduplicação; o
+    // ProcessBatch usa os mesmos, então os dois caminhos compartilham resultados
+    std::string textResultParams(const TextSelection& selection = TextSelection()) const {
+        std::string params = std::string("ConvertToTXT\ntext=") + (pdfTextAvailable() ? "poppler" : "pdftotext");
+        if (selection.first_page > 1 || selection.last_page > 0) {
+            params += "\npages=" + std::to_string(selection.first_page) + "-" + std::to_string(selection.last_page);
         }
-        FileChunk chunk;
-        while (stream->Read(&chunk)) {
-            temp_file.write(chunk.content().c_str(), chunk.content().length());
+        if (selection.max_chars > 0) params += "\nmax_chars=" + std::to_string(selection.max_chars);
+        return params;
+    }
+
+    // A divisão em intervalos muda os bytes do PDF gerado, então as configurações efetivas dela
+    // entram na chave; sem divisão a chave continua a mesma de antes
+    std::string pdfResultParams() const {
+        if (config_.pdf_split_pages == 0) return "CompressPDF";
+        size_t parallelism = config_.pdf_split_parallelism > 0 ? config_.pdf_split_parallelism : executor_.workers();
+        return "CompressPDF\nsplit=" + std::to_string(config_.pdf_split_pages) + "/" + std::to_string(parallelism);
+    }
+
+    std::string imageResultParams(const std::string& service, const ImageJob& job) const {
+        // O resultado depende também do motor (e do filtro, no motor interno)
+        std::string engine = config_.image_engine == ImageEngine::Native
+            ? std::string("native/") + resizeFilterName(config_.resize_filter) : "convert";
+        return service + "\n" + job.result_params + "\nengine=" + engine;
+    }
+
+    // Limite de pixels decodificados pelo motor nativo (--image-max-megapixels)
+    size_t imageMaxPixels() const { return config_.image_max_megapixels * 1000000; }
+
+    // Valida o formato pedido e monta o job do ConvertImageFormat
+    Status prepareConvertJob(ImageJob& job, const std::string& format, const std::string& service) {
+        if (!isValidFormat(format)) {
+            logOperation(service, "ERROR", "Formato de saída inválido: " + format);
+            return Status(grpc::StatusCode::INVALID_ARGUMENT, "Formato de saída inválido.");
         }
-        temp_file.close();
+        job.input_path = generateUniqueFilename("input_convert");
+        job.output_path = job.input_path + "_out." + format;
+        ImageOperation operation;
+        operation.output_format = format;
+        job.operations.push_back(operation);
+        job.result_params = "format=" + format;
+        return Status::OK;
+    }
 
-        std::string command = "pdftotext " + input_path + " " + output_path;
-        int result = std::system(command.c_str());
+    // Valida as dimensões pedidas e monta o job do ResizeImage
+    Status prepareResizeJob(ImageJob& job, int width, int height, const std::string& service) {
+        if (width <= 0 || height <= 0) {
+            logOperation(service, "ERROR", "Dimensões inválidas: " + std::to_string(width) + "x" + std::to_string(height));
+            return Status(grpc::StatusCode::INVALID_ARGUMENT, "Largura e altura devem ser positivas.");
+        }
+        job.input_path = generateUniqueFilename("input_resize");
+        job.output_path = job.input_path + "_out";
+        ImageOperation operation;
+        operation.width = width;
+        operation.height = height;
+        operation.filter = config_.resize_filter;
+        job.operations.push_back(operation);
+        job.convert_ops = {"-resize", std::to_string(width) + "x" + std::to_string(height) + "!"};
+        job.result_params = "size=" + std::to_string(width) + "x" + std::to_string(height);
+        return Status::OK;
+    }
 
-        if (result == 0) {
-            if (!sendFile(stream, output_path)) {
-                logOperation("ConvertToTXT", "ERROR", "Falha ao enviar arquivo de texto.");
-                return Status(grpc::StatusCode::INTERNAL, "Erro ao enviar arquivo de saída.");
+    // Valida as saídas pedidas e monta o job do ResizeImage com vários tamanhos. No convert, as
+    // saídas saem de um único comando: a entrada é lida uma vez e cada redimensionamento parte da
+    // imagem guardada em memória (mpr:) escolhida por planImageOutputs.
+    Status prepareResizeOutputsJob(ImageJob& job, const ResizeOutputs& request, const std::string& service) {
+        if (request.outputs_size() == 0 || request.outputs_size() > kMaxResizeOutputs) {
+            logOperation(service, "ERROR", "Número de saídas inválido: " + std::to_string(request.outputs_size()));
+            return Status(grpc::StatusCode::INVALID_ARGUMENT,
+                          "Informe entre 1 e " + std::to_string(kMaxResizeOutputs) + " saídas.");
+        }
+        job.input_path = generateUniqueFilename("input_resize");
+        for (const auto& output : request.outputs()) {
+            int width = output.dimensions().width();
+            int height = output.dimensions().height();
+            if (width <= 0 || height <= 0) {
+                logOperation(service, "ERROR", "Dimensões inválidas: " + std::to_string(width) + "x" + std::to_string(height));
+                return Status(grpc::StatusCode::INVALID_ARGUMENT, "Largura e altura devem ser positivas.");
             }
-            logOperation("ConvertToTXT", "SUCCESS", "Arquivo convertido e enviado com sucesso.");
-        } else {
-            logOperation("ConvertToTXT", "ERROR", "Falha na execução do pdftotext. Código: " + std::to_string(result));
-            return Status(grpc::StatusCode::INTERNAL, "Falha ao converter PDF para TXT.");
+            if (!output.format().empty() && !isValidFormat(output.format())) {
+                logOperation(service, "ERROR", "Formato de saída inválido: " + output.format());
+                return Status(grpc::StatusCode::INVALID_ARGUMENT, "Formato de saída inválido.");
+            }
+            ImageOperation operation;
+            operation.output_format = output.format();
+            operation.width = width;
+            operation.height = height;
+            operation.filter = config_.resize_filter;
+            std::string path = job.input_path + "_out" + std::to_string(job.operations.size());
+            if (!output.format().empty()) path += "." + output.format();
+            job.operations.push_back(operation);
+            job.output_paths.push_back(path);
         }
 
-        std::remove(input_path.c_str());
-        std::remove(output_path.c_str());
+        std::vector<ImageOutputStep> steps = planImageOutputs(job.operations);
+        job.convert_ops = {"-write", "mpr:src", "+delete"};
+        for (size_t i = 0; i < steps.size(); ++i) {
+            const ImageOperation& operation = job.operations[steps[i].output];
+            job.convert_ops.push_back(steps[i].source < 0 ? "mpr:src" : "mpr:out" + std::to_string(steps[i].source));
+            job.convert_ops.push_back("-resize");
+            job.convert_ops.push_back(std::to_string(operation.width) + "x" + std::to_string(operation.height) + "!");
+            if (i + 1 < steps.size()) {
+                job.convert_ops.insert(job.convert_ops.end(), {"-write", "mpr:out" + std::to_string(steps[i].output),
+                                                               "-write", job.output_paths[steps[i].output], "+delete"});
+            }
+        }
+        job.output_path = job.output_paths[steps.back().output];
         return Status::OK;
     }
 
-    Status ConvertImageFormat(ServerContext* context, ServerReaderWriter<ConvertImageRequest, FileChunk>* stream) override {
-        logOperation("ConvertImageFormat", "INFO", "Requisição recebida.");
-        
-        ConvertImageRequest request;
-        if (!stream->Read(&request) || !request.has_output_format()) {
-            logOperation("ConvertImageFormat", "ERROR", "Primeira mensagem não continha o formato de saída.");
-            return Status(grpc::StatusCode::INVALID_ARGUMENT, "A primeira mensagem deve conter o formato de saída.");
-        }
-        std::string format = request.output_format();
+    // Abre a entrada de uma chamada de imagem: memória no motor interno, stdin do convert no modo
+    // streaming ou spool em disco. Sem result_params o resultado não é compartilhado.
+    template <typename Request>
+    Status openImageInput(TransferReactor<Request>& reactor, ImageJob& job, const std::string& service,
+                          const std::string& result_params) {
+        reactor.removeOnDone(job.input_path);
+        reactor.removeOnDone(job.output_path);
+        for (const auto& path : job.output_paths) reactor.removeOnDone(path);
+        if (!result_params.empty()) reactor.shareResults(result_params);
 
-        std::string input_path = generateUniqueFilename("input_convert");
-        std::string output_path = input_path + "_out." + format;
-        
-        std::ofstream temp_file(input_path, std::ios::binary);
-        if(!temp_file.is_open()){
-            logOperation("ConvertImageFormat", "ERROR", "Falha ao criar arquivo temporário.");
+        std::unique_ptr<InputSink> sink;
+        if (config_.image_engine == ImageEngine::Native) {
+            sink = openMemorySink(job.input);
+        } else if (config_.stream_input) {
+            // No modo streaming o convert lê a imagem do stdin ("-") enquanto o upload ainda chega
+            sink = openPipeSink(job.convertCommand("-"));
+        } else {
+            sink = openSpoolSink(job.input_path, job.convertCommand(job.input_path));
+        }
+        if (!sink) {
+            logOperation(service, "ERROR", "Falha ao criar arquivo temporário.");
             return Status(grpc::StatusCode::INTERNAL, "Erro ao salvar arquivo de entrada.");
         }
+        reactor.setInput(std::move(sink));
+        return Status::OK;
+    }
 
-        // Continua a ler o restante dos chunks de conteúdo
-        while (stream->Read(&request)) {
-            temp_file.write(request.content().c_str(), request.content().length());
+    // Conclui uma chamada de imagem no executor. O motor interno processa o upload em memória;
+    // formatos que ele não suporta seguem para o convert. done_message descreve o resultado no log.
+    template <typename Request>
+    Status processImage(TransferReactor<Request>& reactor, ImageJob& job, const std::string& service,
+                        const std::string& done_message, const std::string& failure_message) {
+        int result = reactor.finishInput();
+        if (config_.image_engine == ImageEngine::Native) {
+            std::string output, error;
+            ImageResult native = runNativeImage(job.input, job.operations, output, error, imageMaxPixels());
+            if (native == ImageResult::Ok) {
+                reactor.sendBuffer(std::move(output));
+                reactor.setSuccessMessage(done_message + " (motor interno) e enviada com sucesso.");
+                return Status::OK;
+            }
+            if (native == ImageResult::Failed) {
+                logOperation(service, "ERROR", "Falha no motor de imagens interno: " + error);
+                return Status(grpc::StatusCode::INTERNAL, failure_message);
+            }
+            // Formato fora do motor interno: os bytes já recebidos seguem para o convert
+            result = runOnSpool(reactor, job.input_path, job.input, job.convertCommand(job.input_path));
         }
-        temp_file.close();
 
-        std::string command = "convert " + input_path + " " + output_path;
-        int result = std::system(command.c_str());
+        if (result != 0) {
+            logOperation(service, "ERROR", "Falha na execução do convert. Código: " + std::to_string(result));
+            return Status(grpc::StatusCode::INTERNAL, failure_message);
+        }
+        if (!reactor.sendFile(job.output_path)) {
+            logOperation(service, "ERROR", "Falha ao abrir a imagem de saída para envio.");
+            return Status(grpc::StatusCode::INTERNAL, "Erro ao enviar arquivo de saída.");
+        }
+        reactor.setSuccessMessage(done_message + " e enviada com sucesso.");
+        return Status::OK;
+    }
+
+    // Conclui um ResizeImage com vários tamanhos, enviando cada saída assim que fica pronta, com o
+    // índice dela em FileChunk.output_index
+    template <typename Request>
+    Status processImageOutputs(TransferReactor<Request>& reactor, ImageJob& job, const std::string& service) {
+        const std::string failure_message = "Falha ao redimensionar imagem.";
+        const std::string done_message = "Imagem redimensionada em " + std::to_string(job.operations.size()) + " tamanhos";
+        int result = reactor.finishInput();
+        if (config_.image_engine == ImageEngine::Native) {
+            bool stream_ok = true;
+            auto send = [&](size_t index, const std::string& data) {
+                reactor.setOutputIndex(static_cast<uint32_t>(index));
+                stream_ok = reactor.stream(data.data(), data.size());
+                return stream_ok;
+            };
+            std::string error;
+            ImageResult native = runNativeImageOutputs(job.input, job.operations, send, error, imageMaxPixels());
+            if (native == ImageResult::Ok) {
+                reactor.setSuccessMessage(done_message + " (motor interno) e enviada com sucesso.");
+                return Status::OK;
+            }
+            if (!stream_ok) return Status(grpc::StatusCode::CANCELLED, "O cliente deixou de receber o resultado.");
+            if (native == ImageResult::Failed) {
+                logOperation(service, "ERROR", "Falha no motor de imagens interno: " + error);
+                return Status(grpc::StatusCode::INTERNAL, failure_message);
+            }
+            // Formato fora do motor interno: os bytes já recebidos seguem para o convert
+            result = runOnSpool(reactor, job.input_path, job.input, job.convertCommand(job.input_path));
+        }
 
-        if (result == 0) {
-            // Reusa a função sendFile para FileChunk
-            if (!sendFile(reinterpret_cast<ServerReaderWriter<FileChunk, FileChunk>*>(stream), output_path)) {
-                logOperation("ConvertImageFormat", "ERROR", "Falha ao enviar imagem convertida.");
+        if (result != 0) {
+            logOperation(service, "ERROR", "Falha na execução do convert. Código: " + std::to_string(result));
+            return Status(grpc::StatusCode::INTERNAL, failure_message);
+        }
+        for (size_t i = 0; i < job.output_paths.size(); ++i) {
+            MappedFile file;
+            if (!file.open(job.output_paths[i])) {
+                logOperation(service, "ERROR", "Falha ao abrir a imagem de saída para envio.");
                 return Status(grpc::StatusCode::INTERNAL, "Erro ao enviar arquivo de saída.");
             }
-            logOperation("ConvertImageFormat", "SUCCESS", "Imagem convertida e enviada com sucesso.");
-        } else {
-            logOperation("ConvertImageFormat", "ERROR", "Falha na execução do convert. Código: " + std::to_string(result));
-            return Status(grpc::StatusCode::INTERNAL, "Falha ao converter imagem.");
+            reactor.setOutputIndex(static_cast<uint32_t>(i));
+            if (!reactor.stream(file.data(), file.size())) {
+                return Status(grpc::StatusCode::CANCELLED, "O cliente deixou de receber o resultado.");
+            }
         }
-        
-        std::remove(input_path.c_str());
-        std::remove(output_path.c_str());
+        reactor.setSuccessMessage(done_message + " e enviada com sucesso.");
         return Status::OK;
     }
 
-    Status ResizeImage(ServerContext* context, ServerReaderWriter<ResizeImageRequest, FileChunk>* stream) override {
-        logOperation("ResizeImage", "INFO", "Requisição recebida.");
-        
-        ResizeImageRequest request;
-        if (!stream->Read(&request) || !request.has_dimensions()) {
-            logOperation("ResizeImage", "ERROR", "Primeira mensagem não continha as dimensões.");
-            return Status(grpc::StatusCode::INVALID_ARGUMENT, "A primeira mensagem deve conter as dimensões.");
+    // --- RunPipeline ---
+
+    // Valida as etapas e monta o plano de execução. Etapas de imagem consecutivas viram um único
+    // job: uma decodificação e uma codificação no motor interno, um único convert no externo.
+    Status preparePipeline(const Pipeline& pipeline, PipelinePlan& plan) {
+        if (pipeline.steps_size() == 0 || pipeline.steps_size() > kMaxPipelineSteps) {
+            logOperation("RunPipeline", "ERROR", "Quantidade de etapas inválida: " + std::to_string(pipeline.steps_size()));
+            return Status(grpc::StatusCode::INVALID_ARGUMENT,
+                          "O pipeline deve ter entre 1 e " + std::to_string(kMaxPipelineSteps) + " etapas.");
         }
-        int width = request.dimensions().width();
-        int height = request.dimensions().height();
 
-        std::string input_path = generateUniqueFilename("input_resize");
-        std::string output_path = input_path + "_out";
+        std::vector<std::string> step_params;
+        for (int i = 0; i < pipeline.steps_size(); ++i) {
+            const BatchJob& step = pipeline.steps(i);
+            std::string number = std::to_string(i + 1);
+            bool image_step = step.operation() == CONVERT_IMAGE_FORMAT || step.operation() == RESIZE_IMAGE;
+            if (!image_step && step.operation() != COMPRESS_PDF && step.operation() != CONVERT_TO_TXT) {
+                logOperation("RunPipeline", "ERROR", "Etapa " + number + " sem operação.");
+                return Status(grpc::StatusCode::INVALID_ARGUMENT, "Operação da etapa " + number + " não informada.");
+            }
+            // Imagens e PDFs não se misturam, e nada aceita o texto extraído
+            if (i == 0) plan.image = image_step;
+            if (image_step != plan.image || (i > 0 && pipeline.steps(i - 1).operation() == CONVERT_TO_TXT)) {
+                logOperation("RunPipeline", "ERROR", "Etapa " + number + " incompatível com a anterior.");
+                return Status(grpc::StatusCode::INVALID_ARGUMENT, "A etapa " + number + " não aceita a saída da etapa anterior.");
+            }
 
-        std::ofstream temp_file(input_path, std::ios::binary);
-        if(!temp_file.is_open()){
-            logOperation("ResizeImage", "ERROR", "Falha ao criar arquivo temporário.");
-            return Status(grpc::StatusCode::INTERNAL, "Erro ao salvar arquivo de entrada.");
+            if (!image_step) {
+                plan.pdf_steps.push_back(step.operation());
+                step_params.push_back(step.operation() == COMPRESS_PDF ? pdfResultParams() : textResultParams());
+                continue;
+            }
+
+            ImageJob job;
+            Status status = step.operation() == CONVERT_IMAGE_FORMAT
+                ? prepareConvertJob(job, step.output_format(), "RunPipeline")
+                : prepareResizeJob(job, step.dimensions().width(), step.dimensions().height(), "RunPipeline");
+            if (!status.ok()) return status;
+            step_params.push_back(imageResultParams(step.operation() == CONVERT_IMAGE_FORMAT ? "ConvertImageFormat" : "ResizeImage", job));
+            if (i == 0) {
+                plan.image_job = std::move(job);
+                continue;
+            }
+            // Fusão: as operações se acumulam e a saída fica com o último formato pedido
+            ImageJob& fused = plan.image_job;
+            fused.convert_ops.insert(fused.convert_ops.end(), job.convert_ops.begin(), job.convert_ops.end());
+            fused.operations.insert(fused.operations.end(), job.operations.begin(), job.operations.end());
+            if (step.operation() == CONVERT_IMAGE_FORMAT) fused.output_path = fused.input_path + "_out." + step.output_format();
+        }
+        if (!plan.image) plan.input_path = generateUniqueFilename("input_pipeline");
+
+        // Um pipeline de uma etapa compartilha os resultados com o método equivalente
+        plan.result_params = step_params.size() == 1 ? step_params.front() : "RunPipeline";
+        if (step_params.size() > 1) {
+            for (const auto& params : step_params) plan.result_params += "\n>\n" + params;
+        }
+        return Status::OK;
+    }
+
+    // Intervalos em que as páginas first_page a last_page (0 = até a última) do PDF em path são
+    // processadas em paralelo; vazio se elas são menos que --pdf-split-pages ou se a contagem
+    // falhar (o documento é então processado de uma vez)
+    template <typename Request>
+    std::vector<PageRange> pageRanges(TransferReactor<Request>& reactor, const std::string& path,
+                                      int first_page = 1, int last_page = 0) {
+        if (config_.pdf_split_pages == 0) return {};
+        std::string error;
+        int last;
+        {
+            TraceSpan span(reactor.trace(), "pdf_page_count", reactor.traceParent());
+            last = pdfPageCount(path, error);
         }
+        if (last_page > 0) last = std::min(last, last_page);
+        int pages = last - first_page + 1;
+        if (pages <= 0 || static_cast<size_t>(pages) < config_.pdf_split_pages) return {};
 
-        while (stream->Read(&request)) {
-            temp_file.write(request.content().c_str(), request.content().length());
+        size_t parallelism = config_.pdf_split_parallelism > 0 ? config_.pdf_split_parallelism : executor_.workers();
+        size_t count = std::min(parallelism, static_cast<size_t>(pages / kMinRangePages));
+        if (count < 2) return {};
+        std::vector<PageRange> ranges;
+        for (size_t i = 0; i < count; ++i) {
+            ranges.push_back(PageRange{first_page + static_cast<int>(pages * i / count),
+                                       first_page + static_cast<int>(pages * (i + 1) / count) - 1});
         }
-        temp_file.close();
+        return ranges;
+    }
+
+    // Comprime as páginas de range (todas, se nullptr) com o pool do Ghostscript ou o gs externo
+    template <typename Request>
+    int compressPdfPages(TransferReactor<Request>& reactor, const std::string& input_path, const std::string& output_path,
+                         const PageRange* range) {
+        if (gs_pool_) return range ? gs_pool_->compress(input_path, output_path, range->first, range->last)
+                                   : gs_pool_->compress(input_path, output_path);
+        ProcessResult result = ProcessSupervisor::instance().spawn(gsCommand(input_path, output_path, range), SpawnOptions()).get();
+        reactor.addToolResult(result);
+        return result.status();
+    }
+
+    // Comprime input_path em output_path. Documentos grandes são divididos em intervalos de páginas
+    // comprimidos em paralelo no executor e depois reunidos com o pdfunite; se algo falhar nesse
+    // caminho, o documento é comprimido inteiro.
+    template <typename Request>
+    int compressPdf(TransferReactor<Request>& reactor, const std::string& input_path, const std::string& output_path) {
+        std::vector<PageRange> ranges = pageRanges(reactor, input_path);
+        if (ranges.empty()) return compressPdfPages(reactor, input_path, output_path, nullptr);
 
-        std::string command = "convert " + input_path + " -resize " + std::to_string(width) + "x" + std::to_string(height) + "! " + output_path;
-        int result = std::system(command.c_str());
+        TraceSpan span(reactor.trace(), "pdf_split", reactor.traceParent());
+        if (reactor.trace()) reactor.trace()->attribute(span.id(), "pdf.ranges", static_cast<int64_t>(ranges.size()));
+        std::vector<std::string> parts(ranges.size());
+        std::vector<int> results(ranges.size(), 0);
+        for (size_t i = 0; i < ranges.size(); ++i) {
+            parts[i] = output_path + "_part" + std::to_string(i) + ".pdf";
+            reactor.removeOnDone(parts[i]);
+        }
+        executor_.parallelFor(ranges.size(), ranges.size(), [&](size_t i) {
+            results[i] = compressPdfPages(reactor, input_path, parts[i], &ranges[i]);
+        });
 
+        // Códigos negativos (erros do gs, falha no spawn) também são falhas: vale o primeiro não nulo
+        auto failed = std::find_if(results.begin(), results.end(), [](int code) { return code != 0; });
+        int result = failed == results.end() ? 0 : *failed;
         if (result == 0) {
-            if (!sendFile(reinterpret_cast<ServerReaderWriter<FileChunk, FileChunk>*>(stream), output_path)) {
-                logOperation("ResizeImage", "ERROR", "Falha ao enviar imagem redimensionada.");
-                return Status(grpc::StatusCode::INTERNAL, "Erro ao enviar arquivo de saída.");
+            std::vector<std::string> merge = {"pdfunite"};
+            merge.insert(merge.end(), parts.begin(), parts.end());
+            merge.push_back(output_path);
+            ProcessResult merged = ProcessSupervisor::instance().spawn(merge, SpawnOptions()).get();
+            reactor.addToolResult(merged);
+            if (merged.ok()) return 0;
+            result = merged.status();
+        }
+        logOperation(reactor.service(), "WARNING", "Falha ao comprimir o PDF em " + std::to_string(ranges.size()) +
+                                                       " intervalos (código " + std::to_string(result) + "); comprimindo o documento inteiro.");
+        return compressPdfPages(reactor, input_path, output_path, nullptr);
+    }
+
+    // Executa as etapas de PDF sobre o spool: cada compressão grava o arquivo lido pela etapa seguinte,
+    // e o resultado final é enviado direto do disco (ou, no caso do texto, conforme é extraído)
+    Status processPdfPipeline(TransferReactor<PipelineRequest>& reactor, const PipelinePlan& plan) {
+        reactor.finishInput();
+        for (size_t i = 0; i < plan.pdf_steps.size(); ++i) {
+            if (plan.pdf_steps[i] == CONVERT_TO_TXT) {
+                Status status = sendPdfText(reactor, plan.pdfPath(i), "RunPipeline");
+                if (status.ok()) reactor.setSuccessMessage("Pipeline executado e texto enviado com sucesso.");
+                return status;
+            }
+            int result = compressPdf(reactor, plan.pdfPath(i), plan.pdfPath(i + 1));
+            if (result != 0) {
+                logOperation("RunPipeline", "ERROR", "Falha na execução do Ghostscript na etapa " + std::to_string(i + 1) +
+                                                         ". Código: " + std::to_string(result));
+                return Status(grpc::StatusCode::INTERNAL, "Falha ao comprimir PDF.");
             }
-            logOperation("ResizeImage", "SUCCESS", "Imagem redimensionada e enviada com sucesso.");
+        }
+        if (!reactor.sendFile(plan.pdfPath(plan.pdf_steps.size()))) {
+            logOperation("RunPipeline", "ERROR", "Falha ao enviar o PDF resultante.");
+            return Status(grpc::StatusCode::INTERNAL, "Erro ao enviar arquivo de saída.");
+        }
+        reactor.setSuccessMessage("Pipeline executado e arquivo enviado com sucesso.");
+        return Status::OK;
+    }
+
+    // --- ProcessBatch ---
+
+    // Grava a entrada de um job do lote no spool de sink e executa a ferramenta (ou o motor) dele
+    int runBatchSink(std::unique_ptr<InputSink> sink, const std::string& input) {
+        if (!sink) return -1;
+        sink->write(input.data(), input.size());
+        int result = sink->finish();
+        if (const ProcessResult* tool = sink->toolResult()) {
+            if (MethodMetrics* metrics = metrics_.method("ProcessBatch")) metrics->addToolUsage(tool->usage);
+        }
+        return result;
+    }
+
+    Status batchCompress(const std::string& input, std::string& output) {
+        std::string input_path = generateUniqueFilename("input_compress");
+        std::string output_path = input_path + "_out.pdf";
+        int result = gs_pool_
+            ? runBatchSink(openSpoolSink(input_path, [this, input_path, output_path]() { return gs_pool_->compress(input_path, output_path); }), input)
+            : runBatchSink(openSpoolSink(input_path, gsCommand(input_path, output_path)), input);
+        bool read = result == 0 && readFile(output_path, output);
+        std::remove(input_path.c_str());
+        std::remove(output_path.c_str());
+        if (result != 0) {
+            logOperation("ProcessBatch", "ERROR", "Falha na execução do Ghostscript. Código: " + std::to_string(result));
+            return Status(grpc::StatusCode::INTERNAL, "Falha ao comprimir PDF.");
+        }
+        if (!read) return Status(grpc::StatusCode::INTERNAL, "Erro ao ler arquivo de saída.");
+        return Status::OK;
+    }
+
+    Status batchText(const std::string& input, std::string& output) {
+        std::string input_path = generateUniqueFilename("input_totext");
+        std::string output_path = input_path + "_out.txt";
+        std::string error;
+        int result;
+        if (pdfTextAvailable()) {
+            result = runBatchSink(openSpoolSink(input_path, []() { return 0; }), input);
+            auto append_page = [&output](const std::string& text) {
+                output += text;
+                return true;
+            };
+            if (result == 0) result = extractPdfText(input_path, append_page, error) ? 0 : 1;
         } else {
-            logOperation("ResizeImage", "ERROR", "Falha na execução do convert. Código: " + std::to_string(result));
-            return Status(grpc::StatusCode::INTERNAL, "Falha ao redimensionar imagem.");
+            result = runBatchSink(openSpoolSink(input_path, {"pdftotext", input_path, output_path}), input);
+            if (result == 0 && !readFile(output_path, output)) result = -1;
         }
-        
         std::remove(input_path.c_str());
         std::remove(output_path.c_str());
+        if (result != 0) {
+            logOperation("ProcessBatch", "ERROR", "Falha na extração de texto. Código: " + std::to_string(result) +
+                                                      (error.empty() ? "" : " (" + error + ")"));
+            return Status(grpc::StatusCode::INTERNAL, "Falha ao converter PDF para TXT.");
+        }
         return Status::OK;
     }
+
+    // Motor interno direto da memória ou, para o que ele não suporta, convert sobre um spool
+    Status batchImage(const ImageJob& job, const std::string& input, std::string& output, const std::string& failure_message) {
+        if (config_.image_engine == ImageEngine::Native) {
+            std::string error;
+            ImageResult native = runNativeImage(input, job.operations, output, error, imageMaxPixels());
+            if (native == ImageResult::Ok) return Status::OK;
+            if (native == ImageResult::Failed) {
+                logOperation("ProcessBatch", "ERROR", "Falha no motor de imagens interno: " + error);
+                return Status(grpc::StatusCode::INTERNAL, failure_message);
+            }
+        }
+        int result = runBatchSink(openSpoolSink(job.input_path, job.convertCommand(job.input_path)), input);
+        bool read = result == 0 && readFile(job.output_path, output);
+        std::remove(job.input_path.c_str());
+        std::remove(job.output_path.c_str());
+        if (result != 0) {
+            logOperation("ProcessBatch", "ERROR", "Falha na execução do convert. Código: " + std::to_string(result));
+            return Status(grpc::StatusCode::INTERNAL, failure_message);
+        }
+        if (!read) return Status(grpc::StatusCode::INTERNAL, "Erro ao ler arquivo de saída.");
+        return Status::OK;
+    }
+
+    // Executa um job do lote no executor. A chave do cache é a mesma das chamadas individuais
+    // (parâmetros do método + conteúdo), então os dois caminhos aproveitam os resultados um do outro.
+    BatchResult runBatchJob(const BatchJob& job, const std::string& input) {
+        ImageJob image;
+        std::string params;
+        Status status;
+        switch (job.operation()) {
+            case COMPRESS_PDF:
+                params = pdfResultParams();
+                break;
+            case CONVERT_TO_TXT:
+                params = textResultParams();
+                break;
+            case CONVERT_IMAGE_FORMAT:
+                status = prepareConvertJob(image, job.output_format(), "ProcessBatch");
+                params = imageResultParams("ConvertImageFormat", image);
+                break;
+            case RESIZE_IMAGE:
+                status = prepareResizeJob(image, job.dimensions().width(), job.dimensions().height(), "ProcessBatch");
+                params = imageResultParams("ResizeImage", image);
+                break;
+            default:
+                return BatchResult{Status(grpc::StatusCode::INVALID_ARGUMENT, "Operação do job não informada."), nullptr};
+        }
+        if (!status.ok()) return BatchResult{status, nullptr};
+
+        std::string key;
+        if (cache_.enabled()) {
+            ContentHash hash;
+            hash.update(params);
+            hash.update("\n", 1);
+            hash.update(input);
+            key = hash.finish();
+            ResultCache::Hit hit;
+            if (cache_.lookup(key, hit)) {
+                if (hit.data) return BatchResult{Status::OK, hit.data};
+                std::string data;
+                if (readFile(hit.path, data)) return BatchResult{Status::OK, std::make_shared<const std::string>(std::move(data))};
+            }
+        }
+
+        std::string output;
+        switch (job.operation()) {
+            case COMPRESS_PDF: status = batchCompress(input, output); break;
+            case CONVERT_TO_TXT: status = batchText(input, output); break;
+            case CONVERT_IMAGE_FORMAT: status = batchImage(image, input, output, "Falha ao converter imagem."); break;
+            default: status = batchImage(image, input, output, "Falha ao redimensionar imagem."); break;
+        }
+        if (!status.ok()) return BatchResult{status, nullptr};
+
+        auto data = std::make_shared<const std::string>(std::move(output));
+        if (!key.empty() && cache_.accepts(data->size())) {
+            executor_.post([this, key, data]() { cache_.store(key, data); });
+        }
+        return BatchResult{Status::OK, data};
+    }
+
+public:
+    explicit FileProcessorServiceImpl(const ServerConfig& config) : config_(config),
+          started_at_(std::chrono::steady_clock::now()), metrics_(kTransferMethods),
+          cache_(config.cache_memory_mb << 20, config.cache_dir, config.cache_disk_mb << 20),
+          uploads_(config.upload_dir, std::chrono::seconds(config.upload_ttl_s), static_cast<uint64_t>(config.upload_max_mb) * 1024 * 1024), executor_(config.workers) {
+        // As instâncias do Ghostscript são aquecidas aqui, antes de o servidor aceitar conexões
+        if (config_.gs_pool_size > 0) {
+            std::string error;
+            gs_pool_ = GhostscriptPool::create(config_.gs_pool_size, config_.gs_recycle_after, error);
+            if (gs_pool_) {
+                logOperation("CompressPDF", "INFO", "Pool do Ghostscript iniciado com " + std::to_string(gs_pool_->size()) + " instâncias.");
+            } else {
+                logOperation("CompressPDF", "WARNING", "Pool do Ghostscript indisponível, usando o gs externo. " + error);
+            }
+        }
+        if (config_.image_engine == ImageEngine::Native) {
+            logOperation("ResizeImage", "INFO", std::string("Motor de imagens interno ativo, kernel de redimensionamento: ") +
+                                                    resizeKernelName(ResizeKernel::Auto) + ".");
+        }
+        for (const auto& method : kTransferMethods) {
+            admission_.configure(method, config_.admissionFor(method));
+        }
+        if (cache_.enabled()) {
+            ResultCache::Stats stats = cache_.stats();
+            logOperation("Servidor", "INFO", "Cache de resultados: " + std::to_string(config_.cache_memory_mb) + " MB em memória" +
+                                                 (config_.cache_dir.empty() ? "" : ", " + std::to_string(config_.cache_disk_mb) + " MB em " +
+                                                  config_.cache_dir + " (" + std::to_string(stats.disk_entries) + " resultados)") + ".");
+        }
+        if (!config_.trace.file.empty()) {
+            std::string error;
+            tracer_ = Tracer::create(config_.trace, error);
+            if (tracer_) {
+                logOperation("Servidor", "INFO", "Rastros gravados em " + config_.trace.file + " (amostragem " +
+                                                     std::to_string(config_.trace.sample_rate) + ").");
+            } else {
+                logOperation("Servidor", "WARNING", "Rastreamento desativado, não foi possível abrir " + config_.trace.file + ": " + error);
+            }
+        }
+        logOperation("Servidor", "INFO", "Executor iniciado com " + std::to_string(executor_.workers()) + " threads de processamento.");
+        if (!config_.metrics_address.empty()) {
+            std::string error;
+            metrics_http_ = MetricsHttpServer::start(config_.metrics_address,
+                                                     [this]() { return metrics_.renderPrometheus(runtimeStats()); }, error);
+            if (metrics_http_) {
+                logOperation("Servidor", "INFO", "Métricas disponíveis em http://" + config_.metrics_address + "/metrics.");
+            } else {
+                logOperation("Servidor", "WARNING", "Endpoint de métricas indisponível em " + config_.metrics_address + ": " + error);
+            }
+        }
+    }
+
+    ServerUnaryReactor* GetStats(CallbackServerContext* context, const StatsRequest*, StatsReply* reply) override {
+        metrics_.fillStatsReply(runtimeStats(), *reply);
+        ServerUnaryReactor* reactor = context->DefaultReactor();
+        reactor->Finish(Status::OK);
+        return reactor;
+    }
+
+    ServerUnaryReactor* GetUploadStatus(CallbackServerContext* context, const UploadStatusRequest* request,
+                                        UploadStatusReply* reply) override {
+        UploadStore::Status status;
+        if (uploads_.status(request->upload_id(), status)) {
+            reply->set_found(true);
+            reply->set_committed_bytes(status.size);
+            reply->set_crc32c(status.crc32c);
+            reply->set_expires_in_ms(status.expires_in_ms);
+        }
+        ServerUnaryReactor* reactor = context->DefaultReactor();
+        reactor->Finish(Status::OK);
+        return reactor;
+    }
+
+    ServerBidiReactor<FileChunk, FileChunk>* CompressPDF(CallbackServerContext* context) override {
+        std::string input_path = generateUniqueFilename("input_compress");
+        std::string output_path = input_path + "_out.pdf";
+
+        auto start = [this, input_path, output_path](TransferReactor<FileChunk>& reactor, const FileChunk&) {
+            reactor.removeOnDone(input_path);
+            reactor.removeOnDone(output_path);
+            reactor.shareResults(pdfResultParams());
+
+            // O Ghostscript precisa de acesso aleatório ao PDF, então a entrada sempre vai para o spool;
+            // a compressão roda em process, que decide se o documento é dividido em intervalos
+            auto sink = openSpoolSink(input_path, []() { return 0; });
+            if (!sink) {
+                logOperation("CompressPDF", "ERROR", "Falha ao criar arquivo temporário de entrada.");
+                return Status(grpc::StatusCode::INTERNAL, "Erro ao salvar arquivo de entrada.");
+            }
+            reactor.setInput(std::move(sink));
+            return Status::OK;
+        };
+
+        auto process = [this, input_path, output_path](TransferReactor<FileChunk>& reactor) {
+            int result = reactor.finishInput();
+            if (result == 0) result = compressPdf(reactor, input_path, output_path);
+            if (result != 0) {
+                logOperation("CompressPDF", "ERROR", "Falha na execução do Ghostscript. Código: " + std::to_string(result));
+                return Status(grpc::StatusCode::INTERNAL, "Falha ao comprimir PDF.");
+            }
+            if (!reactor.sendFile(output_path)) {
+                logOperation("CompressPDF", "ERROR", "Falha ao enviar arquivo comprimido.");
+                return Status(grpc::StatusCode::INTERNAL, "Erro ao enviar arquivo de saída.");
+            }
+            reactor.setSuccessMessage("Arquivo comprimido e enviado com sucesso.");
+            return Status::OK;
+        };
+
+        return transfer<FileChunk>(context, "CompressPDF", start, process);
+    }
+
+    ServerBidiReactor<ConvertTextRequest, FileChunk>* ConvertToTXT(CallbackServerContext* context) override {
+        std::string input_path = generateUniqueFilename("input_totext");
+        auto selection = std::make_shared<TextSelection>();
+
+        // A extração precisa de um arquivo pesquisável como entrada, mas o texto é enviado
+        // conforme é produzido: o primeiro chunk não espera o documento inteiro
+        auto start = [this, input_path, selection](TransferReactor<ConvertTextRequest>& reactor, const ConvertTextRequest& request) {
+            if (request.has_options()) {
+                const TextOptions& options = request.options();
+                if (options.last_page() > 0 && options.last_page() < options.first_page()) {
+                    logOperation("ConvertToTXT", "ERROR", "Intervalo de páginas inválido: " + std::to_string(options.first_page()) +
+                                                              "-" + std::to_string(options.last_page()));
+                    return Status(grpc::StatusCode::INVALID_ARGUMENT, "A última página deve vir depois da primeira.");
+                }
+                if (options.first_page() > kMaxTextPage || options.last_page() > kMaxTextPage) {
+                    return Status(grpc::StatusCode::INVALID_ARGUMENT, "Página fora do intervalo aceito.");
+                }
+                selection->first_page = std::max(1, static_cast<int>(options.first_page()));
+                selection->last_page = static_cast<int>(options.last_page());
+                selection->max_chars = options.max_chars();
+            }
+            reactor.removeOnDone(input_path);
+            reactor.shareResults(textResultParams(*selection));
+            auto sink = openSpoolSink(input_path, []() { return 0; });
+            if (!sink) {
+                 logOperation("ConvertToTXT", "ERROR", "Falha ao salvar arquivo temporário.");
+                 return Status(grpc::StatusCode::INTERNAL, "Erro ao salvar arquivo de entrada.");
+            }
+            reactor.setInput(std::move(sink));
+            return Status::OK;
+        };
+
+        auto process = [this, input_path, selection](TransferReactor<ConvertTextRequest>& reactor) {
+            reactor.finishInput();
+            Status status = sendPdfText(reactor, input_path, "ConvertToTXT", *selection);
+            if (status.ok()) reactor.setSuccessMessage("Arquivo convertido e enviado com sucesso.");
+            return status;
+        };
+
+        return transfer<ConvertTextRequest>(context, "ConvertToTXT", start, process);
+    }
+
+    ServerBidiReactor<ConvertImageRequest, FileChunk>* ConvertImageFormat(CallbackServerContext* context) override {
+        auto job = std::make_shared<ImageJob>();
+
+        auto start = [this, job](TransferReactor<ConvertImageRequest>& reactor, const ConvertImageRequest& request) {
+            if (!request.has_output_format()) {
+                logOperation("ConvertImageFormat", "ERROR", "Primeira mensagem não continha o formato de saída.");
+                return Status(grpc::StatusCode::INVALID_ARGUMENT, "A primeira mensagem deve conter o formato de saída.");
+            }
+            Status status = prepareConvertJob(*job, request.output_format(), "ConvertImageFormat");
+            if (!status.ok()) return status;
+            return openImageInput(reactor, *job, "ConvertImageFormat", imageResultParams("ConvertImageFormat", *job));
+        };
+
+        auto process = [this, job](TransferReactor<ConvertImageRequest>& reactor) {
+            return processImage(reactor, *job, "ConvertImageFormat", "Imagem convertida", "Falha ao converter imagem.");
+        };
+
+        return transfer<ConvertImageRequest>(context, "ConvertImageFormat", start, process);
+    }
+
+    ServerBidiReactor<ResizeImageRequest, FileChunk>* ResizeImage(CallbackServerContext* context) override {
+        auto job = std::make_shared<ImageJob>();
+
+        auto start = [this, job](TransferReactor<ResizeImageRequest>& reactor, const ResizeImageRequest& request) {
+            if (request.has_outputs()) {
+                // O resultado são vários arquivos intercalados por índice: não passa pelo cache
+                Status status = prepareResizeOutputsJob(*job, request.outputs(), "ResizeImage");
+                if (!status.ok()) return status;
+                return openImageInput(reactor, *job, "ResizeImage", "");
+            }
+            if (!request.has_dimensions()) {
+                logOperation("ResizeImage", "ERROR", "Primeira mensagem não continha as dimensões.");
+                return Status(grpc::StatusCode::INVALID_ARGUMENT, "A primeira mensagem deve conter as dimensões.");
+            }
+            Status status = prepareResizeJob(*job, request.dimensions().width(), request.dimensions().height(), "ResizeImage");
+            if (!status.ok()) return status;
+            return openImageInput(reactor, *job, "ResizeImage", imageResultParams("ResizeImage", *job));
+        };
+
+        auto process = [this, job](TransferReactor<ResizeImageRequest>& reactor) {
+            if (!job->output_paths.empty()) return processImageOutputs(reactor, *job, "ResizeImage");
+            return processImage(reactor, *job, "ResizeImage", "Imagem redimensionada", "Falha ao redimensionar imagem.");
+        };
+
+        return transfer<ResizeImageRequest>(context, "ResizeImage", start, process);
+    }
+
+    ServerBidiReactor<PipelineRequest, FileChunk>* RunPipeline(CallbackServerContext* context) override {
+        auto plan = std::make_shared<PipelinePlan>();
+
+        auto start = [this, plan](TransferReactor<PipelineRequest>& reactor, const PipelineRequest& request) {
+            if (!request.has_pipeline()) {
+                logOperation("RunPipeline", "ERROR", "Primeira mensagem não continha as etapas.");
+                return Status(grpc::StatusCode::INVALID_ARGUMENT, "A primeira mensagem deve conter as etapas do pipeline.");
+            }
+            Status status = preparePipeline(request.pipeline(), *plan);
+            if (!status.ok()) return status;
+            if (plan->image) return openImageInput(reactor, plan->image_job, "RunPipeline", plan->result_params);
+
+            // O Ghostscript e a extração de texto leem arquivos, então os intermediários de PDF ficam no spool
+            for (size_t i = 0; i <= plan->pdf_steps.size(); ++i) reactor.removeOnDone(plan->pdfPath(i));
+            reactor.shareResults(plan->result_params);
+            auto sink = openSpoolSink(plan->input_path, []() { return 0; });
+            if (!sink) {
+                logOperation("RunPipeline", "ERROR", "Falha ao criar arquivo temporário de entrada.");
+                return Status(grpc::StatusCode::INTERNAL, "Erro ao salvar arquivo de entrada.");
+            }
+            reactor.setInput(std::move(sink));
+            return Status::OK;
+        };
+
+        auto process = [this, plan](TransferReactor<PipelineRequest>& reactor) {
+            if (!plan->image) return processPdfPipeline(reactor, *plan);
+            return processImage(reactor, plan->image_job, "RunPipeline", "Imagem processada pelo pipeline", "Falha ao executar o pipeline.");
+        };
+
+        return transfer<PipelineRequest>(context, "RunPipeline", start, process);
+    }
+
+    ServerBidiReactor<BatchRequest, BatchResponse>* ProcessBatch(CallbackServerContext* context) override {
+        logOperation("ProcessBatch", "INFO", "Requisição recebida.");
+        std::unique_ptr<CallTrace> trace = startTrace(context, "ProcessBatch");
+        size_t parallelism = config_.batch_parallelism > 0 ? config_.batch_parallelism : executor_.workers();
+        auto* reactor = new BatchReactor(executor_, config_.chunk_size, parallelism, config_.batch_max_job_mb << 20,
+                                         metrics_.method("ProcessBatch"),
+                                         [this](const BatchJob& job, const std::string& input) { return runBatchJob(job, input); });
+        reactor->setCompression(negotiateCompression(context, trace.get()), config_.zstd_level);
+        if (trace) reactor->setTrace(std::move(trace));
+        admit(context, "ProcessBatch", reactor);
+        return reactor;
+    }
 };
 
-void RunServer() {
-    std::string server_address("0.0.0.0:50051");
-    FileProcessorServiceImpl service;
+void RunServer(const ServerConfig& config) {
+    std::string server_address(config.address);
+    FileProcessorServiceImpl service(config);
 
     ServerBuilder builder;
     builder.AddListeningPort(server_address, grpc::InsecureServerCredentials());
@@ -245,6 +1160,17 @@ void RunServer() {
 }
 
 int main(int argc, char** argv) {
-    RunServer();
+    ServerConfig config;
+    std::string error;
+    if (!parseServerConfig(argc, argv, config, error)) {
+        std::cerr << error << std::endl << serverUsage(argv[0]);
+        return 1;
+    }
+    configureLogging(config.log);
+
+    // Se uma ferramenta encerrar antes de ler todo o stdin, a escrita no pipe deve falhar com EPIPE em vez de derrubar o servidor
+    std::signal(SIGPIPE, SIG_IGN);
+
+    RunServer(config);
     return 0;
-}
\ No newline at end of file
+}
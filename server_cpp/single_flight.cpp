@@ -0,0 +1,36 @@
+#include "single_flight.h"
+
+bool SingleFlight::join(const std::string& key, Callback on_result) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = flights_.find(key);
+    if (it == flights_.end()) {
+        flights_.emplace(key, std::vector<Callback>());
+        return true;
+    }
+    it->second.push_back(std::move(on_result));
+    return false;
+}
+
+bool SingleFlight::hasFollowers(const std::string& key) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = flights_.find(key);
+    return it != flights_.end() && !it->second.empty();
+}
+
+void SingleFlight::complete(const std::string& key, std::shared_ptr<const std::string> result) {
+    std::vector<Callback> followers;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = flights_.find(key);
+        if (it == flights_.end()) return;
+        followers = std::move(it->second);
+        flights_.erase(it);
+        if (result) coalesced_ += followers.size();
+    }
+    for (auto& follower : followers) follower(result);
+}
+
+uint64_t SingleFlight::coalesced() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return coalesced_;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Junta chamadas idênticas em andamento: a primeira com uma chave (hash da entrada e dos
+// parâmetros) executa o job; as que chegam enquanto ela roda esperam o resultado dela em vez
+// de executar a mesma ferramenta de novo.
+class SingleFlight {
+public:
+    // Recebe o resultado do líder, ou nullptr se ele falhou ou não pôde compartilhar a saída
+    // (nesse caso quem esperava executa o próprio job)
+    using Callback = std::function<void(std::shared_ptr<const std::string> result)>;
+
+    // Retorna true se a chamada é a líder de key e deve executar o job. Caso contrário,
+    // on_result é guardado e chamado por complete, na thread do líder.
+    bool join(const std::string& key, Callback on_result);
+
+    // Indica se há chamadas esperando por key
+    bool hasFollowers(const std::string& key);
+
+    // Publica o resultado do líder de key e libera quem estava esperando
+    void complete(const std::string& key, std::shared_ptr<const std::string> result);
+
+    // Chamadas atendidas com o resultado de outra
+    uint64_t coalesced();
+
+private:
+    std::mutex mutex_;
+    std::unordered_map<std::string, std::vector<Callback>> flights_;
+    uint64_t coalesced_ = 0;
+};
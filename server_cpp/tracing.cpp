@@ -0,0 +1,314 @@
+#include "tracing.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <random>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+
+// Chamadas com muitos chunks não podem fazer o rastro crescer sem limite
+const size_t kMaxSpans = 512;
+
+// Códigos de status de span do OTLP
+const int kSpanStatusOk = 1;
+const int kSpanStatusError = 2;
+// Tipos de span do OTLP
+const int kSpanKindInternal = 1;
+const int kSpanKindServer = 2;
+
+std::mt19937_64& randomEngine() {
+    thread_local std::mt19937_64 engine(std::random_device{}() ^ (static_cast<uint64_t>(std::random_device{}()) << 32));
+    return engine;
+}
+
+template <size_t N>
+std::array<uint8_t, N> randomId() {
+    std::array<uint8_t, N> id{};
+    while (true) {
+        for (size_t i = 0; i < N; i += 8) {
+            uint64_t value = randomEngine()();
+            std::memcpy(id.data() + i, &value, std::min<size_t>(8, N - i));
+        }
+        // Identificadores só com zeros são inválidos no W3C Trace Context
+        for (uint8_t byte : id) {
+            if (byte != 0) return id;
+        }
+    }
+}
+
+template <size_t N>
+std::string toHex(const std::array<uint8_t, N>& id) {
+    static const char digits[] = "0123456789abcdef";
+    std::string text(N * 2, '0');
+    for (size_t i = 0; i < N; ++i) {
+        text[2 * i] = digits[id[i] >> 4];
+        text[2 * i + 1] = digits[id[i] & 0xf];
+    }
+    return text;
+}
+
+template <size_t N>
+bool fromHex(const std::string& text, std::array<uint8_t, N>& id) {
+    if (text.size() != N * 2) return false;
+    bool non_zero = false;
+    for (size_t i = 0; i < N; ++i) {
+        int value = 0;
+        for (size_t j = 0; j < 2; ++j) {
+            char c = text[2 * i + j];
+            int digit = c >= '0' && c <= '9' ? c - '0' : c >= 'a' && c <= 'f' ? c - 'a' + 10 : -1;
+            if (digit < 0) return false;
+            value = value * 16 + digit;
+        }
+        id[i] = static_cast<uint8_t>(value);
+        non_zero = non_zero || value != 0;
+    }
+    return non_zero;
+}
+
+void appendEscaped(std::string& out, const std::string& text) {
+    out += '"';
+    for (char c : text) {
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char escaped[8];
+                    std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                    out += escaped;
+                } else {
+                    out += c;
+                }
+        }
+    }
+    out += '"';
+}
+
+void writeAll(int fd, const std::string& data) {
+    const char* cursor = data.data();
+    size_t remaining = data.size();
+    while (remaining > 0) {
+        ssize_t written = write(fd, cursor, remaining);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return;
+        }
+        cursor += written;
+        remaining -= static_cast<size_t>(written);
+    }
+}
+
+} // namespace
+
+bool parseTraceparent(const std::string& header, std::array<uint8_t, 16>& trace_id, std::array<uint8_t, 8>& span_id,
+                      bool& sampled) {
+    // versão-traceid-spanid-flags, ex.: 00-4bf92f3577b34da6a3ce929d0e0e4736-00f067aa0ba902b7-01
+    if (header.size() < 55 || header.compare(0, 3, "00-") != 0 || header[35] != '-' || header[52] != '-') return false;
+    std::array<uint8_t, 1> flags{};
+    if (!fromHex(header.substr(3, 32), trace_id) || !fromHex(header.substr(36, 16), span_id)) return false;
+    std::string flag_text = header.substr(53, 2);
+    if (flag_text != "00" && !fromHex(flag_text, flags)) return false;
+    sampled = (flags[0] & 1) != 0;
+    return true;
+}
+
+CallTrace::CallTrace(Tracer& tracer, const std::string& name, const std::array<uint8_t, 16>& trace_id,
+                     const std::array<uint8_t, 8>& parent_span, bool has_parent)
+    : tracer_(tracer), name_(name), trace_id_(trace_id), parent_span_(parent_span), has_parent_(has_parent),
+      wall_start_(std::chrono::system_clock::now()), steady_start_(Clock::now()) {
+    spans_.reserve(16);
+    spans_.push_back(Span{name_.c_str(), randomId<8>(), kRoot, steady_start_, Clock::time_point(), {}});
+}
+
+CallTrace::SpanId CallTrace::start(const char* name, SpanId parent) {
+    return add(name, Clock::now(), Clock::time_point(), parent);
+}
+
+void CallTrace::end(SpanId span) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (span < spans_.size()) spans_[span].end = Clock::now();
+}
+
+CallTrace::SpanId CallTrace::add(const char* name, Clock::time_point start, Clock::time_point end, SpanId parent) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (spans_.size() >= kMaxSpans) {
+        ++dropped_spans_;
+        return kNoSpan;
+    }
+    if (parent >= spans_.size()) parent = kRoot;
+    spans_.push_back(Span{name, randomId<8>(), parent, start, end, {}});
+    return spans_.size() - 1;
+}
+
+void CallTrace::attribute(SpanId span, const char* key, const std::string& value) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (span < spans_.size()) spans_[span].attributes.push_back(Attribute{key, value, 0, true});
+}
+
+void CallTrace::attribute(SpanId span, const char* key, int64_t value) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (span < spans_.size()) spans_[span].attributes.push_back(Attribute{key, std::string(), value, false});
+}
+
+void CallTrace::finish(int status_code, const std::string& message) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    spans_[kRoot].end = Clock::now();
+    status_code_ = status_code;
+    status_message_ = message;
+}
+
+std::string CallTrace::traceparent() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return "00-" + toHex(trace_id_) + "-" + toHex(spans_[kRoot].id) + "-01";
+}
+
+std::string CallTrace::toJson() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto unixNanos = [this](Clock::time_point time) {
+        auto since_start = std::chrono::duration_cast<std::chrono::nanoseconds>(time - steady_start_);
+        auto wall = std::chrono::duration_cast<std::chrono::nanoseconds>(wall_start_.time_since_epoch()) + since_start;
+        return std::to_string(wall.count());
+    };
+    const Clock::time_point root_end = spans_[kRoot].end;
+    const std::string trace_id = toHex(trace_id_);
+
+    std::string out = "{\"resourceSpans\":[{\"resource\":{\"attributes\":[{\"key\":\"service.name\","
+                      "\"value\":{\"stringValue\":\"file-processor-server\"}}]},"
+                      "\"scopeSpans\":[{\"scope\":{\"name\":\"file_processor\"},\"spans\":[";
+    for (size_t i = 0; i < spans_.size(); ++i) {
+        const Span& span = spans_[i];
+        if (i > 0) out += ',';
+        out += "{\"traceId\":\"" + trace_id + "\",\"spanId\":\"" + toHex(span.id) + "\"";
+        if (i != kRoot) {
+            out += ",\"parentSpanId\":\"" + toHex(spans_[span.parent].id) + "\"";
+        } else if (has_parent_) {
+            out += ",\"parentSpanId\":\"" + toHex(parent_span_) + "\"";
+        }
+        out += ",\"name\":";
+        appendEscaped(out, span.name);
+        out += ",\"kind\":" + std::to_string(i == kRoot ? kSpanKindServer : kSpanKindInternal);
+        // Spans que não foram fechados (chamada interrompida) terminam junto com a raiz
+        Clock::time_point end = span.end == Clock::time_point() ? root_end : span.end;
+        out += ",\"startTimeUnixNano\":\"" + unixNanos(span.start) + "\",\"endTimeUnixNano\":\"" + unixNanos(end) + "\"";
+
+        std::vector<Attribute> attributes = span.attributes;
+        if (i == kRoot) {
+            attributes.push_back(Attribute{"rpc.grpc.status_code", std::string(), status_code_, false});
+            if (dropped_spans_ > 0) attributes.push_back(Attribute{"spans.dropped", std::string(), static_cast<int64_t>(dropped_spans_), false});
+        }
+        if (!attributes.empty()) {
+            out += ",\"attributes\":[";
+            for (size_t j = 0; j < attributes.size(); ++j) {
+                if (j > 0) out += ',';
+                out += "{\"key\":";
+                appendEscaped(out, attributes[j].key);
+                if (attributes[j].is_text) {
+                    out += ",\"value\":{\"stringValue\":";
+                    appendEscaped(out, attributes[j].text);
+                    out += "}}";
+                } else {
+                    out += ",\"value\":{\"intValue\":\"" + std::to_string(attributes[j].number) + "\"}}";
+                }
+            }
+            out += ']';
+        }
+        if (i == kRoot) {
+            out += ",\"status\":{\"code\":" + std::to_string(status_code_ == 0 ? kSpanStatusOk : kSpanStatusError);
+            if (!status_message_.empty()) {
+                out += ",\"message\":";
+                appendEscaped(out, status_message_);
+            }
+            out += '}';
+        }
+        out += '}';
+    }
+    out += "]}]}]}\n";
+    return out;
+}
+
+std::unique_ptr<Tracer> Tracer::create(const TraceOptions& options, std::string& error) {
+    int fd = open(options.file.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        error = std::strerror(errno);
+        return nullptr;
+    }
+    return std::unique_ptr<Tracer>(new Tracer(options, fd));
+}
+
+Tracer::Tracer(const TraceOptions& options, int fd) : options_(options), fd_(fd) {
+    exporter_ = std::thread([this]() { exportLoop(); });
+}
+
+Tracer::~Tracer() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    ready_.notify_one();
+    exporter_.join();
+    close(fd_);
+}
+
+std::unique_ptr<CallTrace> Tracer::startCall(const std::string& method, const std::string& traceparent) {
+    std::array<uint8_t, 16> trace_id{};
+    std::array<uint8_t, 8> parent_span{};
+    bool sampled = false;
+    bool has_parent = !traceparent.empty() && parseTraceparent(traceparent, trace_id, parent_span, sampled);
+    if (!has_parent) {
+        // Sem contexto do cliente, a decisão é local; a amostragem vale para o rastro inteiro
+        sampled = std::generate_canonical<double, 32>(randomEngine()) < options_.sample_rate;
+        if (!sampled) return nullptr;
+        trace_id = randomId<16>();
+    } else if (!sampled) {
+        return nullptr;
+    }
+    return std::unique_ptr<CallTrace>(new CallTrace(*this, method, trace_id, parent_span, has_parent));
+}
+
+void Tracer::submit(std::unique_ptr<CallTrace> trace) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (queue_.size() >= options_.queue_size) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        queue_.push_back(std::move(trace));
+    }
+    ready_.notify_one();
+}
+
+Tracer::Stats Tracer::stats() const {
+    Stats stats;
+    stats.exported = exported_.load(std::memory_order_relaxed);
+    stats.dropped = dropped_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+// Converte os rastros para JSON fora das threads das chamadas e grava cada lote de uma vez
+void Tracer::exportLoop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        ready_.wait(lock, [this]() { return stopping_ || !queue_.empty(); });
+        std::deque<std::unique_ptr<CallTrace>> batch;
+        batch.swap(queue_);
+        bool stopping = stopping_;
+        lock.unlock();
+
+        std::string text;
+        for (const auto& trace : batch) text += trace->toJson();
+        if (!text.empty()) writeAll(fd_, text);
+        exported_.fetch_add(batch.size(), std::memory_order_relaxed);
+        batch.clear();
+
+        lock.lock();
+        if (stopping && queue_.empty()) return;
+    }
+}
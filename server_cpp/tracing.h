@@ -0,0 +1,156 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct TraceOptions {
+    std::string file;          // arquivo de saída (uma linha OTLP/JSON por chamada); vazio desativa
+    double sample_rate = 0.01; // fração das chamadas sem contexto do cliente que são rastreadas
+    size_t queue_size = 1024;  // chamadas aguardando gravação antes de começar a descartar
+};
+
+class Tracer;
+
+// Rastro de uma chamada: um span raiz com o nome do método e spans filhos para as etapas
+// (fila, recepção, spool, processo, ferramenta, leitura da saída, cada escrita...). Criado só
+// para chamadas amostradas; pode ser usado de várias threads.
+class CallTrace {
+public:
+    using Clock = std::chrono::steady_clock;
+    using SpanId = size_t;
+    static constexpr SpanId kRoot = 0;
+    static constexpr SpanId kNoSpan = static_cast<SpanId>(-1); // span descartado pelo limite
+
+    CallTrace(Tracer& tracer, const std::string& name, const std::array<uint8_t, 16>& trace_id,
+              const std::array<uint8_t, 8>& parent_span, bool has_parent);
+
+    // Abre um span filho de parent; o fim é marcado com end
+    SpanId start(const char* name, SpanId parent = kRoot);
+    void end(SpanId span);
+
+    // Registra um span cujo início e fim já são conhecidos
+    SpanId add(const char* name, Clock::time_point start, Clock::time_point end, SpanId parent = kRoot);
+
+    void attribute(SpanId span, const char* key, const std::string& value);
+    void attribute(SpanId span, const char* key, int64_t value);
+
+    // Encerra o span raiz com o código gRPC da chamada
+    void finish(int status_code, const std::string& message);
+
+    // Contexto W3C do span raiz, para devolver ao cliente
+    std::string traceparent() const;
+
+    Tracer& tracer() { return tracer_; }
+
+private:
+    friend class Tracer;
+
+    struct Attribute {
+        const char* key;
+        std::string text;
+        int64_t number;
+        bool is_text;
+    };
+
+    struct Span {
+        const char* name;
+        std::array<uint8_t, 8> id;
+        SpanId parent;
+        Clock::time_point start;
+        Clock::time_point end;
+        std::vector<Attribute> attributes;
+    };
+
+    // Uma linha no formato do exportador de arquivo do OpenTelemetry (ExportTraceServiceRequest em JSON)
+    std::string toJson() const;
+
+    Tracer& tracer_;
+    std::string name_;
+    std::array<uint8_t, 16> trace_id_;
+    std::array<uint8_t, 8> parent_span_;
+    bool has_parent_;
+    std::chrono::system_clock::time_point wall_start_;
+    Clock::time_point steady_start_;
+    int status_code_ = 0;
+    std::string status_message_;
+
+    mutable std::mutex mutex_;
+    std::vector<Span> spans_;
+    size_t dropped_spans_ = 0;
+};
+
+// Abre um span no construtor e o fecha no destrutor; não faz nada se trace for nulo
+class TraceSpan {
+public:
+    TraceSpan(CallTrace* trace, const char* name, CallTrace::SpanId parent = CallTrace::kRoot)
+        : trace_(trace), id_(trace ? trace->start(name, parent) : CallTrace::kNoSpan) {}
+    ~TraceSpan() {
+        if (trace_) trace_->end(id_);
+    }
+
+    CallTrace::SpanId id() const { return id_; }
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+private:
+    CallTrace* trace_;
+    CallTrace::SpanId id_;
+};
+
+// Decide quais chamadas são rastreadas e grava os rastros concluídos em um arquivo local,
+// em uma thread própria, sem depender de um coletor. O contexto W3C "traceparent" enviado
+// pelo cliente é respeitado: a chamada vira filha do span dele e segue a decisão de amostragem.
+class Tracer {
+public:
+    struct Stats {
+        uint64_t exported = 0;
+        uint64_t dropped = 0;
+    };
+
+    // Retorna nullptr, com a causa em error, se o arquivo não puder ser aberto
+    static std::unique_ptr<Tracer> create(const TraceOptions& options, std::string& error);
+
+    ~Tracer();
+
+    // Inicia o rastro de uma chamada de method, ou retorna nullptr se ela não for amostrada
+    std::unique_ptr<CallTrace> startCall(const std::string& method, const std::string& traceparent);
+
+    // Entrega um rastro encerrado para gravação; com a fila cheia ele é descartado
+    void submit(std::unique_ptr<CallTrace> trace);
+
+    Stats stats() const;
+
+    Tracer(const Tracer&) = delete;
+    Tracer& operator=(const Tracer&) = delete;
+
+private:
+    Tracer(const TraceOptions& options, int fd);
+
+    void exportLoop();
+
+    TraceOptions options_;
+    int fd_;
+    std::atomic<uint64_t> exported_{0};
+    std::atomic<uint64_t> dropped_{0};
+
+    std::mutex mutex_;
+    std::condition_variable ready_;
+    std::deque<std::unique_ptr<CallTrace>> queue_;
+    bool stopping_ = false;
+    std::thread exporter_;
+};
+
+// Interpreta um cabeçalho "traceparent" (versão 00). Retorna false se ele for inválido.
+bool parseTraceparent(const std::string& header, std::array<uint8_t, 16>& trace_id, std::array<uint8_t, 8>& span_id,
+                      bool& sampled);
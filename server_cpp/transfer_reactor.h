@@ -0,0 +1,671 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <grpcpp/grpcpp.h>
+#include "file_processor.grpc.pb.h"
+#include "content_hash.h"
+#include "crc32c.h"
+#include "file_io.h"
+#include "input_sink.h"
+#include "job_executor.h"
+#include "logging.h"
+#include "metrics.h"
+#include "result_cache.h"
+#include "single_flight.h"
+#include "tracing.h"
+#include "upload_store.h"
+#include "wire_compression.h"
+
+// Cache e deduplicação usados por todas as chamadas do serviço (qualquer um pode ser nulo)
+struct ResultSharing {
+    ResultCache* cache = nullptr;
+    SingleFlight* flights = nullptr;
+};
+
+// Conduz uma chamada bidirecional do serviço (upload em chunks, processamento, download em chunks)
+// sem prender uma thread à conexão:
+//   - os chunks recebidos são repassados ao InputSink nas threads de rede do gRPC
+//     (ou no JobExecutor, se o sink puder bloquear);
+//   - ao fim do upload, process roda no JobExecutor e define a saída;
+//   - o resultado é enviado chunk a chunk a partir de OnWriteDone.
+// Com shareResults, o upload é identificado por hash enquanto chega; se o resultado já estiver
+// no cache, ou se uma chamada idêntica já estiver em andamento, process nem é executado.
+// Nada é lido antes de begin() (a chamada pode aguardar uma vaga no controle de admissão).
+// O reactor se destrói sozinho em OnDone, removendo os arquivos temporários registrados.
+// Com metrics, a duração de cada etapa, os bytes e o código final da chamada são registrados;
+// com setTrace, as mesmas etapas (e cada escrita) viram spans do rastro da chamada.
+// Com setCompression, os chunks da resposta que parecem compressíveis são comprimidos (pelo
+// gRPC ou em frames zstd); os demais seguem como estão.
+// Com setUpload, os chunks são gravados na sessão de upload retomável (no JobExecutor), conferindo
+// offset e CRC32C, e cada byte novo segue para o InputSink assim que é gravado; numa retomada, o
+// que a chamada anterior já tinha gravado é lido do arquivo da sessão antes.
+// Maior saída enviada aos poucos que é guardada para chamadas idênticas fora do cache
+constexpr size_t kMaxSharedCapture = 64 * 1024 * 1024;
+
+template <typename Request>
+class TransferReactor final : public grpc::ServerBidiReactor<Request, file_processor::FileChunk> {
+public:
+    // Recebe a primeira mensagem (ou uma mensagem vazia, se o cliente não enviou nada) e abre o
+    // destino da entrada com setInput. Um status de erro encerra a chamada sem ler o restante.
+    using Start = std::function<grpc::Status(TransferReactor& reactor, const Request& first)>;
+    // Executado no JobExecutor depois do último chunk: chama finishInput, processa e define a
+    // saída com sendFile/sendBuffer, ou a envia aos poucos com stream
+    using Process = std::function<grpc::Status(TransferReactor& reactor)>;
+
+    TransferReactor(std::string service, JobExecutor& executor, size_t chunk_size, ResultSharing sharing,
+                    MethodMetrics* metrics, Start start, Process process)
+        : service_(std::move(service)), executor_(executor), chunk_size_(chunk_size), start_(std::move(start)),
+          process_(std::move(process)), sharing_(sharing), metrics_(metrics), created_at_(Clock::now()) {}
+
+    // Começa a receber o upload. on_done é chamado quando a chamada termina (ex.: liberar a vaga).
+    void begin(std::function<void()> on_done) {
+        on_done_ = std::move(on_done);
+        upload_started_ = Clock::now();
+        record(Stage::Queue, upload_started_ - created_at_);
+        if (trace_) trace_->add("queue", created_at_, upload_started_);
+        if (cancelled_) {
+            finish(grpc::Status(grpc::StatusCode::CANCELLED, "Chamada cancelada pelo cliente."));
+            return;
+        }
+        if (!openUpload()) return;
+        this->StartRead(&request_);
+    }
+
+    // Encerra a chamada sem ler nada (ex.: recusada pelo controle de admissão)
+    void reject(const grpc::Status& status) {
+        Clock::time_point now = Clock::now();
+        record(Stage::Queue, now - created_at_);
+        if (trace_) trace_->add("queue", created_at_, now);
+        finish(status);
+    }
+
+    // Rastreia a chamada (só as amostradas recebem um CallTrace). Deve vir antes de begin().
+    void setTrace(std::unique_ptr<CallTrace> trace) { trace_ = std::move(trace); }
+
+    // Comprime os chunks da resposta. Em Gzip/Deflate o algoritmo já deve ter sido escolhido no
+    // contexto da chamada; aqui só se decide, chunk a chunk, se ele é aplicado. Deve vir antes de begin().
+    void setCompression(WireCompression compression, int zstd_level) {
+        compression_ = compression;
+        zstd_level_ = zstd_level;
+    }
+
+    // Grava o upload na sessão id de store (criada ou retomada em begin()). Com expected_size > 0,
+    // o upload só é processado se a sessão tiver exatamente esse tamanho. Deve vir antes de begin().
+    void setUpload(UploadStore* store, std::string id, uint64_t expected_size) {
+        uploads_ = store;
+        upload_id_ = std::move(id);
+        upload_expected_size_ = expected_size;
+    }
+
+    // Rastro da chamada (nullptr se ela não é rastreada) e span sob o qual os handlers abrem os
+    // seus (o do processamento, enquanto ele roda)
+    CallTrace* trace() { return trace_.get(); }
+    CallTrace::SpanId traceParent() const { return trace_parent_; }
+
+    // Método atendido pela chamada, usado nas mensagens de log
+    const std::string& service() const { return service_; }
+
+    // --- Usados por start ---
+
+    void setInput(std::unique_ptr<InputSink> sink) { sink_ = std::move(sink); }
+
+    // Identifica o resultado pelo hash da entrada e de params, que deve descrever tudo além da
+    // entrada que influencia o resultado (método, formato, dimensões, motor...). Com isso a chamada
+    // pode ser atendida pelo cache ou por outra idêntica em andamento.
+    void shareResults(const std::string& params) {
+        bool caching = sharing_.cache && sharing_.cache->enabled();
+        if (!caching && !sharing_.flights) return;
+        hash_.reset(new ContentHash());
+        hash_->update(params);
+        hash_->update("\n", 1);
+    }
+
+    // Arquivo removido quando a chamada termina, com sucesso ou não
+    void removeOnDone(const std::string& path) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        temp_files_.push_back(path);
+    }
+
+    // --- Usados por process ---
+
+    // Encerra a entrada e retorna o código da ferramenta (0 = sucesso)
+    int finishInput() {
+        int code = sink_->finish();
+        if (const ProcessResult* result = sink_->toolResult()) addToolResult(*result);
+        return code;
+    }
+
+    // Registra o uso de CPU e os tempos (spawn e execução) de uma ferramenta da chamada
+    void addToolResult(const ProcessResult& result) {
+        if (metrics_) metrics_->addToolUsage(result.usage);
+        if (!trace_) return;
+        trace_->add("spawn", result.spawn_started, result.started, trace_parent_);
+        CallTrace::SpanId tool = trace_->add("tool", result.started, result.exited, trace_parent_);
+        trace_->attribute(tool, "process.exit_code", static_cast<int64_t>(result.status()));
+        trace_->attribute(tool, "process.cpu.user_us",
+                          static_cast<int64_t>(result.usage.ru_utime.tv_sec) * 1000000 + result.usage.ru_utime.tv_usec);
+        trace_->attribute(tool, "process.cpu.system_us",
+                          static_cast<int64_t>(result.usage.ru_stime.tv_sec) * 1000000 + result.usage.ru_stime.tv_usec);
+        trace_->attribute(tool, "process.max_rss_kb", static_cast<int64_t>(result.usage.ru_maxrss));
+    }
+
+    // Envia o arquivo, mapeado em memória, depois que process retornar
+    bool sendFile(const std::string& path) {
+        TraceSpan span(trace_.get(), "output_read", trace_parent_);
+        if (!mapped_.open(path)) return false;
+        output_ = mapped_.data();
+        output_size_ = mapped_.size();
+        return true;
+    }
+
+    // Envia um resultado em memória depois que process retornar
+    void sendBuffer(std::string data) {
+        sendShared(std::make_shared<const std::string>(std::move(data)));
+    }
+
+    void sendShared(std::shared_ptr<const std::string> data) {
+        buffer_ = std::move(data);
+        output_ = buffer_->data();
+        output_size_ = buffer_->size();
+    }
+
+    // Envia data imediatamente, em chunks, e espera cada escrita terminar (só dentro de process).
+    // Retorna false se o cliente deixou de aceitar dados.
+    bool stream(const char* data, size_t size) {
+        if (capturing_) {
+            // O texto enviado aos poucos também é guardado para o cache e para chamadas idênticas
+            capturing_ = keepCapturing(captured_.size() + size);
+            if (capturing_) {
+                captured_.append(data, size);
+            } else {
+                captured_.clear();
+            }
+        }
+        while (size > 0) {
+            size_t count = std::min(chunk_size_, size);
+            grpc::WriteOptions options = encodeChunk(data, count);
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                stream_pending_ = true;
+            }
+            TraceSpan span(trace_.get(), "write", trace_parent_);
+            this->StartWrite(&chunk_, options);
+            std::unique_lock<std::mutex> lock(mutex_);
+            written_.wait(lock, [this]() { return !stream_pending_; });
+            if (!stream_ok_) {
+                stream_failed_ = true;
+                return false;
+            }
+            sent_ += count;
+            data += count;
+            size -= count;
+        }
+        return true;
+    }
+
+    // Se o cliente cancelou a chamada ou deixou de receber o que stream enviava. Permite ao handler
+    // distinguir uma desconexão de uma falha do processamento.
+    bool cancelled() const { return cancelled_ || stream_failed_; }
+
+    // Saída a que pertencem os chunks enviados daqui em diante (FileChunk.output_index), nas
+    // chamadas com várias saídas. Só entre chamadas a stream, que esperam as suas escritas.
+    void setOutputIndex(uint32_t index) { chunk_.set_output_index(index); }
+
+    // Mensagem registrada quando o envio do resultado é iniciado
+    void setSuccessMessage(const std::string& message) { success_message_ = message; }
+
+    // --- Reações do gRPC ---
+
+    void OnReadDone(bool ok) override {
+        if (!started_) {
+            started_ = true;
+            grpc::Status status = start_(*this, ok ? request_ : Request());
+            if (!status.ok()) {
+                finish(status);
+                return;
+            }
+        }
+        if (!ok) {
+            // Fim do upload (ou cancelamento): o processamento sai da thread de rede
+            Clock::time_point now = Clock::now();
+            record(Stage::Upload, now - upload_started_);
+            record(Stage::InputWrite, input_write_time_);
+            traceUpload(now);
+            executor_.post([this]() { runProcess(); });
+            return;
+        }
+        if (request_.content().empty()) {
+            this->StartRead(&request_);
+        } else if (sink_->mayBlock() || upload_) {
+            // A próxima leitura só começa depois da escrita, o que limita a memória por chamada.
+            // A gravação na sessão de upload também pode bloquear no disco.
+            executor_.post([this]() { consumeAndRead(); });
+        } else {
+            consumeAndRead();
+        }
+    }
+
+    void OnWriteDone(bool ok) override {
+        if (trace_ && write_span_ != CallTrace::kNoSpan) {
+            trace_->end(write_span_);
+            write_span_ = CallTrace::kNoSpan;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (stream_pending_) {
+                stream_pending_ = false;
+                stream_ok_ = ok;
+                written_.notify_one();
+                return;
+            }
+        }
+        if (!ok) {
+            finish(grpc::Status(grpc::StatusCode::CANCELLED, "Cliente deixou de receber o resultado."));
+            return;
+        }
+        sendNext();
+    }
+
+    void OnCancel() override { cancelled_ = true; }
+
+    void OnDone() override { delete this; }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    ~TransferReactor() override {
+        sink_.reset(); // espera a ferramenta de um pipe abandonado antes de liberar a vaga
+        // Só um resultado entregue encerra a sessão (o status OK só é definido depois da última
+        // escrita, ver sendNext); em qualquer falha o cliente ainda pode retomá-la
+        if (upload_) uploads_->release(upload_, status_code_ == static_cast<int>(grpc::StatusCode::OK));
+        for (const auto& path : temp_files_) std::remove(path.c_str());
+        if (trace_) {
+            trace_->attribute(CallTrace::kRoot, "rpc.request.bytes", static_cast<int64_t>(received_));
+            trace_->attribute(CallTrace::kRoot, "rpc.response.bytes", static_cast<int64_t>(sent_));
+            trace_->finish(status_code_, status_message_);
+            Tracer& tracer = trace_->tracer();
+            tracer.submit(std::move(trace_));
+        }
+        if (metrics_) {
+            Clock::time_point now = Clock::now();
+            if (send_started_ != Clock::time_point()) record(Stage::Send, now - send_started_);
+            record(Stage::Total, now - created_at_);
+            metrics_->bytes_received += received_;
+            metrics_->bytes_sent += sent_;
+            metrics_->finished(status_code_);
+        }
+        if (on_done_) on_done_();
+    }
+
+    void record(Stage stage, Clock::duration duration) {
+        if (metrics_) metrics_->record(stage, duration);
+    }
+
+    // Encerra a chamada guardando o código para as métricas
+    void finish(const grpc::Status& status) {
+        status_code_ = static_cast<int>(status.error_code());
+        status_message_ = status.error_message();
+        this->Finish(status);
+    }
+
+    // Spans da recepção e das escritas no destino da entrada (estas somadas em um só span)
+    void traceUpload(Clock::time_point now) {
+        if (!trace_) return;
+        CallTrace::SpanId receive = trace_->add("receive", upload_started_, now);
+        trace_->attribute(receive, "bytes", static_cast<int64_t>(received_));
+        if (input_writes_ == 0) return;
+        CallTrace::SpanId spool = trace_->add("spool", first_write_, last_write_end_);
+        trace_->attribute(spool, "writes", static_cast<int64_t>(input_writes_));
+        trace_->attribute(spool, "write_time_us",
+                          static_cast<int64_t>(std::chrono::duration_cast<std::chrono::microseconds>(input_write_time_).count()));
+    }
+
+    // Abre (ou retoma) a sessão de upload pedida em setUpload. Retorna false se a chamada foi encerrada.
+    bool openUpload() {
+        if (upload_id_.empty()) return true;
+        std::string error;
+        UploadStore::Refusal refusal;
+        upload_ = uploads_->acquire(upload_id_, service_, error, refusal);
+        if (!upload_) {
+            // Os códigos dizem ao cliente o que fazer: ABORTED tenta de novo, UNIMPLEMENTED envia
+            // sem sessão e os demais são definitivos
+            grpc::StatusCode code = grpc::StatusCode::FAILED_PRECONDITION;
+            switch (refusal) {
+                case UploadStore::Refusal::Disabled: code = grpc::StatusCode::UNIMPLEMENTED; break;
+                case UploadStore::Refusal::InvalidId: code = grpc::StatusCode::INVALID_ARGUMENT; break;
+                case UploadStore::Refusal::InUse: code = grpc::StatusCode::ABORTED; break;
+                case UploadStore::Refusal::OpenFailed: code = grpc::StatusCode::INTERNAL; break;
+                default: break;
+            }
+            logOperation(service_, "ERROR", error);
+            finish(grpc::Status(code, error));
+            return false;
+        }
+        replay_pending_ = upload_->size();
+        if (replay_pending_ > 0) {
+            logOperation(service_, "INFO", "Upload " + upload_id_ + " retomado a partir de " + std::to_string(replay_pending_) + " bytes.");
+        }
+        if (trace_) trace_->attribute(CallTrace::kRoot, "upload.resumed_from", static_cast<int64_t>(replay_pending_));
+        return true;
+    }
+
+    void consumeAndRead() {
+        grpc::Status status = consume();
+        if (!status.ok()) {
+            logOperation(service_, "ERROR", status.error_message());
+            finish(status);
+            return;
+        }
+        this->StartRead(&request_);
+    }
+
+    // Trata o conteúdo do chunk atual: vai para a sessão de upload, se houver uma, ou direto ao sink
+    grpc::Status consume() {
+        const std::string& content = request_.content();
+        received_ += content.size();
+        if (upload_) return appendUpload(content);
+        if (request_.has_crc32c() && crc32c(0, content.data(), content.size()) != request_.crc32c()) {
+            return grpc::Status(grpc::StatusCode::DATA_LOSS, "CRC32C do chunk não confere.");
+        }
+        feed(content.data(), content.size());
+        return inputStatus();
+    }
+
+    // Grava o chunk na sessão e repassa ao sink só os bytes novos (retransmissões são ignoradas)
+    grpc::Status appendUpload(const std::string& content) {
+        grpc::Status status = replayCommitted();
+        if (!status.ok()) return status;
+        uint64_t offset = request_.offset();
+        uint64_t before = upload_->size();
+        switch (upload_->append(offset, content.data(), content.size(), request_.has_crc32c(), request_.crc32c())) {
+            case UploadSession::Append::Ok: {
+                size_t added = static_cast<size_t>(upload_->size() - before);
+                feed(content.data() + content.size() - added, added);
+                return inputStatus();
+            }
+            case UploadSession::Append::Gap:
+                return grpc::Status(grpc::StatusCode::OUT_OF_RANGE, "Chunk no offset " + std::to_string(offset) + ", mas o servidor tem " +
+                                                                        std::to_string(upload_->size()) + " bytes do upload.");
+            case UploadSession::Append::QuotaExceeded:
+                return grpc::Status(grpc::StatusCode::RESOURCE_EXHAUSTED, "Limite de espaço dos uploads retomáveis atingido.");
+            case UploadSession::Append::ChecksumMismatch:
+                return grpc::Status(grpc::StatusCode::DATA_LOSS, "CRC32C do chunk no offset " + std::to_string(offset) + " não confere.");
+            default:
+                return grpc::Status(grpc::StatusCode::INTERNAL, "Erro ao gravar o upload.");
+        }
+    }
+
+    // Numa retomada, repassa ao sink o que a chamada anterior gravou, como se tivesse acabado de
+    // chegar. Roda antes do primeiro chunk novo ou, se não vier nenhum, no fim do upload.
+    grpc::Status replayCommitted() {
+        if (replay_pending_ == 0) return grpc::Status::OK;
+        TraceSpan span(trace_.get(), "upload_replay");
+        MappedFile file;
+        if (!file.open(upload_->path()) || file.size() < replay_pending_) {
+            return grpc::Status(grpc::StatusCode::INTERNAL, "Erro ao ler o upload.");
+        }
+        size_t size = static_cast<size_t>(replay_pending_);
+        for (size_t offset = 0; offset < size; offset += chunk_size_) {
+            feed(file.data() + offset, std::min(chunk_size_, size - offset));
+        }
+        replay_pending_ = 0;
+        return inputStatus();
+    }
+
+    // Confere, no fim do upload, se a sessão tem tudo o que o cliente anunciou
+    grpc::Status completeUpload() {
+        if (upload_expected_size_ > 0 && upload_->size() != upload_expected_size_) {
+            return grpc::Status(grpc::StatusCode::FAILED_PRECONDITION, "Upload incompleto: " + std::to_string(upload_->size()) + " de " +
+                                                                          std::to_string(upload_expected_size_) + " bytes recebidos.");
+        }
+        return replayCommitted();
+    }
+
+    // Erro se o sink não conseguiu gravar a entrada (ver InputSink::failed): a chamada termina sem
+    // processar, guardar ou compartilhar o resultado, que seria o de uma entrada truncada
+    grpc::Status inputStatus() const {
+        if (sink_ && sink_->failed()) return grpc::Status(grpc::StatusCode::INTERNAL, "Erro ao gravar o arquivo de entrada.");
+        return grpc::Status::OK;
+    }
+
+    // Repassa data ao sink. Se a ferramenta parar de ler, o restante do upload é descartado para
+    // encerrar a leitura normalmente; uma falha de gravação é tratada por inputStatus.
+    void feed(const char* data, size_t size) {
+        if (hash_) hash_->update(data, size);
+        if (accepting_) {
+            Clock::time_point started = Clock::now();
+            accepting_ = sink_->write(data, size);
+            last_write_end_ = Clock::now();
+            input_write_time_ += last_write_end_ - started;
+            if (input_writes_++ == 0) first_write_ = started;
+        }
+    }
+
+    void runProcess() {
+        if (cancelled_) {
+            finish(grpc::Status(grpc::StatusCode::CANCELLED, "Chamada cancelada pelo cliente."));
+            return;
+        }
+        if (upload_) {
+            grpc::Status status = completeUpload();
+            if (!status.ok()) {
+                logOperation(service_, "ERROR", status.error_message());
+                finish(status);
+                return;
+            }
+        }
+        if (hash_) {
+            result_key_ = hash_->finish();
+            hash_.reset();
+            if (serveFromCache()) return;
+            // Uma chamada idêntica já está em andamento: o resultado dela chega em onSharedResult
+            if (sharing_.flights) {
+                auto on_result = [this](std::shared_ptr<const std::string> result) { onSharedResult(std::move(result)); };
+                if (!sharing_.flights->join(result_key_, on_result)) return;
+                leader_ = true;
+            }
+            capturing_ = true;
+        }
+        runOwnProcess();
+    }
+
+    void runOwnProcess() {
+        Clock::time_point started = Clock::now();
+        if (trace_) trace_parent_ = trace_->start("process");
+        grpc::Status status = process_(*this);
+        // Um close com erro no spool só aparece em finishInput, dentro de process
+        if (status.ok() && !inputStatus().ok()) {
+            status = inputStatus();
+            logOperation(service_, "ERROR", status.error_message());
+        }
+        if (trace_) trace_->end(trace_parent_);
+        trace_parent_ = CallTrace::kRoot;
+        record(Stage::Process, Clock::now() - started);
+        std::shared_ptr<const std::string> result;
+        if (status.ok() && !result_key_.empty()) result = publishResult();
+        // Em caso de falha quem esperava executa o próprio job: a causa pode ser só desta chamada
+        if (leader_) sharing_.flights->complete(result_key_, result);
+        if (!status.ok()) {
+            finish(status);
+            return;
+        }
+        sendNext();
+    }
+
+    void onSharedResult(std::shared_ptr<const std::string> result) {
+        if (!result) {
+            executor_.post([this]() { runOwnProcess(); });
+            return;
+        }
+        sendShared(std::move(result));
+        success_message_ = "Resultado compartilhado com uma chamada idêntica em andamento.";
+        if (trace_) trace_->attribute(CallTrace::kRoot, "result.source", std::string("shared"));
+        sendNext();
+    }
+
+    bool serveFromCache() {
+        ResultCache::Hit hit;
+        if (!sharing_.cache || !sharing_.cache->enabled() || !sharing_.cache->lookup(result_key_, hit)) return false;
+        if (hit.data) {
+            sendShared(hit.data);
+            success_message_ = "Resultado servido do cache (memória).";
+        } else if (sendFile(hit.path)) {
+            success_message_ = "Resultado servido do cache (disco).";
+        } else {
+            return false; // arquivo descartado entre a consulta e a abertura
+        }
+        if (trace_) trace_->attribute(CallTrace::kRoot, "result.source", std::string(hit.data ? "cache.memory" : "cache.disk"));
+        sendNext();
+        return true;
+    }
+
+    bool keepCapturing(size_t total) {
+        if (sharing_.cache && sharing_.cache->enabled() && sharing_.cache->accepts(total)) return true;
+        return leader_ && total <= kMaxSharedCapture;
+    }
+
+    // Monta o resultado para o cache e para as chamadas que esperam por ele. Só há cópia se
+    // alguém for usá-la; a gravação no cache sai do caminho do envio.
+    std::shared_ptr<const std::string> publishResult() {
+        ResultCache* cache = sharing_.cache && sharing_.cache->enabled() ? sharing_.cache : nullptr;
+        std::shared_ptr<const std::string> data;
+        if (buffer_) {
+            data = buffer_;
+        } else if (output_) {
+            bool wanted = (cache && cache->accepts(output_size_)) || (leader_ && sharing_.flights->hasFollowers(result_key_));
+            if (wanted) data = std::make_shared<const std::string>(output_, output_size_);
+        } else if (capturing_) {
+            // Texto enviado aos poucos com stream (ou saída vazia)
+            data = std::make_shared<const std::string>(std::move(captured_));
+        }
+        if (data && cache && cache->accepts(data->size())) {
+            std::string key = result_key_;
+            executor_.post([cache, key, data]() { cache->store(key, data); });
+        }
+        return data;
+    }
+
+    // Envia o próximo pedaço da saída. Os intermediários levam buffer hint; o último segue junto com o status.
+    void sendNext() {
+        if (send_started_ == Clock::time_point()) send_started_ = Clock::now();
+        if (output_offset_ == output_size_) {
+            logSuccess();
+            finish(grpc::Status::OK);
+            return;
+        }
+        size_t count = std::min(chunk_size_, output_size_ - output_offset_);
+        grpc::WriteOptions options = encodeChunk(output_ + output_offset_, count);
+        output_offset_ += count;
+        sent_ += count;
+        if (trace_) write_span_ = trace_->start("write");
+        if (output_offset_ < output_size_) {
+            this->StartWrite(&chunk_, options.set_buffer_hint());
+        } else if (upload_) {
+            // A sessão de upload só pode ser removida depois que o último chunk for de fato escrito:
+            // a chamada termina em OnWriteDone, e não junto com a escrita
+            this->StartWrite(&chunk_, options);
+        } else {
+            logSuccess();
+            status_code_ = static_cast<int>(grpc::StatusCode::OK);
+            this->StartWriteAndFinish(&chunk_, options, grpc::Status::OK);
+        }
+    }
+
+    // Prepara chunk_ com data e devolve as opções da escrita. Chunks que não parecem compressíveis
+    // saem como estão: sem o gRPC comprimir a mensagem e sem frame zstd.
+    grpc::WriteOptions encodeChunk(const char* data, size_t size) {
+        grpc::WriteOptions options;
+        chunk_.set_encoding(file_processor::IDENTITY);
+        if (compression_ == WireCompression::None) {
+            chunk_.set_content(data, size);
+            return options;
+        }
+        bool compressible = looksCompressible(data, size);
+        if (compression_ != WireCompression::Zstd) {
+            chunk_.set_content(data, size);
+            if (!compressible) options.set_no_compression();
+            return options;
+        }
+        if (compressible && zstdCompress(data, size, zstd_level_, *chunk_.mutable_content())) {
+            chunk_.set_encoding(file_processor::ZSTD);
+        } else {
+            chunk_.set_content(data, size);
+        }
+        return options;
+    }
+
+    void logSuccess() {
+        if (!success_message_.empty()) logOperation(service_, "SUCCESS", success_message_);
+    }
+
+    std::string service_;
+    JobExecutor& executor_;
+    size_t chunk_size_;
+    Start start_;
+    Process process_;
+    std::function<void()> on_done_;
+
+    Request request_;
+    bool started_ = false;
+    bool accepting_ = true;
+    std::unique_ptr<InputSink> sink_;
+    std::atomic<bool> cancelled_{false};
+
+    ResultSharing sharing_;
+    MethodMetrics* metrics_;
+    Clock::time_point created_at_;
+    Clock::time_point upload_started_;
+    Clock::time_point send_started_;
+    Clock::duration input_write_time_{};
+    size_t received_ = 0;
+    size_t sent_ = 0;
+    int status_code_ = static_cast<int>(grpc::StatusCode::UNKNOWN);
+    std::string status_message_;
+    size_t input_writes_ = 0;
+    Clock::time_point first_write_;
+    Clock::time_point last_write_end_;
+
+    WireCompression compression_ = WireCompression::None;
+    int zstd_level_ = kDefaultZstdLevel;
+
+    std::unique_ptr<CallTrace> trace_;
+    std::atomic<CallTrace::SpanId> trace_parent_{CallTrace::kRoot};
+    CallTrace::SpanId write_span_ = CallTrace::kNoSpan; // escrita em andamento fora de stream
+
+    UploadStore* uploads_ = nullptr;
+    std::string upload_id_;
+    uint64_t upload_expected_size_ = 0;
+    std::shared_ptr<UploadSession> upload_;
+    uint64_t replay_pending_ = 0; // prefixo de uma retomada ainda não repassado ao sink
+
+    std::unique_ptr<ContentHash> hash_;
+    std::string result_key_;
+    bool leader_ = false; // executa o job em nome de chamadas idênticas
+    bool capturing_ = false;
+    std::string captured_;
+
+    file_processor::FileChunk chunk_; // reaproveitado entre as escritas
+    const char* output_ = nullptr;
+    size_t output_size_ = 0;
+    size_t output_offset_ = 0;
+    std::shared_ptr<const std::string> buffer_;
+    MappedFile mapped_;
+    std::string success_message_;
+
+    std::mutex mutex_;
+    std::condition_variable written_;
+    bool stream_pending_ = false;
+    bool stream_ok_ = false;
+    std::atomic<bool> stream_failed_{false}; // algum stream retornou false
+    std::vector<std::string> temp_files_;
+};
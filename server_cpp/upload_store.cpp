@@ -0,0 +1,242 @@
+#include "upload_store.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "crc32c.h"
+
+namespace {
+
+const std::string kUploadSuffix = ".upload";
+
+bool endsWith(const std::string& text, const std::string& suffix) {
+    return text.size() >= suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+} // namespace
+
+UploadSession::~UploadSession() {
+    if (fd_ >= 0) close(fd_);
+}
+
+bool UploadSession::openFile() {
+    // Uma sessão nova descarta qualquer arquivo com o mesmo nome; uma retomada volta ao que foi
+    // confirmado (uma escrita interrompida pode ter deixado bytes a mais)
+    uint64_t committed = size();
+    int flags = O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC | (committed == 0 ? O_TRUNC : 0);
+    fd_ = open(path_.c_str(), flags, 0600);
+    if (fd_ < 0) return false;
+    if (ftruncate(fd_, static_cast<off_t>(committed)) != 0) {
+        close(fd_);
+        fd_ = -1;
+        return false;
+    }
+    return true;
+}
+
+uint64_t UploadSession::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return size_;
+}
+
+void UploadSession::snapshot(uint64_t& size, uint32_t& crc) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size = size_;
+    crc = crc_;
+}
+
+UploadSession::Append UploadSession::append(uint64_t offset, const char* data, size_t size, bool has_crc, uint32_t crc) {
+    // Só a chamada dona da sessão grava, então o tamanho lido aqui não muda durante a escrita;
+    // o mutex protege apenas a publicação do novo tamanho e CRC
+    uint64_t committed = this->size();
+    if (offset > committed) return Append::Gap;
+    if (has_crc && ::crc32c(0, data, size) != crc) return Append::ChecksumMismatch;
+    uint64_t skip = committed - offset;
+    if (skip >= size) return Append::Ok; // retransmissão de bytes já gravados
+
+    const char* tail = data + skip;
+    size_t remaining = size - static_cast<size_t>(skip);
+    if (!store_->reserve(remaining)) return Append::QuotaExceeded;
+    size_t written = 0;
+    while (written < remaining) {
+        ssize_t count = write(fd_, tail + written, remaining - written);
+        if (count < 0 && errno == EINTR) continue;
+        // Uma escrita parcial é descartada quando a sessão for reaberta (ver openFile)
+        if (count <= 0) {
+            store_->unreserve(remaining);
+            return Append::WriteError;
+        }
+        written += static_cast<size_t>(count);
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    crc_ = ::crc32c(crc_, tail, remaining);
+    size_ += remaining;
+    return Append::Ok;
+}
+
+UploadStore::UploadStore(const std::string& directory, std::chrono::seconds ttl, uint64_t max_bytes)
+    : directory_(directory), ttl_(ttl), max_bytes_(max_bytes) {
+    if (directory_.empty()) return;
+    mkdir(directory_.c_str(), 0700);
+    DIR* dir = opendir(directory_.c_str());
+    if (!dir) {
+        directory_.clear();
+        return;
+    }
+    while (dirent* item = readdir(dir)) {
+        std::string name = item->d_name;
+        if (endsWith(name, kUploadSuffix)) std::remove((directory_ + "/" + name).c_str());
+    }
+    closedir(dir);
+    sweeper_ = std::thread([this]() { sweepLoop(); });
+}
+
+UploadStore::~UploadStore() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    changed_.notify_all();
+    if (sweeper_.joinable()) sweeper_.join();
+}
+
+bool UploadStore::isValidId(const std::string& id) {
+    if (id.size() < 8 || id.size() > 64) return false;
+    return std::all_of(id.begin(), id.end(), [](char c) {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '-' || c == '_';
+    });
+}
+
+std::shared_ptr<UploadSession> UploadStore::acquire(const std::string& id, const std::string& method, std::string& error,
+                                                    Refusal& refusal) {
+    if (!enabled()) {
+        error = "Uploads retomáveis desativados no servidor.";
+        refusal = Refusal::Disabled;
+        return nullptr;
+    }
+    if (!isValidId(id)) {
+        error = "Id de upload inválido: use de 8 a 64 letras, dígitos, '-' ou '_'.";
+        refusal = Refusal::InvalidId;
+        return nullptr;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto now = std::chrono::steady_clock::now();
+    expireLocked(now);
+
+    std::shared_ptr<UploadSession>& session = sessions_[id];
+    if (!session) {
+        session.reset(new UploadSession(this, id, method, directory_ + "/" + id + kUploadSuffix));
+    } else if (session->in_use_) {
+        error = "O upload " + id + " está em uso por outra chamada.";
+        refusal = Refusal::InUse;
+        return nullptr;
+    } else if (session->method_ != method) {
+        error = "O upload " + id + " pertence a uma chamada de " + session->method_ + ".";
+        refusal = Refusal::OtherMethod;
+        return nullptr;
+    }
+    if (!session->openFile()) {
+        error = "Não foi possível abrir o arquivo do upload.";
+        refusal = Refusal::OpenFailed;
+        if (session->size() == 0) sessions_.erase(id);
+        return nullptr;
+    }
+    session->in_use_ = true;
+    session->last_active_ = now;
+    return session;
+}
+
+void UploadStore::release(const std::shared_ptr<UploadSession>& session, bool completed) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (session->fd_ >= 0) {
+            close(session->fd_);
+            session->fd_ = -1;
+        }
+        session->in_use_ = false;
+        session->last_active_ = std::chrono::steady_clock::now();
+        if (completed) {
+            auto it = sessions_.find(session->id_);
+            if (it != sessions_.end() && it->second == session) removeLocked(it);
+        }
+    }
+    // Uma sessão parada passa a ter prazo: a thread de limpeza recalcula a próxima expiração
+    changed_.notify_all();
+}
+
+bool UploadStore::reserve(uint64_t bytes) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    while (max_bytes_ > 0 && total_bytes_ + bytes > max_bytes_) {
+        // Abre espaço removendo a sessão parada há mais tempo
+        auto oldest = sessions_.end();
+        for (auto it = sessions_.begin(); it != sessions_.end(); ++it) {
+            if (it->second->in_use_) continue;
+            if (oldest == sessions_.end() || it->second->last_active_ < oldest->second->last_active_) oldest = it;
+        }
+        if (oldest == sessions_.end()) return false;
+        removeLocked(oldest);
+    }
+    total_bytes_ += bytes;
+    return true;
+}
+
+void UploadStore::unreserve(uint64_t bytes) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    total_bytes_ -= bytes;
+}
+
+bool UploadStore::status(const std::string& id, Status& out) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto now = std::chrono::steady_clock::now();
+    expireLocked(now);
+    auto it = sessions_.find(id);
+    if (it == sessions_.end()) return false;
+    const UploadSession& session = *it->second;
+    session.snapshot(out.size, out.crc32c);
+    // Uma sessão em uso só começa a expirar quando a chamada terminar
+    auto expires = session.in_use_ ? ttl_ : ttl_ - std::chrono::duration_cast<std::chrono::seconds>(now - session.last_active_);
+    out.expires_in_ms = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(expires).count());
+    return true;
+}
+
+void UploadStore::expireLocked(std::chrono::steady_clock::time_point now) {
+    for (auto it = sessions_.begin(); it != sessions_.end();) {
+        const UploadSession& session = *it->second;
+        if (!session.in_use_ && now - session.last_active_ >= ttl_) {
+            it = removeLocked(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+UploadStore::Sessions::iterator UploadStore::removeLocked(Sessions::iterator it) {
+    const UploadSession& session = *it->second;
+    std::remove(session.path_.c_str());
+    total_bytes_ -= session.size();
+    return sessions_.erase(it);
+}
+
+void UploadStore::sweepLoop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stopping_) {
+        auto now = std::chrono::steady_clock::now();
+        expireLocked(now);
+        // Dorme até a próxima sessão parada expirar, ou até uma chamada liberar outra
+        auto next_expiry = std::chrono::steady_clock::time_point::max();
+        for (const auto& entry : sessions_) {
+            if (!entry.second->in_use_) next_expiry = std::min(next_expiry, entry.second->last_active_ + ttl_);
+        }
+        if (next_expiry == std::chrono::steady_clock::time_point::max()) {
+            changed_.wait(lock);
+        } else {
+            changed_.wait_until(lock, next_expiry);
+        }
+    }
+}
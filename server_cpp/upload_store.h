@@ -0,0 +1,129 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+// Uploads retomáveis: o conteúdo recebido com um id de sessão (metadado "x-upload-id") fica em
+// um arquivo do diretório de uploads. Se o stream cair, o arquivo é mantido por ttl depois da
+// última atividade; o cliente consulta quanto já foi gravado (GetUploadStatus) e reabre a
+// chamada com o mesmo id, enviando a partir desse offset. A sessão é removida quando uma
+// chamada que a usa termina com sucesso. Uma thread remove as sessões expiradas mesmo sem novas
+// chamadas, e o espaço total das sessões pode ser limitado.
+class UploadStore;
+
+class UploadSession {
+public:
+    enum class Append {
+        Ok,
+        Gap,            // offset além do que já foi gravado
+        ChecksumMismatch,
+        WriteError,
+        QuotaExceeded, // sem espaço no limite total das sessões, mesmo removendo as paradas
+    };
+
+    // Grava data, que começa em offset da entrada. Bytes já gravados (retransmitidos depois de
+    // uma queda) são ignorados. Se has_crc, o CRC32C do chunk inteiro é conferido antes.
+    Append append(uint64_t offset, const char* data, size_t size, bool has_crc, uint32_t crc);
+
+    const std::string& id() const { return id_; }
+    const std::string& path() const { return path_; }
+    uint64_t size() const;
+
+    // Tamanho gravado e o CRC32C correspondente, lidos juntos: GetUploadStatus pode consultar a
+    // sessão enquanto a chamada que caiu ainda grava o último chunk
+    void snapshot(uint64_t& size, uint32_t& crc) const;
+
+    ~UploadSession();
+    UploadSession(const UploadSession&) = delete;
+    UploadSession& operator=(const UploadSession&) = delete;
+
+private:
+    friend class UploadStore;
+    UploadSession(UploadStore* store, std::string id, std::string method, std::string path)
+        : store_(store), id_(std::move(id)), method_(std::move(method)), path_(std::move(path)) {}
+
+    bool openFile();
+
+    UploadStore* store_;
+    std::string id_;
+    std::string method_;
+    std::string path_;
+    int fd_ = -1;      // aberto só enquanto a sessão está em uso
+
+    // size_ e crc_ só mudam na chamada que usa a sessão, mas são lidos por GetUploadStatus
+    mutable std::mutex mutex_;
+    uint64_t size_ = 0;
+    uint32_t crc_ = 0; // CRC32C de tudo o que foi gravado
+    bool in_use_ = false;
+    std::chrono::steady_clock::time_point last_active_;
+};
+
+class UploadStore {
+public:
+    struct Status {
+        uint64_t size = 0;
+        uint32_t crc32c = 0;
+        uint64_t expires_in_ms = 0;
+    };
+
+    // directory vazio desativa os uploads retomáveis. Sobras de uma execução anterior são
+    // removidas: o estado das sessões não sobrevive a um reinício. max_bytes limita a soma dos
+    // tamanhos das sessões (0 = sem limite).
+    UploadStore(const std::string& directory, std::chrono::seconds ttl, uint64_t max_bytes = 0);
+    ~UploadStore();
+
+    bool enabled() const { return !directory_.empty(); }
+
+    // Ids aceitos: de 8 a 64 letras, dígitos, '-' ou '_' (viram nomes de arquivo)
+    static bool isValidId(const std::string& id);
+
+    // Motivo de acquire recusar uma sessão. Só InUse é passageiro: a chamada que caiu ainda não
+    // a devolveu, e o cliente pode tentar de novo em seguida.
+    enum class Refusal { Disabled, InvalidId, InUse, OtherMethod, OpenFailed };
+
+    // Abre a sessão id para uma chamada de method, criando-a se não existir. Retorna nullptr
+    // (com a causa em error e refusal) se os uploads retomáveis estiverem desativados, se o id for
+    // inválido, se a sessão estiver em uso por outra chamada ou se ela pertencer a outro método.
+    std::shared_ptr<UploadSession> acquire(const std::string& id, const std::string& method, std::string& error,
+                                           Refusal& refusal);
+
+    // Devolve a sessão ao fim da chamada. Com completed, ela é removida; senão fica disponível
+    // para ser retomada até expirar.
+    void release(const std::shared_ptr<UploadSession>& session, bool completed);
+
+    // Estado de uma sessão existente (false se ela não existe ou já expirou)
+    bool status(const std::string& id, Status& out);
+
+private:
+    friend class UploadSession;
+    using Sessions = std::unordered_map<std::string, std::shared_ptr<UploadSession>>;
+
+    // Reserva bytes no limite total antes de uma gravação, removendo as sessões paradas mais
+    // antigas se preciso. Retorna false se mesmo assim não couberem.
+    bool reserve(uint64_t bytes);
+    void unreserve(uint64_t bytes);
+
+    // Remove as sessões paradas há mais de ttl_ (chamado com mutex_ travado)
+    void expireLocked(std::chrono::steady_clock::time_point now);
+    // Apaga o arquivo da sessão e devolve o espaço dela (chamado com mutex_ travado)
+    Sessions::iterator removeLocked(Sessions::iterator it);
+    void sweepLoop();
+
+    std::string directory_;
+    std::chrono::seconds ttl_;
+    uint64_t max_bytes_;
+
+    std::mutex mutex_;
+    Sessions sessions_;
+    uint64_t total_bytes_ = 0; // soma dos tamanhos das sessões, com as gravações em andamento
+    std::condition_variable changed_;
+    bool stopping_ = false;
+    std::thread sweeper_;
+};
@@ -0,0 +1,119 @@
+#include "wire_compression.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+namespace {
+
+// Abaixo disso o cabeçalho do frame e o custo da compressão não compensam
+constexpr size_t kMinCompressibleSize = 512;
+
+// Amostra de até kSampleWindows janelas de kWindowSize bytes
+constexpr size_t kSampleWindows = 16;
+constexpr size_t kWindowSize = 256;
+
+// Texto fica entre 4 e 5 bits por byte; dados já comprimidos passam de 7,9 mesmo com uma
+// amostra de 4 KB
+constexpr double kMaxEntropyBits = 7.5;
+
+// Entropia de Shannon, em bits por byte, do histograma counts com total amostras
+double entropyBits(const uint32_t (&counts)[256], size_t total) {
+    double entropy = 0.0;
+    for (uint32_t c : counts) {
+        if (c == 0) continue;
+        double p = static_cast<double>(c) / total;
+        entropy -= p * std::log2(p);
+    }
+    return entropy;
+}
+
+} // namespace
+
+bool parseWireCompression(const std::string& name, WireCompression& out) {
+    if (name == "none" || name == "identity") {
+        out = WireCompression::None;
+    } else if (name == "gzip") {
+        out = WireCompression::Gzip;
+    } else if (name == "deflate") {
+        out = WireCompression::Deflate;
+    } else if (name == "zstd") {
+        out = WireCompression::Zstd;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const char* wireCompressionName(WireCompression compression) {
+    switch (compression) {
+        case WireCompression::Gzip: return "gzip";
+        case WireCompression::Deflate: return "deflate";
+        case WireCompression::Zstd: return "zstd";
+        default: return "identity";
+    }
+}
+
+bool zstdAvailable() {
+#ifdef HAVE_ZSTD
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool looksCompressible(const char* data, size_t size) {
+    if (size < kMinCompressibleSize) return false;
+
+    // Além dos bytes, conta as diferenças entre bytes vizinhos: bitmaps (BMP, TIFF, PPM) usam
+    // quase todos os valores, mas variam pouco de um pixel para o seguinte
+    uint32_t counts[256] = {};
+    uint32_t deltas[256] = {};
+    size_t sampled = 0;
+    auto count = [&](size_t offset, size_t length) {
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data) + offset;
+        unsigned char previous = 0;
+        for (size_t i = 0; i < length; ++i) {
+            ++counts[bytes[i]];
+            ++deltas[static_cast<unsigned char>(bytes[i] - previous)];
+            previous = bytes[i];
+        }
+        sampled += length;
+    };
+    if (size <= kSampleWindows * kWindowSize) {
+        count(0, size);
+    } else {
+        // Janelas igualmente espaçadas, a primeira no início e a última no fim do chunk
+        size_t step = (size - kWindowSize) / (kSampleWindows - 1);
+        for (size_t i = 0; i < kSampleWindows; ++i) count(i * step, kWindowSize);
+    }
+    return std::min(entropyBits(counts, sampled), entropyBits(deltas, sampled)) < kMaxEntropyBits;
+}
+
+bool zstdCompress(const char* data, size_t size, int level, std::string& out) {
+#ifdef HAVE_ZSTD
+    // Um contexto por thread: evita realocar as tabelas do zstd a cada chunk
+    struct ContextDeleter {
+        void operator()(ZSTD_CCtx* context) const { ZSTD_freeCCtx(context); }
+    };
+    thread_local std::unique_ptr<ZSTD_CCtx, ContextDeleter> context(ZSTD_createCCtx());
+    if (!context) return false;
+
+    out.resize(ZSTD_compressBound(size));
+    size_t written = ZSTD_compressCCtx(context.get(), &out[0], out.size(), data, size, level);
+    if (ZSTD_isError(written) || written >= size) return false;
+    out.resize(written);
+    return true;
+#else
+    (void)data;
+    (void)size;
+    (void)level;
+    (void)out;
+    return false;
+#endif
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+// Compressão das respostas pedida pelo cliente, chamada a chamada
+enum class WireCompression {
+    None,
+    Gzip,    // algoritmos do próprio gRPC, aplicados mensagem a mensagem
+    Deflate,
+    Zstd,    // cada chunk vira um frame zstd independente, marcado no campo encoding da mensagem
+};
+
+// Metadado em que o cliente pede a compressão ("gzip", "deflate" ou "zstd") e em que o servidor
+// confirma, nos metadados iniciais, a que vai usar
+constexpr const char* kCompressionMetadata = "x-response-compression";
+
+// Nível padrão dos frames zstd: comprime texto várias vezes mais rápido que a rede transmite
+constexpr int kDefaultZstdLevel = 3;
+
+bool parseWireCompression(const std::string& name, WireCompression& out);
+const char* wireCompressionName(WireCompression compression);
+
+// Indica se o servidor foi compilado com a libzstd (HAVE_ZSTD)
+bool zstdAvailable();
+
+// Estimativa barata de compressibilidade: entropia dos bytes de algumas janelas espalhadas por
+// data. Conteúdo já comprimido (JPEG, PNG, streams de PDF) fica perto de 8 bits por byte e é
+// enviado como está; chunks pequenos demais também.
+bool looksCompressible(const char* data, size_t size);
+
+// Comprime data em um frame zstd. Retorna false (sem garantias sobre out) se a libzstd não
+// estiver disponível ou se o frame não ficar menor que a entrada.
+bool zstdCompress(const char* data, size_t size, int level, std::string& out);